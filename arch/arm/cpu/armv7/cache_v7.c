@@ -7,8 +7,12 @@
  */
 #include <linux/types.h>
 #include <common.h>
+#include <bootstage.h>
 #include <asm/armv7.h>
 #include <asm/utils.h>
+#include <div64.h>
+
+DECLARE_GLOBAL_DATA_PTR;
 
 #define ARMV7_DCACHE_INVAL_ALL		1
 #define ARMV7_DCACHE_CLEAN_INVAL_ALL	2
@@ -232,11 +236,137 @@ static void v7_inval_tlb(void)
 	CP15ISB;
 }
 
+static void v7_flush_dcache_all(void)
+{
+	v7_maint_dcache_all(ARMV7_DCACHE_CLEAN_INVAL_ALL);
+
+	v7_outer_cache_flush_all();
+}
+
+static void v7_flush_dcache_range(unsigned long start, unsigned long stop)
+{
+	v7_dcache_maint_range(start, stop, ARMV7_DCACHE_CLEAN_INVAL_RANGE);
+
+	v7_outer_cache_flush_range(start, stop);
+}
+
+#if !defined(CONFIG_SYS_DCACHE_FLUSH_THRESHOLD) && \
+	defined(CONFIG_SYS_DCACHE_CALIBRATE)
+/* Size of the range flush timed against a full flush */
+#define DCACHE_CALIBRATE_SIZE	(1 << 20)
+/* Timer steps each timed interval has to span */
+#define DCACHE_CALIBRATE_STEPS	100
+
+/* Total size of the data and unified caches */
+static ulong v7_dcache_size(void)
+{
+	u32 level, cache_type, ccsidr, clidr = get_clidr();
+	ulong size = 0;
+
+	for (level = 0; level < 7; level++) {
+		cache_type = (clidr >> (level * 3)) & 0x7;
+		if ((cache_type != ARMV7_CLIDR_CTYPE_DATA_ONLY) &&
+		    (cache_type != ARMV7_CLIDR_CTYPE_INSTRUCTION_DATA) &&
+		    (cache_type != ARMV7_CLIDR_CTYPE_UNIFIED))
+			continue;
+
+		set_csselr(level, ARMV7_CSSELR_IND_DATA_UNIFIED);
+		ccsidr = get_ccsidr();
+		size += (((ccsidr & CCSIDR_NUM_SETS_MASK) >>
+			  CCSIDR_NUM_SETS_OFFSET) + 1) *
+			(((ccsidr & CCSIDR_ASSOCIATIVITY_MASK) >>
+			  CCSIDR_ASSOCIATIVITY_OFFSET) + 1) <<
+			(((ccsidr & CCSIDR_LINE_SIZE_MASK) >>
+			  CCSIDR_LINE_SIZE_OFFSET) + 4);
+	}
+	/* Leave CSSELR at level 0 for v7_dcache_maint_range() */
+	set_csselr(0, ARMV7_CSSELR_IND_DATA_UNIFIED);
+
+	return size;
+}
+
+/* Smallest step timer_get_us() advances by */
+static ulong v7_timer_step(void)
+{
+	ulong t, start = timer_get_us();
+
+	while ((t = timer_get_us()) == start)
+		;
+	start = t;
+	while ((t = timer_get_us()) == start)
+		;
+
+	return t - start;
+}
+
+/*
+ * Time a range flush of DCACHE_CALIBRATE_SIZE bytes and a full flush to
+ * find where the full flush becomes quicker. The range is the one just
+ * below U-Boot (the malloc() area), which is always mapped; flushing it
+ * only writes back and drops lines. Each flush is repeated until it has
+ * taken DCACHE_CALIBRATE_STEPS timer steps, and the result is never below
+ * the size of the D-cache, where a full flush cannot win.
+ */
+static ulong v7_dcache_calibrate(void)
+{
+	ulong start = gd->relocaddr - DCACHE_CALIBRATE_SIZE;
+	ulong min_us = DCACHE_CALIBRATE_STEPS * v7_timer_step();
+	ulong t, t_range, t_all, min_size = v7_dcache_size();
+	uint n_range, n_all;
+	u64 threshold;
+
+	t = timer_get_us();
+	for (n_range = 0; (t_range = timer_get_us() - t) < min_us; n_range++)
+		v7_flush_dcache_range(start, gd->relocaddr);
+
+	t = timer_get_us();
+	for (n_all = 0; (t_all = timer_get_us() - t) < min_us; n_all++)
+		v7_flush_dcache_all();
+
+	debug("dcache: %u range flushes of %#x bytes %lu us, ", n_range,
+	      DCACHE_CALIBRATE_SIZE, t_range);
+	debug("%u full flushes %lu us\n", n_all, t_all);
+
+	threshold = (u64)DCACHE_CALIBRATE_SIZE * t_all * n_range;
+	do_div(threshold, t_range * n_all);
+	if (threshold < min_size)
+		return min_size;
+
+	return threshold > ~0UL ? ~0UL : (ulong)threshold;
+}
+#endif
+
+/*
+ * Range flushes of at least this many bytes clean and invalidate the whole
+ * D-cache instead, which is much quicker than going through a big range
+ * line by line. With CONFIG_SYS_DCACHE_CALIBRATE this is measured on the
+ * first flush after relocation; before that there is no timer to measure
+ * with. Otherwise, unless the board sets CONFIG_SYS_DCACHE_FLUSH_THRESHOLD,
+ * the range is always flushed.
+ */
+static ulong v7_dcache_flush_threshold(void)
+{
+#if defined(CONFIG_SYS_DCACHE_FLUSH_THRESHOLD)
+	return CONFIG_SYS_DCACHE_FLUSH_THRESHOLD;
+#elif defined(CONFIG_SYS_DCACHE_CALIBRATE)
+	if (!(gd->flags & GD_FLG_RELOC))
+		return ~0UL;
+	if (!gd->arch.dcache_flush_threshold)
+		gd->arch.dcache_flush_threshold = v7_dcache_calibrate();
+
+	return gd->arch.dcache_flush_threshold;
+#else
+	return ~0UL;
+#endif
+}
+
 void invalidate_dcache_all(void)
 {
+	bootstage_start(BOOTSTAGE_ID_ACCUM_DCACHE, "dcache maintenance");
 	v7_maint_dcache_all(ARMV7_DCACHE_INVAL_ALL);
 
 	v7_outer_cache_inval_all();
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_DCACHE);
 }
 
 /*
@@ -245,21 +375,26 @@ void invalidate_dcache_all(void)
  */
 void flush_dcache_all(void)
 {
-	v7_maint_dcache_all(ARMV7_DCACHE_CLEAN_INVAL_ALL);
-
-	v7_outer_cache_flush_all();
+	bootstage_start(BOOTSTAGE_ID_ACCUM_DCACHE, "dcache maintenance");
+	v7_flush_dcache_all();
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_DCACHE);
 }
 
 /*
  * Invalidates range in all levels of D-cache/unified cache used:
  * Affects the range [start, stop - 1]
+ *
+ * This never turns into a whole-cache operation: invalidating everything
+ * would drop other dirty data and cleaning first could write stale lines
+ * over what a device has just put in the range.
  */
 void invalidate_dcache_range(unsigned long start, unsigned long stop)
 {
-
+	bootstage_start(BOOTSTAGE_ID_ACCUM_DCACHE, "dcache maintenance");
 	v7_dcache_maint_range(start, stop, ARMV7_DCACHE_INVAL_RANGE);
 
 	v7_outer_cache_inval_range(start, stop);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_DCACHE);
 }
 
 /*
@@ -269,9 +404,12 @@ void invalidate_dcache_range(unsigned long start, unsigned long stop)
  */
 void flush_dcache_range(unsigned long start, unsigned long stop)
 {
-	v7_dcache_maint_range(start, stop, ARMV7_DCACHE_CLEAN_INVAL_RANGE);
-
-	v7_outer_cache_flush_range(start, stop);
+	bootstage_start(BOOTSTAGE_ID_ACCUM_DCACHE, "dcache maintenance");
+	if (stop - start >= v7_dcache_flush_threshold())
+		v7_flush_dcache_all();
+	else
+		v7_flush_dcache_range(start, stop);
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_DCACHE);
 }
 
 void arm_init_before_mmu(void)
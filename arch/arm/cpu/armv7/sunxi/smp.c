@@ -7,6 +7,7 @@
 
 #include <common.h>
 #include <asm/io.h>
+#include <asm/errno.h>
 #include <asm/arch/smp.h>
 #include <asm/arch/cpucfg.h>
 
@@ -36,11 +37,112 @@ static void secondary_pen(void)
 
 u32 secondary_stack[32*(NUM_CORES-1)];
 
+/*
+ * Job for the secondary, see smp_start_secondary(). The secondary runs
+ * with its caches off, so what each side writes gets cache lines of its
+ * own: a flush on the primary must not write back a stale copy of a word
+ * the secondary has changed.
+ */
+static struct {
+	void (*fn)(void *);
+	void *arg;
+	int neon;		/* enable NEON first, as on the boot CPU */
+	volatile int cancel;	/* primary gave up waiting */
+} __aligned(ARCH_DMA_MINALIGN) secondary_job;
+
+/* Written by the secondary only */
+static struct {
+	volatile int seen;	/* picked the job up */
+	volatile int run;	/* then ran it (1) or found it cancelled (-1) */
+} __aligned(ARCH_DMA_MINALIGN) secondary_ack;
+
+u32 secondary_job_stack[SECONDARY_JOB_STACK_SIZE / 4];
+
 void secondary_start(void)
 {
 	secondary_pen();
 }
 
+/* Called from secondary_job_entry on the job stack, caches off */
+void secondary_job_run(void)
+{
+	struct sunxi_cpucfg *cpucfg = (struct sunxi_cpucfg *)SUNXI_CPUCFG_BASE;
+
+	/* The next wakeup goes back to the pen, whatever the job does */
+	writel((u32)secondary_init, &cpucfg->boot_addr);
+
+	/*
+	 * Announce ourselves before looking at cancel, while the primary
+	 * sets cancel before looking at seen. One of us sees the other's
+	 * write, so a job is never run after smp_start_secondary() failed.
+	 */
+	secondary_ack.seen = 1;
+	__asm__ __volatile__("dsb" ::: "memory");
+	if (secondary_job.cancel) {
+		secondary_ack.run = -1;
+		return;
+	}
+	secondary_ack.run = 1;
+#ifdef CONFIG_USE_ARCH_MEMCPY_NEON
+	/* arm_neon_ok is global, it must hold for this core too */
+	if (secondary_job.neon)
+		arm_neon_enable();
+#endif
+	secondary_job.fn(secondary_job.arg);
+}
+
+/*
+ * The secondary waits in secondary_pen() for an event, then jumps to the
+ * boot address. Point that at secondary_job_entry and wake it up. This
+ * also moves it from the pen in the pre-relocation copy of U-Boot, which
+ * may then be overwritten, to the relocated one.
+ */
+int smp_start_secondary(void (*fn)(void *), void *arg)
+{
+	struct sunxi_cpucfg *cpucfg = (struct sunxi_cpucfg *)SUNXI_CPUCFG_BASE;
+	ulong job = (ulong)&secondary_job;
+	ulong ack = (ulong)&secondary_ack;
+	ulong start;
+
+	secondary_job.fn = fn;
+	secondary_job.arg = arg;
+#ifdef CONFIG_USE_ARCH_MEMCPY_NEON
+	secondary_job.neon = arm_neon_ok;
+#endif
+	secondary_job.cancel = 0;
+	secondary_ack.seen = 0;
+	secondary_ack.run = 0;
+	flush_dcache_range(job, job + sizeof(secondary_job));
+	flush_dcache_range(ack, ack + sizeof(secondary_ack));
+
+	writel((u32)secondary_job_entry, &cpucfg->boot_addr);
+	__asm__ __volatile__("dsb\n\tsev" ::: "memory");
+
+	start = get_timer(0);
+	do {
+		flush_dcache_range(ack, ack + sizeof(secondary_ack));
+		if (secondary_ack.seen)
+			break;
+	} while (get_timer(start) < 100);
+
+	if (!secondary_ack.seen) {
+		/* The flush orders cancel before the read of seen below */
+		secondary_job.cancel = 1;
+		flush_dcache_range(job, job + sizeof(secondary_job));
+		flush_dcache_range(ack, ack + sizeof(secondary_ack));
+		if (!secondary_ack.seen) {
+			writel((u32)secondary_init, &cpucfg->boot_addr);
+			return -ETIMEDOUT;
+		}
+	}
+
+	/* It is awake, its decision is a few instructions away */
+	while (!secondary_ack.run)
+		flush_dcache_range(ack, ack + sizeof(secondary_ack));
+
+	return secondary_ack.run > 0 ? 0 : -ETIMEDOUT;
+}
+
 /* Power on secondaries */
 void startup_secondaries(void)
 {
@@ -7,6 +7,7 @@
  */
 
 #include <common.h>
+#include <div64.h>
 #include <asm/io.h>
 #include <asm/arch/timer.h>
 
@@ -111,3 +112,27 @@ ulong get_tbclk(void)
 {
 	return CONFIG_SYS_HZ;
 }
+
+/*
+ * get_timer() only counts milliseconds. Keep a 64-bit count of the 24 MHz
+ * clock as well, so that short operations and boot stages can be timed
+ * in microseconds. Like get_timer() this must be called at least once per
+ * counter wrap (about three minutes).
+ */
+unsigned long timer_get_us(void)
+{
+	u32 now = read_timer();
+	unsigned long long count;
+
+	gd->arch.timer_count += now - gd->arch.timer_last;
+	gd->arch.timer_last = now;
+	count = gd->arch.timer_count;
+	do_div(count, TIMER_CLOCK / 1000000);
+
+	return count;
+}
+
+ulong timer_get_boot_us(void)
+{
+	return timer_get_us();
+}
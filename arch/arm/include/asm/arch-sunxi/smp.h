@@ -10,12 +10,16 @@
 #ifndef _SUNXI_SMP_H_
 #define _SUNXI_SMP_H_
 
+/* Stack for jobs run by smp_start_secondary() */
+#define SECONDARY_JOB_STACK_SIZE	4096
+
 #ifndef __ASSEMBLY__
 
 void startup_secondaries(void);
 
-/* Assembly entry point */
+/* Assembly entry points */
 extern void secondary_init(void);
+extern void secondary_job_entry(void);
 
 #endif /* __ASSEMBLY__ */
 
@@ -43,6 +43,7 @@ enum lcd_cache_t {
 	FDT_LCD_CACHE_WRITE_THROUGH	= 1 << 0,
 	FDT_LCD_CACHE_WRITE_BACK	= 1 << 1,
 	FDT_LCD_CACHE_FLUSH		= 1 << 2,
+	FDT_LCD_CACHE_WRITE_COMBINE	= 1 << 3,
 	FDT_LCD_CACHE_WRITE_BACK_FLUSH	= FDT_LCD_CACHE_WRITE_BACK |
 						FDT_LCD_CACHE_FLUSH,
 };
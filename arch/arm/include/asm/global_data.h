@@ -35,11 +35,17 @@ struct arch_global_data {
 #if !(defined(CONFIG_SYS_ICACHE_OFF) && defined(CONFIG_SYS_DCACHE_OFF))
 	unsigned long tlb_addr;
 	unsigned long tlb_size;
+	unsigned long dcache_flush_threshold;
 #endif
 
 #ifdef CONFIG_OMAP
 	struct omap_boot_parameters omap_boot_params;
 #endif
+#ifdef CONFIG_SUNXI
+	/* 24 MHz timer counts, for timer_get_us() */
+	unsigned long long timer_count;
+	u32 timer_last;
+#endif
 };
 
 #include <asm-generic/global_data.h>
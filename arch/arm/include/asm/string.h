@@ -14,23 +14,34 @@ extern char * strrchr(const char * s, int c);
 #undef __HAVE_ARCH_STRCHR
 extern char * strchr(const char * s, int c);
 
-#ifdef CONFIG_USE_ARCH_MEMCPY
+#if defined(CONFIG_USE_ARCH_MEMCPY) || defined(CONFIG_USE_ARCH_MEMCPY_NEON)
 #define __HAVE_ARCH_MEMCPY
 #endif
 extern void * memcpy(void *, const void *, __kernel_size_t);
 
+#ifdef CONFIG_USE_ARCH_MEMCPY_NEON
+#define __HAVE_ARCH_MEMMOVE
+#else
 #undef __HAVE_ARCH_MEMMOVE
+#endif
 extern void * memmove(void *, const void *, __kernel_size_t);
 
 #undef __HAVE_ARCH_MEMCHR
 extern void * memchr(const void *, int, __kernel_size_t);
 
 #undef __HAVE_ARCH_MEMZERO
-#ifdef CONFIG_USE_ARCH_MEMSET
+#if defined(CONFIG_USE_ARCH_MEMSET) || defined(CONFIG_USE_ARCH_MEMCPY_NEON)
 #define __HAVE_ARCH_MEMSET
 #endif
 extern void * memset(void *, int, __kernel_size_t);
 
+#ifdef CONFIG_USE_ARCH_MEMCPY_NEON
+/* Set once arm_neon_init() has enabled NEON for the routines above */
+extern int arm_neon_ok;
+int arm_neon_init(void);
+int arm_neon_enable(void);
+#endif
+
 #if 0
 extern void __memzero(void *ptr, __kernel_size_t n);
 
@@ -126,7 +126,12 @@ void smp_kick_all_cpus(void);
 #define CR_AFE	(1 << 29)	/* Access flag enable			*/
 #define CR_TE	(1 << 30)	/* Thumb exception enable		*/
 
+/* First-level table, then any 1 KiB second-level tables after it */
+#ifdef CONFIG_SYS_MMU_L2_TABLES
+#define PGTABLE_SIZE		(4096 * 4 + CONFIG_SYS_MMU_L2_TABLES * 1024)
+#else
 #define PGTABLE_SIZE		(4096 * 4)
+#endif
 
 /*
  * This is used to ensure the compiler did actually allocate the register we
@@ -183,12 +188,21 @@ enum dcache_option {
 	DCACHE_OFF = 0x12,
 	DCACHE_WRITETHROUGH = 0x1a,
 	DCACHE_WRITEBACK = 0x1e,
+#ifdef __ARM_ARCH_7A__
+	/* Normal memory, not cached: writes may be merged (TEX=1, C=B=0) */
+	DCACHE_WRITECOMBINE = 0x1012,
+#else
+	/* Not cached, but writes go through the write buffer (B=1) */
+	DCACHE_WRITECOMBINE = 0x16,
+#endif
 };
 
-/* Size of an MMU section */
+/* Size of an MMU section, and of a page in a second-level table */
 enum {
 	MMU_SECTION_SHIFT	= 20,
 	MMU_SECTION_SIZE	= 1 << MMU_SECTION_SHIFT,
+	MMU_PAGE_SHIFT		= 12,
+	MMU_PAGE_SIZE		= 1 << MMU_PAGE_SHIFT,
 };
 
 /**
@@ -201,6 +215,26 @@ enum {
 void mmu_set_region_dcache_behaviour(u32 start, int size,
 				     enum dcache_option option);
 
+/**
+ * Map a region with the given cache settings, down to 4 KiB granularity.
+ *
+ * Unlike mmu_set_region_dcache_behaviour(), which rounds out to whole
+ * sections, only [start, start + size) is affected: a section that the
+ * region covers in part is split into pages using one of the
+ * CONFIG_SYS_MMU_L2_TABLES second-level tables. The region is remembered
+ * and mapped again whenever the MMU is set up, so this may be called
+ * before the D-cache is enabled. Any cached data in the region is flushed
+ * first. Call this only after relocation.
+ *
+ * \param start		start address of the region, 4 KiB aligned
+ * \param size		size of the region, rounded up to 4 KiB
+ * \param option	dcache option to select
+ * \return 0 if ok, -EINVAL if the region is not page aligned or wraps,
+ * -ENOSPC if there are no region slots or second-level tables left, in
+ * which case the mapping is left as it was
+ */
+int mmu_map_region(ulong start, ulong size, enum dcache_option option);
+
 /**
  * Register an update to the page tables, and flush the TLB
  *
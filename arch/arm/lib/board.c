@@ -230,6 +230,9 @@ static int mark_bootstage(void)
 
 init_fnc_t *init_sequence[] = {
 	arch_cpu_init,		/* basic arch cpu dependent setup */
+#ifdef CONFIG_USE_ARCH_MEMCPY_NEON
+	arm_neon_init,		/* NEON string routines */
+#endif
 	mark_bootstage,
 #ifdef CONFIG_OF_CONTROL
 	fdtdec_check_fdt,
@@ -15,9 +15,12 @@
 #include <common.h>
 #include <command.h>
 #include <image.h>
+#include <ramlog.h>
+#include <serial.h>
 #include <u-boot/zlib.h>
 #include <asm/byteorder.h>
 #include <libfdt.h>
+#include <net.h>
 #include <fdt_support.h>
 #include <asm/bootm.h>
 #include <linux/compiler.h>
@@ -80,6 +83,9 @@ static void announce_and_cleanup(int fake)
 #ifdef CONFIG_USB_DEVICE
 	udc_disconnect();
 #endif
+	ramlog_summary();
+	serial_tx_flush();
+	nc_flush();
 	cleanup_before_linux();
 }
 
@@ -365,6 +371,8 @@ void boot_prep_vxworks(bootm_headers_t *images)
 		}
 	}
 #endif
+	serial_tx_flush();
+	nc_flush();
 	cleanup_before_linux();
 }
 void boot_jump_vxworks(bootm_headers_t *images)
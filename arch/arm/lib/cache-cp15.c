@@ -9,6 +9,7 @@
 #include <asm/system.h>
 #include <asm/cache.h>
 #include <linux/compiler.h>
+#include <asm/errno.h>
 
 #if !(defined(CONFIG_SYS_ICACHE_OFF) && defined(CONFIG_SYS_DCACHE_OFF))
 
@@ -67,6 +68,162 @@ void mmu_set_region_dcache_behaviour(u32 start, int size,
 	mmu_page_table_flush((u32)&page_table[start], (u32)&page_table[end]);
 }
 
+#if defined(CONFIG_SYS_MMU_L2_TABLES) && !defined(__ARM_ARCH_7A__)
+#error "CONFIG_SYS_MMU_L2_TABLES needs the ARMv7 page table format"
+#endif
+
+#ifndef CONFIG_SYS_MMU_L2_TABLES
+#define CONFIG_SYS_MMU_L2_TABLES	0
+#endif
+
+#ifndef CONFIG_SYS_MMU_REGIONS
+#define CONFIG_SYS_MMU_REGIONS		8
+#endif
+
+#define MMU_L1_ENTRIES		4096
+#define MMU_L2_ENTRIES		256
+#define MMU_L1_COARSE		0x1		/* points to a second-level table */
+#define MMU_L1_TYPE_MASK	0x3
+#define MMU_L2_SMALL		0x2		/* 4 KiB small page */
+
+/* Regions passed to mmu_map_region(), mapped again by mmu_setup() */
+static struct mmu_region {
+	ulong start;
+	ulong end;
+	enum dcache_option option;
+} mmu_regions[CONFIG_SYS_MMU_REGIONS];
+static int mmu_region_count;
+static int mmu_l2_used;
+
+/*
+ * Turn section attributes into small page ones: B and C stay where they
+ * are, XN moves from bit 4 to bit 0, TEX from bits 14:12 to 8:6 and the
+ * access permissions from bits 11:10 to 5:4.
+ */
+static u32 mmu_page_value(ulong addr, u32 option)
+{
+	return (addr & ~(MMU_PAGE_SIZE - 1)) | MMU_L2_SMALL |
+		(option & 0xc) | ((option >> 4) & 1) |
+		(((option >> 12) & 7) << 6) | (3 << 4);
+}
+
+/*
+ * Return the second-level table for a section, splitting the section
+ * into pages with its current attributes if it is not split yet
+ */
+static u32 *mmu_section_pages(int section)
+{
+	u32 *page_table = (u32 *)gd->arch.tlb_addr;
+	u32 value = page_table[section];
+	u32 *pages;
+	int i;
+
+	if ((value & MMU_L1_TYPE_MASK) == MMU_L1_COARSE)
+		return (u32 *)(value & ~0x3ff);
+	if (mmu_l2_used == CONFIG_SYS_MMU_L2_TABLES)
+		return NULL;
+
+	pages = page_table + MMU_L1_ENTRIES + mmu_l2_used++ * MMU_L2_ENTRIES;
+	for (i = 0; i < MMU_L2_ENTRIES; i++)
+		pages[i] = mmu_page_value((value & ~(MMU_SECTION_SIZE - 1)) +
+					  (i << MMU_PAGE_SHIFT),
+					  value & (MMU_SECTION_SIZE - 1));
+	mmu_page_table_flush((u32)pages, (u32)(pages + MMU_L2_ENTRIES));
+	page_table[section] = (u32)pages | MMU_L1_COARSE;
+
+	return pages;
+}
+
+/*
+ * Number of second-level tables mmu_apply_region() has to take: one for
+ * each section at either end that is covered in part and not split yet
+ */
+static int mmu_l2_needed(ulong start, ulong end)
+{
+	u32 *page_table = (u32 *)gd->arch.tlb_addr;
+	int first = start >> MMU_SECTION_SHIFT;
+	int last = (end - 1) >> MMU_SECTION_SHIFT;
+	int section, needed = 0;
+
+	for (section = first; section <= last; section += max(last - first, 1)) {
+		ulong base = (ulong)section << MMU_SECTION_SHIFT;
+
+		if (start <= base && end - 1 >= base + (MMU_SECTION_SIZE - 1))
+			continue;
+		if ((page_table[section] & MMU_L1_TYPE_MASK) != MMU_L1_COARSE)
+			needed++;
+	}
+
+	return needed;
+}
+
+static int mmu_apply_region(ulong start, ulong end, enum dcache_option option)
+{
+	u32 *page_table = (u32 *)gd->arch.tlb_addr;
+	ulong addr, next;
+	u32 *pages;
+	int section;
+
+	for (addr = start; addr < end; addr = next) {
+		section = addr >> MMU_SECTION_SHIFT;
+		/* Go via the last byte so that the top section cannot wrap */
+		next = min(end - 1, addr | (MMU_SECTION_SIZE - 1)) + 1;
+
+		/*
+		 * A whole section goes back to being a section. Its old
+		 * second-level table, if any, stays in use until the next
+		 * mmu_setup(): tables are never shared, so that is harmless.
+		 */
+		if (next - addr == MMU_SECTION_SIZE) {
+			set_section_dcache(section, option);
+			continue;
+		}
+
+		pages = mmu_section_pages(section);
+		if (!pages)
+			return -ENOSPC;
+		for (; addr < next; addr += MMU_PAGE_SIZE)
+			pages[(addr >> MMU_PAGE_SHIFT) % MMU_L2_ENTRIES] =
+				mmu_page_value(addr, option);
+		mmu_page_table_flush((u32)pages,
+				     (u32)(pages + MMU_L2_ENTRIES));
+	}
+	mmu_page_table_flush((u32)&page_table[start >> MMU_SECTION_SHIFT],
+			     (u32)&page_table[((end - 1) >> MMU_SECTION_SHIFT) + 1]);
+
+	return 0;
+}
+
+int mmu_map_region(ulong start, ulong size, enum dcache_option option)
+{
+	ulong end = ALIGN(start + size, MMU_PAGE_SIZE);
+	struct mmu_region *region;
+	int ret;
+
+	debug("%s: start=%lx, size=%lx, option=%x\n", __func__, start, size,
+	      option);
+	if ((start & (MMU_PAGE_SIZE - 1)) || end <= start)
+		return -EINVAL;
+	/* Fail before anything is changed, not halfway through */
+	if (mmu_region_count == CONFIG_SYS_MMU_REGIONS ||
+	    mmu_l2_used + mmu_l2_needed(start, end) > CONFIG_SYS_MMU_L2_TABLES)
+		return -ENOSPC;
+
+	/* Nothing cached may be left behind if the region becomes uncached */
+	if (dcache_status())
+		flush_dcache_range(start, end);
+	ret = mmu_apply_region(start, end, option);
+	if (ret)
+		return ret;
+
+	region = &mmu_regions[mmu_region_count++];
+	region->start = start;
+	region->end = end;
+	region->option = option;
+
+	return 0;
+}
+
 __weak void dram_bank_mmu_setup(int bank)
 {
 	bd_t *bd = gd->bd;
@@ -99,6 +256,12 @@ static inline void mmu_setup(void)
 		dram_bank_mmu_setup(i);
 	}
 
+	/* Regions registered so far, in order, on top of that */
+	mmu_l2_used = 0;
+	for (i = 0; i < mmu_region_count; i++)
+		mmu_apply_region(mmu_regions[i].start, mmu_regions[i].end,
+				 mmu_regions[i].option);
+
 	/* Copy the page table address to cp15 */
 	asm volatile("mcr p15, 0, %0, c2, c0, 0"
 		     : : "r" (gd->arch.tlb_addr) : "memory");
@@ -0,0 +1,57 @@
+/*
+ * Enable NEON for the string routines in memcpy-neon.S
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <asm/armv7.h>
+
+#define CPACR_CP10_CP11		(0xf << 20)	/* full access to VFP/NEON */
+#define CPACR_ASEDIS		(1 << 31)	/* Advanced SIMD disabled */
+#define MVFR1_SIMD_LS		(0xf << 8)	/* NEON load/store present */
+#define FPEXC_EN		(1 << 30)
+
+/*
+ * Kept in .data rather than .bss: relocation copies the image including
+ * .data, so the setting made before relocation carries over. If .data is
+ * not writable before relocation (execute in place) it simply stays 0.
+ */
+int arm_neon_ok __attribute__((section(".data")));
+
+/*
+ * Enable NEON on the calling core, returns 1 if it is usable. The
+ * enables are per core, so secondaries that run U-Boot code call this
+ * for themselves.
+ */
+int arm_neon_enable(void)
+{
+	u32 cpacr, mvfr1;
+
+	/* The access bits only stick if there is a VFP/NEON unit */
+	asm volatile("mrc p15, 0, %0, c1, c0, 2" : "=r" (cpacr));
+	cpacr |= CPACR_CP10_CP11;
+	asm volatile("mcr p15, 0, %0, c1, c0, 2" : : "r" (cpacr));
+	CP15ISB;
+	asm volatile("mrc p15, 0, %0, c1, c0, 2" : "=r" (cpacr));
+	if ((cpacr & CPACR_CP10_CP11) != CPACR_CP10_CP11 ||
+	    (cpacr & CPACR_ASEDIS))
+		return 0;
+
+	/* VFP without NEON (e.g. VFPv3-D16 only) is no use to us */
+	asm volatile("mrc p10, 7, %0, c6, c0, 0" : "=r" (mvfr1));
+	if (!(mvfr1 & MVFR1_SIMD_LS))
+		return 0;
+
+	asm volatile("mcr p10, 7, %0, c8, c0, 0" : : "r" (FPEXC_EN));
+
+	return 1;
+}
+
+int arm_neon_init(void)
+{
+	if (arm_neon_enable())
+		arm_neon_ok = 1;
+
+	return 0;
+}
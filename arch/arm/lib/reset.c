@@ -22,10 +22,14 @@
  */
 
 #include <common.h>
+#include <net.h>
+#include <serial.h>
 
 int do_reset(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	puts ("resetting ...\n");
+	serial_tx_flush();
+	nc_flush();
 
 	udelay (50000);				/* wait 50 ms */
 
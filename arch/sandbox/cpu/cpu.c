@@ -36,6 +36,17 @@ unsigned long __attribute__((no_instrument_function)) timer_get_us(void)
 	return os_get_nsec() / 1000;
 }
 
+/* Microseconds since the first call, for bootstage */
+ulong timer_get_boot_us(void)
+{
+	static uint64_t base_ns;
+
+	if (!base_ns)
+		base_ns = os_get_nsec();
+
+	return (os_get_nsec() - base_ns) / 1000;
+}
+
 int do_bootm_linux(int flag, int argc, char *argv[], bootm_headers_t *images)
 {
 	if (flag & (BOOTM_STATE_OS_GO | BOOTM_STATE_OS_FAKE_GO)) {
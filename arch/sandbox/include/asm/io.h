@@ -40,4 +40,38 @@ static inline void unmap_sysmem(const void *vaddr)
 /* Map from a pointer to our RAM buffer */
 phys_addr_t map_to_sysmem(const void *ptr);
 
+/*
+ * There is no MMIO on sandbox, so the accessors go to emulated RAM like
+ * any other address
+ */
+static inline u8 readb(const volatile void *addr)
+{
+	return *(volatile u8 *)map_sysmem((ulong)addr, sizeof(u8));
+}
+
+static inline u16 readw(const volatile void *addr)
+{
+	return *(volatile u16 *)map_sysmem((ulong)addr, sizeof(u16));
+}
+
+static inline u32 readl(const volatile void *addr)
+{
+	return *(volatile u32 *)map_sysmem((ulong)addr, sizeof(u32));
+}
+
+static inline void writeb(u8 val, volatile void *addr)
+{
+	*(volatile u8 *)map_sysmem((ulong)addr, sizeof(u8)) = val;
+}
+
+static inline void writew(u16 val, volatile void *addr)
+{
+	*(volatile u16 *)map_sysmem((ulong)addr, sizeof(u16)) = val;
+}
+
+static inline void writel(u32 val, volatile void *addr)
+{
+	*(volatile u32 *)map_sysmem((ulong)addr, sizeof(u32)) = val;
+}
+
 #endif
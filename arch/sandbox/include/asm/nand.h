@@ -0,0 +1,27 @@
+/*
+ * Simulated NAND flash for sandbox
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __ASM_SANDBOX_NAND_H
+#define __ASM_SANDBOX_NAND_H
+
+struct sandbox_nand_stats {
+	ulong loads;		/* pages loaded from the array */
+	ulong cache_loads;	/* of which overlapped a data transfer */
+	ulong programs;		/* pages programmed */
+	ulong erases;		/* blocks erased */
+	ulong flips;		/* bits flipped on the way out */
+	ulong busy_us;		/* time the chip reported busy */
+};
+
+/**
+ * sandbox_nand_get_stats() - Read the simulated NAND activity counters
+ *
+ * @stats:	Returns the counters
+ * @reset:	Clear the counters after reading them
+ */
+void sandbox_nand_get_stats(struct sandbox_nand_stats *stats, int reset);
+
+#endif
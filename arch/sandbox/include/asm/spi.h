@@ -30,6 +30,8 @@ struct sandbox_spi_emu_ops {
 	void (*cs_deactivate)(void *priv);
 	/* The client is rx-ing bytes from the bus, so it should tx some */
 	int (*xfer)(void *priv, const u8 *rx, u8 *tx, uint bytes);
+	/* Optional: the next xfer uses this many data lines (1, 2 or 4) */
+	void (*set_lines)(void *priv, uint lines);
 };
 
 /*
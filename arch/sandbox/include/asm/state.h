@@ -68,6 +68,8 @@ struct sandbox_state {
 	bool show_lcd;			/* Show LCD on start-up */
 	enum state_terminal_raw term_raw;	/* Terminal raw/cooked */
 
+	const char *nand_fname;		/* Filename of NAND flash image */
+
 	/* Pointer to information for each SPI bus/cs */
 	struct sandbox_spi_info spi[CONFIG_SANDBOX_SPI_MAX_BUS]
 					[CONFIG_SANDBOX_SPI_MAX_CS];
@@ -8,13 +8,10 @@
 #define __ASM_SANDBOX_SYSTEM_H
 
 /* Define this as nops for sandbox architecture */
-static inline void local_irq_save(unsigned flags __attribute__((unused)))
-{
-}
-
+#define local_irq_save(x)	((x) = 0)
 #define local_irq_enable()
 #define local_irq_disable()
 #define local_save_flags(x)
-#define local_irq_restore(x)
+#define local_irq_restore(x)	((void)(x))
 
 #endif
@@ -22,6 +22,7 @@
 #include <i2c.h>
 #include <initcall.h>
 #include <logbuff.h>
+#include <ramlog.h>
 
 /* TODO: Can we move these into arch/ headers? */
 #ifdef CONFIG_8xx
@@ -412,6 +413,17 @@ static int reserve_logbuffer(void)
 }
 #endif
 
+#ifdef CONFIG_RAMLOG
+static int reserve_ramlog(void)
+{
+	/* reserve the RAM log of console output */
+	gd->relocaddr -= CONFIG_RAMLOG_SIZE;
+	debug("Reserving %dk for RAM log at %08lx\n",
+	      CONFIG_RAMLOG_SIZE >> 10, gd->relocaddr);
+	return 0;
+}
+#endif
+
 #ifdef CONFIG_PRAM
 /* reserve protected RAM */
 static int reserve_pram(void)
@@ -796,6 +808,9 @@ static init_fnc_t init_sequence_f[] = {
 	probecpu,
 #endif
 	arch_cpu_init,		/* basic arch cpu dependent setup */
+#ifdef CONFIG_USE_ARCH_MEMCPY_NEON
+	arm_neon_init,		/* NEON string routines */
+#endif
 #ifdef CONFIG_X86
 	cpu_init_f,		/* TODO(sjg@chromium.org): remove */
 # ifdef CONFIG_OF_CONTROL
@@ -912,6 +927,7 @@ static init_fnc_t init_sequence_f[] = {
 	 * Reserve memory at end of RAM for (top down in that order):
 	 *  - area that won't get touched by U-Boot and Linux (optional)
 	 *  - kernel log buffer
+	 *  - RAM log of console output
 	 *  - protected RAM
 	 *  - LCD framebuffer
 	 *  - monitor code
@@ -921,6 +937,9 @@ static init_fnc_t init_sequence_f[] = {
 #if defined(CONFIG_LOGBUFFER) && !defined(CONFIG_ALT_LB_ADDR)
 	reserve_logbuffer,
 #endif
+#ifdef CONFIG_RAMLOG
+	reserve_ramlog,
+#endif
 #ifdef CONFIG_PRAM
 	reserve_pram,
 #endif
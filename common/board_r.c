@@ -32,6 +32,7 @@
 #include <kgdb.h>
 #endif
 #include <logbuff.h>
+#include <ramlog.h>
 #include <malloc.h>
 #ifdef CONFIG_BITBANGMII
 #include <miiphy.h>
@@ -203,6 +204,14 @@ static int initr_logbuffer(void)
 }
 #endif
 
+#ifdef CONFIG_RAMLOG
+static int initr_ramlog(void)
+{
+	ramlog_init();
+	return 0;
+}
+#endif
+
 #ifdef CONFIG_POST
 static int initr_post_backlog(void)
 {
@@ -401,6 +410,18 @@ int initr_onenand(void)
 }
 #endif
 
+/*
+ * With CONFIG_DEFERRED_INITCALLS, MMC and the network are brought up by
+ * their first user rather than on every boot; see initcall_run_deferred().
+ * MMC cannot wait if the environment is stored there.
+ */
+#if defined(CONFIG_DEFERRED_INITCALLS) && !defined(CONFIG_ENV_IS_IN_MMC)
+#define DEFER_MMC
+#endif
+#ifdef CONFIG_DEFERRED_INITCALLS
+#define DEFER_NET
+#endif
+
 #ifdef CONFIG_GENERIC_MMC
 int initr_mmc(void)
 {
@@ -408,6 +429,9 @@ int initr_mmc(void)
 	mmc_initialize(gd->bd);
 	return 0;
 }
+#ifdef DEFER_MMC
+INITCALL_DEFERRED(mmc, initr_mmc);
+#endif
 #endif
 
 #ifdef CONFIG_HAS_DATAFLASH
@@ -624,6 +648,9 @@ static int initr_net(void)
 #endif
 	return 0;
 }
+#ifdef DEFER_NET
+INITCALL_DEFERRED(eth, initr_net);
+#endif
 #endif
 
 #ifdef CONFIG_POST
@@ -752,6 +779,9 @@ init_fnc_t init_sequence_r[] = {
 	set_cpu_clk_info, /* Setup clock information */
 #endif
 	initr_reloc_global_data,
+#ifdef CONFIG_RAMLOG
+	initr_ramlog,
+#endif
 	initr_serial,
 	initr_announce,
 	INIT_FUNC_WATCHDOG_RESET
@@ -818,7 +848,7 @@ init_fnc_t init_sequence_r[] = {
 #ifdef CONFIG_CMD_ONENAND
 	initr_onenand,
 #endif
-#ifdef CONFIG_GENERIC_MMC
+#if defined(CONFIG_GENERIC_MMC) && !defined(DEFER_MMC)
 	initr_mmc,
 #endif
 #ifdef CONFIG_HAS_DATAFLASH
@@ -896,7 +926,7 @@ init_fnc_t init_sequence_r[] = {
 #ifdef CONFIG_BITBANGMII
 	initr_bbmii,
 #endif
-#ifdef CONFIG_CMD_NET
+#if defined(CONFIG_CMD_NET) && !defined(DEFER_NET)
 	INIT_FUNC_WATCHDOG_RESET
 	initr_net,
 #endif
@@ -13,6 +13,7 @@
 #include <lcd.h>
 #include <bmp_layout.h>
 #include <command.h>
+#include <errno.h>
 #include <asm/byteorder.h>
 #include <malloc.h>
 #include <splash.h>
@@ -228,6 +229,13 @@ int bmp_display(ulong addr, int x, int y)
 	void *bmp_alloc_addr = NULL;
 	unsigned long len;
 
+#if defined(CONFIG_LCD) && defined(CONFIG_SPLASH_RAW)
+	/* Pre-converted images go straight to the frame buffer */
+	ret = lcd_display_splash_raw(addr, x, y);
+	if (ret != -ENOENT)
+		return ret ? 1 : 0;
+#endif
+
 	if (!((bmp->header.signature[0]=='B') &&
 	      (bmp->header.signature[1]=='M')))
 		bmp = gunzip_bmp(addr, &len, &bmp_alloc_addr);
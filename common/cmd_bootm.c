@@ -572,6 +572,7 @@ static ulong bootm_disable_interrupts(void)
 	iflag = disable_interrupts();
 #ifdef CONFIG_NETCONSOLE
 	/* Stop the ethernet stack if NetConsole could have left it up */
+	nc_flush();
 	eth_halt();
 	eth_unregister(eth_get_dev());
 #endif
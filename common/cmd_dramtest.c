@@ -0,0 +1,561 @@
+/*
+ * Fast DRAM tester
+ *
+ * mtest walks memory one word at a time. Here each test writes the whole
+ * range in 32-byte blocks and then reads it back a block at a time, only
+ * looking at single words when a block differs. Between the two the data
+ * cache is flushed so that the reads come from DRAM. With -c the top half
+ * of the range is handed to a secondary core, which runs the same tests
+ * with its caches off.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <watchdog.h>
+#include <asm/io.h>
+#include <asm/errno.h>
+
+#define DT_BLOCK	8		/* words per block */
+/* Blocks between watchdog resets and checks for ctrl-C (1 MiB) */
+#define DT_CHUNK	((1 << 20) / (DT_BLOCK * 4))
+#define DT_MAX_ERRS	8		/* errors recorded per core and test */
+/* Read this far ahead when checking */
+#define DT_PREFETCH	64		/* words */
+
+enum {
+	DT_WALK,
+	DT_ADDR,
+	DT_MOVINV,
+	DT_RANDOM,
+
+	DT_COUNT,
+};
+
+static const struct {
+	const char *name;
+	int traffic;		/* times the range is read or written */
+} dt_tests[DT_COUNT] = {
+	[DT_WALK]	= { "walking ones/zeros", 4 },
+	[DT_ADDR]	= { "address in address", 4 },
+	[DT_MOVINV]	= { "moving inversions", 5 },
+	[DT_RANDOM]	= { "random data", 4 },
+};
+
+/* Moving inversions use a different pattern on each pass */
+static const u32 dt_movinv_pats[] = {
+	0x00000000, 0x55555555, 0x33333333, 0x0f0f0f0f,
+};
+
+struct dt_err {
+	ulong addr;
+	u32 expect;
+	u32 actual;
+};
+
+/*
+ * One core's share of a test. The secondary core accesses it with its
+ * caches off, so each one is allocated in whole cache lines.
+ */
+struct dt_job {
+	u32 *buf;		/* start of the range */
+	ulong addr;		/* U-Boot address of buf, for reports */
+	ulong blocks;		/* size of the range in blocks */
+	int test;
+	int pass;
+	u32 seed;
+	u32 pat;		/* pattern for moving inversions */
+	int primary;		/* may flush caches and look at the console */
+	volatile u32 *stop;	/* set to stop a secondary core early */
+
+	/* Internal state */
+	u32 xor;		/* inverts the pattern for the second half */
+	u32 rng;
+
+	/* Results */
+	ulong errors;
+	u32 bits;		/* all bits seen failing */
+	struct dt_err err[DT_MAX_ERRS];
+	int stopped;
+	volatile int done;
+};
+
+static ulong dt_align(void)
+{
+	return max(ARCH_DMA_MINALIGN, DT_BLOCK * 4);
+}
+
+static void *dt_alloc_line(size_t size)
+{
+	return memalign(ARCH_DMA_MINALIGN, ALIGN(size, ARCH_DMA_MINALIGN));
+}
+
+static void dt_flush(const void *ptr, size_t size)
+{
+	ulong start = (ulong)ptr;
+
+	flush_dcache_range(start, start + ALIGN(size, ARCH_DMA_MINALIGN));
+}
+
+/* xorshift32, so that a seed gives the same data on every board */
+static inline u32 dt_rand(u32 *state)
+{
+	u32 x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+
+	return x;
+}
+
+/* Work out what block @b should hold */
+static inline void dt_expect(struct dt_job *job, ulong b, u32 *e)
+{
+	ulong i = b * DT_BLOCK;
+	int k;
+
+	switch (job->test) {
+	case DT_WALK:
+		/* Each pass starts the walk on a different bit */
+		for (k = 0; k < DT_BLOCK; k++)
+			e[k] = 1 << ((i + k + job->pass) & 31);
+		break;
+	case DT_ADDR:
+		for (k = 0; k < DT_BLOCK; k++)
+			e[k] = job->addr + (i + k) * 4;
+		break;
+	case DT_MOVINV:
+		for (k = 0; k < DT_BLOCK; k++)
+			e[k] = job->pat;
+		break;
+	case DT_RANDOM:
+		for (k = 0; k < DT_BLOCK; k++)
+			e[k] = dt_rand(&job->rng);
+		break;
+	}
+	for (k = 0; k < DT_BLOCK; k++)
+		e[k] ^= job->xor;
+}
+
+static void dt_record(struct dt_job *job, const u32 *p, const u32 *v,
+		      const u32 *e)
+{
+	struct dt_err *err;
+	int k;
+
+	for (k = 0; k < DT_BLOCK; k++) {
+		if (v[k] == e[k])
+			continue;
+		if (job->errors < DT_MAX_ERRS) {
+			err = &job->err[job->errors];
+			err->addr = job->addr + (p + k - job->buf) * 4;
+			err->expect = e[k];
+			err->actual = v[k];
+		}
+		job->errors++;
+		job->bits |= v[k] ^ e[k];
+	}
+}
+
+/* Compare a block with @e; words are looked at singly only on a mismatch */
+static inline void dt_check(struct dt_job *job, const u32 *p, const u32 *e)
+{
+	u32 v[DT_BLOCK];
+	u32 diff = 0;
+	int k;
+
+	__builtin_prefetch(p + DT_PREFETCH);
+	for (k = 0; k < DT_BLOCK; k++) {
+		v[k] = p[k];
+		diff |= v[k] ^ e[k];
+	}
+	if (diff)
+		dt_record(job, p, v, e);
+}
+
+/*
+ * Write a block with a single store multiple. Cortex-A cores switch to
+ * write streaming when whole cache lines are written back to back, so
+ * the lines being overwritten are not read from DRAM first. ARMv7 has no
+ * non-temporal store outside NEON, which the secondary core may not have
+ * enabled.
+ */
+static inline void dt_store(u32 *p, const u32 *e)
+{
+#if defined(CONFIG_ARM) && DT_BLOCK == 8
+	__asm__ __volatile__(
+		"ldmia	%1, {r2-r8, ip}\n"
+		"stmia	%0, {r2-r8, ip}\n"
+		: : "r" (p), "r" (e)
+		: "r2", "r3", "r4", "r5", "r6", "r7", "r8", "ip", "memory");
+#else
+	int k;
+
+	for (k = 0; k < DT_BLOCK; k++)
+		p[k] = e[k];
+#endif
+}
+
+static void dt_fill(struct dt_job *job, ulong from, ulong to)
+{
+	u32 *p = job->buf + from * DT_BLOCK;
+	u32 e[DT_BLOCK];
+	ulong b;
+
+	for (b = from; b < to; b++, p += DT_BLOCK) {
+		dt_expect(job, b, e);
+		dt_store(p, e);
+	}
+}
+
+static void dt_verify(struct dt_job *job, ulong from, ulong to)
+{
+	u32 *p = job->buf + from * DT_BLOCK;
+	u32 e[DT_BLOCK];
+	ulong b;
+
+	for (b = from; b < to; b++, p += DT_BLOCK) {
+		dt_expect(job, b, e);
+		dt_check(job, p, e);
+	}
+}
+
+/* Check each block, then write its inverse */
+static void dt_verify_invert(struct dt_job *job, ulong from, ulong to)
+{
+	u32 *p = job->buf + from * DT_BLOCK;
+	u32 e[DT_BLOCK];
+	ulong b;
+	int k;
+
+	for (b = from; b < to; b++, p += DT_BLOCK) {
+		dt_expect(job, b, e);
+		dt_check(job, p, e);
+		for (k = 0; k < DT_BLOCK; k++)
+			e[k] = ~e[k];
+		dt_store(p, e);
+	}
+}
+
+/* As dt_verify_invert(), from the top block down */
+static void dt_verify_invert_down(struct dt_job *job, ulong from, ulong to)
+{
+	u32 *p = job->buf + to * DT_BLOCK;
+	u32 e[DT_BLOCK];
+	ulong b;
+	int k;
+
+	for (b = to; b-- > from; ) {
+		p -= DT_BLOCK;
+		dt_expect(job, b, e);
+		dt_check(job, p, e);
+		for (k = 0; k < DT_BLOCK; k++)
+			e[k] = ~e[k];
+		dt_store(p, e);
+	}
+}
+
+/* Returns 1 if the test should stop */
+static int dt_poll(struct dt_job *job)
+{
+	if (job->primary) {
+		WATCHDOG_RESET();
+		if (ctrlc())
+			job->stopped = 1;
+	} else if (*job->stop) {
+		job->stopped = 1;
+	}
+
+	return job->stopped;
+}
+
+/*
+ * Run @phase over the whole range a chunk at a time, then make sure that
+ * what was written has reached DRAM. Returns non-zero if stopped.
+ */
+static int dt_phase(struct dt_job *job,
+		    void (*phase)(struct dt_job *job, ulong from, ulong to),
+		    int down)
+{
+	ulong b, n;
+
+	job->rng = job->seed;
+	for (b = 0; b < job->blocks; b += n) {
+		n = min(job->blocks - b, (ulong)DT_CHUNK);
+		if (down)
+			phase(job, job->blocks - b - n, job->blocks - b);
+		else
+			phase(job, b, b + n);
+		if (dt_poll(job))
+			return -1;
+	}
+
+	barrier();
+	if (job->primary)
+		dt_flush(job->buf, job->blocks * DT_BLOCK * 4);
+
+	return 0;
+}
+
+static void dt_run_job(struct dt_job *job)
+{
+	int i;
+
+	job->errors = 0;
+	job->bits = 0;
+	job->stopped = 0;
+
+	if (job->test == DT_MOVINV) {
+		job->xor = 0;
+		if (dt_phase(job, dt_fill, 0) ||
+		    dt_phase(job, dt_verify_invert, 0))
+			return;
+		job->xor = ~0;
+		dt_phase(job, dt_verify_invert_down, 1);
+		return;
+	}
+
+	/* Everything is done once as is and once inverted */
+	for (i = 0; i < 2; i++) {
+		job->xor = i ? ~0 : 0;
+		if (dt_phase(job, dt_fill, 0) || dt_phase(job, dt_verify, 0))
+			return;
+	}
+}
+
+/* Runs on the secondary core */
+static void dt_secondary(void *arg)
+{
+	struct dt_job *job = arg;
+
+	dt_run_job(job);
+	job->done = 1;
+}
+
+__weak int smp_start_secondary(void (*fn)(void *), void *arg)
+{
+	return -ENOSYS;
+}
+
+/* Wait for the secondary, passing on ctrl-C */
+static void dt_wait(struct dt_job *job)
+{
+	for (;;) {
+		dt_flush(job, sizeof(*job));
+		if (job->done)
+			break;
+		WATCHDOG_RESET();
+		if (ctrlc() && !*job->stop) {
+			*job->stop = 1;
+			dt_flush((void *)job->stop, sizeof(*job->stop));
+		}
+	}
+}
+
+static void dt_report(struct dt_job *job)
+{
+	int i;
+
+	for (i = 0; i < min(job->errors, (ulong)DT_MAX_ERRS); i++)
+		printf("    %08lx: expected %08x, read %08x\n",
+		       job->err[i].addr, job->err[i].expect,
+		       job->err[i].actual);
+}
+
+/*
+ * Run one test over the jobs, @ncores of them (1 or 2). Returns the number
+ * of errors, or -1 if stopped.
+ */
+static long dt_run_test(struct dt_job **jobs, int *ncores, int test,
+			int pass, u32 seed)
+{
+	ulong start, us, mbs, errors = 0;
+	u32 bits = 0;
+	int stopped = 0;
+	int i;
+
+	for (i = 0; i < *ncores; i++) {
+		jobs[i]->test = test;
+		jobs[i]->pass = pass;
+		/* Don't give both halves the same random data */
+		jobs[i]->seed = (seed + pass * 0x9e3779b9) ^ (i * 0x5bd1e995);
+		if (!jobs[i]->seed)
+			jobs[i]->seed = 1;
+		jobs[i]->pat = dt_movinv_pats[pass % ARRAY_SIZE(dt_movinv_pats)];
+		jobs[i]->done = 0;
+	}
+	*jobs[0]->stop = 0;
+
+	start = timer_get_us();
+	if (*ncores > 1) {
+		dt_flush((void *)jobs[0]->stop, sizeof(*jobs[0]->stop));
+		dt_flush(jobs[1], sizeof(*jobs[1]));
+		if (smp_start_secondary(dt_secondary, jobs[1])) {
+			puts("No secondary core, using one\n");
+			jobs[0]->blocks += jobs[1]->blocks;
+			*ncores = 1;
+		}
+	}
+	dt_run_job(jobs[0]);
+	if (jobs[0]->stopped && *ncores > 1) {
+		*jobs[0]->stop = 1;
+		dt_flush((void *)jobs[0]->stop, sizeof(*jobs[0]->stop));
+	}
+	if (*ncores > 1)
+		dt_wait(jobs[1]);
+	us = timer_get_us() - start;
+
+	for (i = 0; i < *ncores; i++) {
+		dt_report(jobs[i]);
+		errors += jobs[i]->errors;
+		bits |= jobs[i]->bits;
+		stopped |= jobs[i]->stopped;
+	}
+
+	printf("  %-20s ", dt_tests[test].name);
+	if (stopped) {
+		puts("stopped\n");
+		return -1;
+	}
+	if (errors)
+		printf("%lu errors, bits %08x", errors, bits);
+	else
+		printf("%-25s", "ok");
+
+	/* MB/s is bytes per microsecond */
+	mbs = (jobs[0]->blocks + (*ncores > 1 ? jobs[1]->blocks : 0)) *
+		DT_BLOCK * 4 / max(us, 1UL) * dt_tests[test].traffic;
+	printf("  %lu.%02lu GB/s\n", mbs / 1000, mbs % 1000 / 10);
+
+	return errors;
+}
+
+static int do_dramtest(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	struct dt_job *jobs[2] = { NULL, NULL };
+	volatile u32 *stop;
+	ulong start = 0, end = 0, size, half, align;
+	ulong tests = (1 << DT_COUNT) - 1;
+	ulong passes = 1, pass;
+	ulong errors = 0;
+	u32 seed = timer_get_us();
+	int ncores = 1;
+	long ret = 0;
+	u8 *buf;
+	int i;
+
+	while (argc > 1 && argv[1][0] == '-') {
+		switch (argv[1][1]) {
+		case 'c':
+			ncores = 2;
+			break;
+		case 's':
+		case 't':
+			if (argc < 3)
+				return CMD_RET_USAGE;
+			if (argv[1][1] == 's')
+				seed = simple_strtoul(argv[2], NULL, 16);
+			else
+				tests = simple_strtoul(argv[2], NULL, 16);
+			argc--;
+			argv++;
+			break;
+		default:
+			return CMD_RET_USAGE;
+		}
+		argc--;
+		argv++;
+	}
+
+#ifdef CONFIG_SYS_MEMTEST_START
+	start = CONFIG_SYS_MEMTEST_START;
+	end = CONFIG_SYS_MEMTEST_END;
+#else
+	if (argc < 3)
+		return CMD_RET_USAGE;
+#endif
+	if (argc > 1)
+		start = simple_strtoul(argv[1], NULL, 16);
+	if (argc > 2)
+		end = simple_strtoul(argv[2], NULL, 16);
+	if (argc > 3)
+		passes = simple_strtoul(argv[3], NULL, 10);
+	if (!seed)
+		seed = 1;
+
+	/* Whole cache lines only, so that flushing never touches the edges */
+	align = dt_align();
+	start = ALIGN(start, align);
+	end &= ~(align - 1);
+	if (end <= start + 2 * align)
+		return CMD_RET_USAGE;
+	size = end - start;
+	half = ncores > 1 ? (size / 2) & ~(align - 1) : size;
+
+	stop = dt_alloc_line(sizeof(*stop));
+	for (i = 0; i < ncores; i++)
+		jobs[i] = dt_alloc_line(sizeof(*jobs[i]));
+	if (!stop || !jobs[0] || (ncores > 1 && !jobs[1])) {
+		puts("Out of memory\n");
+		ret = 1;
+		goto out;
+	}
+
+	buf = map_sysmem(start, size);
+	for (i = 0; i < ncores; i++) {
+		memset(jobs[i], '\0', sizeof(*jobs[i]));
+		jobs[i]->buf = (u32 *)(buf + i * half);
+		jobs[i]->addr = start + i * half;
+		jobs[i]->blocks = (i ? size - half : half) / (DT_BLOCK * 4);
+		jobs[i]->primary = !i;
+		jobs[i]->stop = stop;
+	}
+	/* The secondary core bypasses the cache, so nothing may be left in it */
+	dt_flush(buf, size);
+
+	printf("Testing %08lx ... %08lx, seed %08x, %d core%s\n", start,
+	       end - 1, seed, ncores, ncores > 1 ? "s" : "");
+	for (pass = 0; !passes || pass < passes; pass++) {
+		printf("Pass %lu\n", pass + 1);
+		for (i = 0; i < DT_COUNT; i++) {
+			if (!(tests & (1 << i)))
+				continue;
+			ret = dt_run_test(jobs, &ncores, i, pass, seed);
+			if (ret < 0)
+				break;
+			errors += ret;
+		}
+		if (ret < 0)
+			break;
+	}
+	dt_flush(buf, size);
+	unmap_sysmem(buf);
+
+	if (errors)
+		printf("%lu errors\n", errors);
+	ret = errors || ret < 0;
+out:
+	free(jobs[1]);
+	free(jobs[0]);
+	free((void *)stop);
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	dramtest,	8,	1,	do_dramtest,
+	"fast DRAM test",
+	"[-c] [-s seed] [-t tests] [start [end [passes]]]\n"
+	"    - test DRAM from start to end, for passes passes (0: until\n"
+	"      ctrl-C, default 1)\n"
+	"    -c: split the range with a secondary core\n"
+	"    -s: random seed (hex), to repeat an earlier run\n"
+	"    -t: mask of tests to run (hex, default all):\n"
+	"        1 walking ones/zeros, 2 address in address,\n"
+	"        4 moving inversions, 8 random data"
+);
@@ -0,0 +1,161 @@
+/*
+ * Memory bandwidth benchmark
+ *
+ * Times memcpy(), memset() and an overlapping memmove() over a range of
+ * block sizes, so that the string routines and the DRAM/cache setup of a
+ * board can be compared. Each copy is checked afterwards, which also
+ * makes this a quick smoke test for new DRAM timings.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <asm/io.h>
+
+#define MEMBENCH_SIZE		(16 << 20)
+/* Bytes moved per measurement, so that small sizes run long enough */
+#define MEMBENCH_TOTAL		(32 << 20)
+/* memmove() copies to this far above its source, forcing it backwards */
+#define MEMBENCH_SHIFT		64
+
+static const ulong membench_sizes[] = {
+	256, 4 << 10, 64 << 10, 1 << 20, 4 << 20,
+};
+
+enum membench_op {
+	MEMBENCH_COPY,
+	MEMBENCH_SET,
+	MEMBENCH_MOVE,
+};
+
+/* Returns MB/s, i.e. bytes per microsecond */
+static ulong membench_run(enum membench_op op, u8 *src, u8 *dst, ulong size)
+{
+	ulong iter = max(MEMBENCH_TOTAL / size, 1UL);
+	ulong start, us, i;
+
+	start = timer_get_us();
+	for (i = 0; i < iter; i++) {
+		switch (op) {
+		case MEMBENCH_COPY:
+			memcpy(dst, src, size);
+			break;
+		case MEMBENCH_SET:
+			memset(dst, i, size);
+			break;
+		case MEMBENCH_MOVE:
+			memmove(src + MEMBENCH_SHIFT, src, size);
+			break;
+		}
+	}
+	us = timer_get_us() - start;
+
+	return iter * size / max(us, 1UL);
+}
+
+static void membench_fill(u8 *buf, ulong size)
+{
+	ulong i;
+
+	for (i = 0; i < size; i++)
+		buf[i] = i * 7 + (i >> 8);
+}
+
+/* Check that each operation does what it should; returns 0 if so */
+static int membench_verify(u8 *src, u8 *dst, ulong size)
+{
+	ulong i;
+
+	membench_fill(src, size + MEMBENCH_SHIFT);
+	memset(dst, 0, size);
+	memcpy(dst, src, size);
+	if (memcmp(dst, src, size)) {
+		printf("memcpy of %lu bytes failed\n", size);
+		return -1;
+	}
+
+	memset(dst, 0xa5, size);
+	for (i = 0; i < size; i++) {
+		if (dst[i] != 0xa5) {
+			printf("memset of %lu bytes failed at %lu\n", size, i);
+			return -1;
+		}
+	}
+
+	/* The moved block must still hold what src held before */
+	memmove(src + MEMBENCH_SHIFT, src, size);
+	membench_fill(dst, size);
+	if (memcmp(src + MEMBENCH_SHIFT, dst, size)) {
+		printf("memmove of %lu bytes failed\n", size);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void membench_print_size(ulong size)
+{
+	if (size >= 1 << 20)
+		printf("%5lu MiB", size >> 20);
+	else if (size >= 1 << 10)
+		printf("%5lu KiB", size >> 10);
+	else
+		printf("%5lu B  ", size);
+}
+
+static int do_membench(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	ulong addr = CONFIG_SYS_LOAD_ADDR;
+	ulong len = MEMBENCH_SIZE;
+	u8 *buf, *src, *dst;
+	ulong size;
+	int ret = 0;
+	int i;
+
+	if (argc > 1)
+		addr = simple_strtoul(argv[1], NULL, 16);
+	if (argc > 2)
+		len = simple_strtoul(argv[2], NULL, 16);
+	if (len < 2 * (membench_sizes[0] + MEMBENCH_SHIFT))
+		return CMD_RET_USAGE;
+
+	buf = map_sysmem(addr, len);
+	src = buf;
+	dst = buf + len / 2;
+
+	printf("Using %#lx bytes at %#lx\n", len, addr);
+	puts("     size      memcpy      memset     memmove\n");
+	for (i = 0; i < ARRAY_SIZE(membench_sizes); i++) {
+		size = membench_sizes[i];
+		if (size + MEMBENCH_SHIFT > len / 2)
+			break;
+		if (ctrlc()) {
+			ret = 1;
+			break;
+		}
+		/* Misaligned as well, to exercise the head and tail code */
+		if (membench_verify(src, dst, size) ||
+		    membench_verify(src + 1, dst + 3, size - 5)) {
+			ret = 1;
+			break;
+		}
+
+		membench_print_size(size);
+		printf(" %6lu MB/s", membench_run(MEMBENCH_COPY, src, dst, size));
+		printf(" %6lu MB/s", membench_run(MEMBENCH_SET, src, dst, size));
+		printf(" %6lu MB/s\n", membench_run(MEMBENCH_MOVE, src, dst, size));
+	}
+	unmap_sysmem(buf);
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	membench,	3,	1,	do_membench,
+	"measure memcpy/memset/memmove bandwidth",
+	"[addr [len]]\n"
+	"    - time copies and fills of increasing size within the\n"
+	"      len bytes (default 16 MiB) at addr, checking each result"
+);
@@ -74,6 +74,53 @@ U_BOOT_CMD(
 #endif
 
 
+#ifdef CONFIG_CMD_TFTPMULTI
+static int do_tftpmulti(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+	char name[16];
+	ulong addr;
+	int i, size;
+
+	if (argc < 3 || (argc - 1) % 2)
+		return CMD_RET_USAGE;
+
+	tftp_multi_reset();
+	for (i = 1; i < argc; i += 2) {
+		addr = simple_strtoul(argv[i], NULL, 16);
+		if (tftp_multi_add(addr, argv[i + 1])) {
+			printf("Too many files (max %d)\n",
+			       CONFIG_TFTP_MAX_SESSIONS);
+			return CMD_RET_FAILURE;
+		}
+	}
+
+	bootstage_mark_name(BOOTSTAGE_KERNELREAD_START, "tftp_start");
+	size = NetLoop(TFTPMULTI);
+	bootstage_mark_name(BOOTSTAGE_KERNELREAD_STOP, "tftp_done");
+	if (size < 0)
+		return CMD_RET_FAILURE;
+
+	/* filesize<n> holds the size of the n-th file, counting from 0 */
+	for (i = 0; i < (argc - 1) / 2; i++) {
+		addr = simple_strtoul(argv[1 + 2 * i], NULL, 16);
+		size = tftp_multi_size(i);
+		flush_cache(addr, size);
+		sprintf(name, "filesize%d", i);
+		setenv_hex(name, size);
+	}
+
+	return CMD_RET_SUCCESS;
+}
+
+U_BOOT_CMD(
+	tftpmulti,	CONFIG_SYS_MAXARGS,	1,	do_tftpmulti,
+	"load several files concurrently via network using TFTP protocol",
+	"addr1 [hostIPaddr:]file1 [addr2 [hostIPaddr:]file2 ...]\n"
+	"    - the size of each file is stored in filesize0, filesize1, ..."
+);
+#endif
+
 #ifdef CONFIG_CMD_RARP
 int do_rarpb(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
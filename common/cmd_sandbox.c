@@ -9,6 +9,7 @@
 #include <part.h>
 #include <sandboxblockdev.h>
 #include <asm/errno.h>
+#include <asm/nand.h>
 
 static int do_sandbox_load(cmd_tbl_t *cmdtp, int flag, int argc,
 			   char * const argv[])
@@ -85,12 +86,42 @@ static int do_sandbox_info(cmd_tbl_t *cmdtp, int flag, int argc,
 	return 0;
 }
 
+#ifdef CONFIG_NAND_SANDBOX
+static int do_sandbox_nand(cmd_tbl_t *cmdtp, int flag, int argc,
+			   char * const argv[])
+{
+	struct sandbox_nand_stats stats;
+	int reset = 0;
+
+	if (argc > 2)
+		return CMD_RET_USAGE;
+	if (argc == 2) {
+		if (strcmp(argv[1], "reset"))
+			return CMD_RET_USAGE;
+		reset = 1;
+	}
+
+	sandbox_nand_get_stats(&stats, reset);
+	printf("page loads:  %lu (%lu overlapped)\n", stats.loads,
+	       stats.cache_loads);
+	printf("programs:    %lu\n", stats.programs);
+	printf("erases:      %lu\n", stats.erases);
+	printf("bit flips:   %lu\n", stats.flips);
+	printf("busy time:   %lu us\n", stats.busy_us);
+
+	return 0;
+}
+#endif
+
 static cmd_tbl_t cmd_sandbox_sub[] = {
 	U_BOOT_CMD_MKENT(load, 7, 0, do_sandbox_load, "", ""),
 	U_BOOT_CMD_MKENT(ls, 3, 0, do_sandbox_ls, "", ""),
 	U_BOOT_CMD_MKENT(save, 6, 0, do_sandbox_save, "", ""),
 	U_BOOT_CMD_MKENT(bind, 3, 0, do_sandbox_bind, "", ""),
 	U_BOOT_CMD_MKENT(info, 3, 0, do_sandbox_info, "", ""),
+#ifdef CONFIG_NAND_SANDBOX
+	U_BOOT_CMD_MKENT(nand, 2, 0, do_sandbox_nand, "", ""),
+#endif
 };
 
 static int do_sandbox(cmd_tbl_t *cmdtp, int flag, int argc,
@@ -121,4 +152,7 @@ U_BOOT_CMD(
 		"save a file to host\n"
 	"sb bind <dev> [<filename>] - bind \"host\" device to file\n"
 	"sb info [<dev>]            - show device binding & info"
+#ifdef CONFIG_NAND_SANDBOX
+	"\nsb nand [reset]            - show (and clear) NAND activity"
+#endif
 );
@@ -21,6 +21,7 @@
 #include <linux/mtd/partitions.h>
 #include <ubi_uboot.h>
 #include <asm/errno.h>
+#include <asm/io.h>
 #include <jffs2/load_kernel.h>
 
 #undef ubi_msg
@@ -625,6 +626,7 @@ static int do_ubi(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 	}
 
 	if (strncmp(argv[1], "write", 5) == 0) {
+		void *buf;
 		int ret;
 
 		if (argc < 5) {
@@ -634,21 +636,23 @@ static int do_ubi(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 
 		addr = simple_strtoul(argv[2], NULL, 16);
 		size = simple_strtoul(argv[4], NULL, 16);
+		buf = map_sysmem(addr, size);
 
 		if (strlen(argv[1]) == 10 &&
 		    strncmp(argv[1] + 5, ".part", 5) == 0) {
 			if (argc < 6) {
 				ret = ubi_volume_continue_write(argv[3],
-						(void *)addr, size);
+						buf, size);
 			} else {
 				size_t full_size;
 				full_size = simple_strtoul(argv[5], NULL, 16);
 				ret = ubi_volume_begin_write(argv[3],
-						(void *)addr, size, full_size);
+						buf, size, full_size);
 			}
 		} else {
-			ret = ubi_volume_write(argv[3], (void *)addr, size);
+			ret = ubi_volume_write(argv[3], buf, size);
 		}
+		unmap_sysmem(buf);
 		if (!ret) {
 			printf("%lld bytes written to volume %s\n", size,
 			       argv[3]);
@@ -676,7 +680,13 @@ static int do_ubi(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 			printf("Read %lld bytes from volume %s to %lx\n", size,
 			       argv[3], addr);
 
-			return ubi_volume_read(argv[3], (char *)addr, size);
+			char *buf = map_sysmem(addr, size);
+			int ret;
+
+			ret = ubi_volume_read(argv[3], buf, size);
+			unmap_sysmem(buf);
+
+			return ret;
 		}
 	}
 
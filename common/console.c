@@ -8,7 +8,10 @@
 #include <common.h>
 #include <stdarg.h>
 #include <malloc.h>
+#include <net.h>
 #include <os.h>
+#include <ramlog.h>
+#include <asm/io.h>
 #include <serial.h>
 #include <stdio_dev.h>
 #include <exports.h>
@@ -372,6 +375,9 @@ int tstc(void)
 	if (!gd->have_console)
 		return 0;
 
+	/* ctrlc() is the tick of long commands, let netconsole catch up */
+	nc_poll();
+
 	if (gd->flags & GD_FLG_DEVINIT) {
 		/* Test the standard input */
 		return ftstc(stdin);
@@ -386,7 +392,8 @@ int tstc(void)
 
 static void pre_console_putc(const char c)
 {
-	char *buffer = (char *)CONFIG_PRE_CON_BUF_ADDR;
+	char *buffer = map_sysmem(CONFIG_PRE_CON_BUF_ADDR,
+				  CONFIG_PRE_CON_BUF_SZ);
 
 	buffer[CIRC_BUF_IDX(gd->precon_buf_idx++)] = c;
 }
@@ -400,13 +407,17 @@ static void pre_console_puts(const char *s)
 static void print_pre_console_buffer(void)
 {
 	unsigned long i = 0;
-	char *buffer = (char *)CONFIG_PRE_CON_BUF_ADDR;
+	unsigned long end = gd->precon_buf_idx;
+	char *buffer = map_sysmem(CONFIG_PRE_CON_BUF_ADDR,
+				  CONFIG_PRE_CON_BUF_SZ);
 
-	if (gd->precon_buf_idx > CONFIG_PRE_CON_BUF_SZ)
-		i = gd->precon_buf_idx - CONFIG_PRE_CON_BUF_SZ;
+	if (end > CONFIG_PRE_CON_BUF_SZ)
+		i = end - CONFIG_PRE_CON_BUF_SZ;
 
-	while (i < gd->precon_buf_idx)
+	while (i < end)
 		putc(buffer[CIRC_BUF_IDX(i++)]);
+	/* The RAM log keeps adding to the buffer, but not the replay */
+	gd->precon_buf_idx = end;
 }
 #else
 static inline void pre_console_putc(const char c) {}
@@ -422,6 +433,8 @@ void putc(const char c)
 		return;
 	}
 #endif
+	ramlog_putc(c);
+
 #ifdef CONFIG_SILENT_CONSOLE
 	if (gd->flags & GD_FLG_SILENT)
 		return;
@@ -452,6 +465,7 @@ void puts(const char *s)
 		return;
 	}
 #endif
+	ramlog_puts(s);
 
 #ifdef CONFIG_SILENT_CONSOLE
 	if (gd->flags & GD_FLG_SILENT)
@@ -930,6 +930,20 @@ struct mallinfo mALLINFo();
 #endif	/* 0 */			/* Moved to malloc.h */
 
 #include <malloc.h>
+#ifdef MALLOC_FRONT_END
+/* The front-end in malloc_front.c takes the standard names */
+#undef cALLOc
+#undef fREe
+#undef mALLOc
+#undef mEMALIGn
+#undef rEALLOc
+#define cALLOc		dlcalloc
+#define fREe		dlfree
+#define mALLOc		dlmalloc
+#define mEMALIGn	dlmemalign
+#define rEALLOc		dlrealloc
+#define malloc_usable_size	dlmalloc_usable_size
+#endif
 #ifdef DEBUG
 #if __STD_C
 static void malloc_update_mallinfo (void);
@@ -1530,6 +1544,9 @@ void mem_malloc_init(ulong start, ulong size)
 	memset((void *)mem_malloc_start, 0, size);
 
 	malloc_bin_reloc();
+#ifdef CONFIG_SYS_MALLOC_POOLS
+	malloc_pool_init();
+#endif
 }
 
 /* field-extraction macros */
@@ -3094,6 +3111,34 @@ size_t malloc_usable_size(mem) Void_t* mem;
 
 
 
+#ifdef CONFIG_SYS_MALLOC_STATS
+void malloc_heap_info(struct malloc_heap_info *info)
+{
+	mbinptr b;
+	mchunkptr p;
+	ulong size;
+	int i;
+
+	/* The top chunk can still grow up to the end of the malloc area */
+	size = chunksize(top) + mem_malloc_end - mem_malloc_brk;
+	info->free = size;
+	info->largest = size;
+	info->blocks = size ? 1 : 0;
+	info->peak = max_sbrked_mem;
+
+	for (i = 1; i < NAV; i++) {
+		b = bin_at(i);
+		for (p = last(b); p != b; p = p->bk) {
+			size = chunksize(p);
+			info->free += size;
+			if (size > info->largest)
+				info->largest = size;
+			info->blocks++;
+		}
+	}
+}
+#endif
+
 /* Utility to update current_mallinfo for malloc_stats and mallinfo() */
 
 #ifdef DEBUG
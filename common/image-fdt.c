@@ -13,7 +13,9 @@
 #include <fdt_support.h>
 #include <errno.h>
 #include <image.h>
+#include <initcall.h>
 #include <libfdt.h>
+#include <ramlog.h>
 #include <asm/io.h>
 
 #ifndef CONFIG_SYS_FDT_PAD
@@ -463,9 +465,15 @@ int image_setup_libfdt(bootm_headers_t *images, void *blob,
 		return -1;
 	}
 	arch_fixup_memory_node(blob);
+	/* A MAC address read from ROM only gets into ethaddr at net init */
+	initcall_run_deferred("eth");
 	if (IMAGE_OF_BOARD_SETUP)
 		ft_board_setup(blob, gd->bd);
 	fdt_fixup_ethernet(blob);
+#ifdef CONFIG_RAMLOG
+	if (ramlog_fdt_add(blob) < 0)
+		puts("WARNING: could not add the RAM log to the FDT\n");
+#endif
 
 	/* Delete the old LMB reservation */
 	lmb_free(lmb, (phys_addr_t)(u32)(uintptr_t)blob,
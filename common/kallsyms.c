@@ -6,6 +6,7 @@
  */
 
 #include <common.h>
+#include <linux/ctype.h>
 
 /* We need the weak marking as this symbol is provided specially */
 extern const char system_map[] __attribute__((weak));
@@ -23,16 +24,23 @@ extern const char system_map[] __attribute__((weak));
 const char *symbol_lookup(unsigned long addr, unsigned long *caddr)
 {
 	const char *sym, *csym;
-	char *esym;
 	unsigned long sym_addr;
+	int i;
 
 	sym = system_map;
 	csym = NULL;
 	*caddr = 0;
 
 	while (*sym) {
-		sym_addr = simple_strtoul(sym, &esym, 16);
-		sym = esym;
+		/*
+		 * nm pads the address to the width of a long and the name
+		 * follows directly, so a name may start with a hex digit
+		 */
+		sym_addr = 0;
+		for (i = 0; i < sizeof(long) * 2 && *sym; i++, sym++)
+			sym_addr = (sym_addr << 4) |
+				   (isdigit(*sym) ? *sym - '0' :
+				    (*sym | 0x20) - 'a' + 10);
 		if (sym_addr > addr)
 			break;
 		*caddr = sym_addr;
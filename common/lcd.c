@@ -28,6 +28,7 @@
 #include <watchdog.h>
 #include <asm/unaligned.h>
 #include <splash.h>
+#include <errno.h>
 #include <asm/io.h>
 #include <asm/unaligned.h>
 
@@ -49,6 +50,13 @@
 #include <libfdt.h>
 #endif
 
+#ifdef CONFIG_CONSOLE_SHADOW
+#include <con_shadow.h>
+#endif
+#if defined(CONFIG_SPLASH_RAW) && defined(CONFIG_GZIP)
+#include <u-boot/zlib.h>
+#endif
+
 /************************************************************************/
 /* ** FONT DATA								*/
 /************************************************************************/
@@ -134,10 +142,15 @@ static void *lcd_base;			/* Start of framebuffer memory	*/
 
 static char lcd_flush_dcache;	/* 1 to flush dcache after each lcd update */
 
+#ifdef CONFIG_CONSOLE_SHADOW
+static struct con_shadow lcd_shadow;
+static int lcd_shadow_ok;	/* 1 if the console goes through lcd_shadow */
+#endif
+
 /************************************************************************/
 
-/* Flush LCD activity to the caches */
-void lcd_sync(void)
+/* Flush LCD activity in [start, end) to the caches */
+static void lcd_sync_range(void *start, void *end)
 {
 	/*
 	 * flush_dcache_range() is declared in common.h but it seems that some
@@ -145,11 +158,9 @@ void lcd_sync(void)
 	 * out whether it exists? For now, ARM is safe.
 	 */
 #if defined(CONFIG_ARM) && !defined(CONFIG_SYS_DCACHE_OFF)
-	int line_length;
-
 	if (lcd_flush_dcache)
-		flush_dcache_range((u32)lcd_base,
-			(u32)(lcd_base + lcd_get_size(&line_length)));
+		flush_dcache_range((u32)start & ~(ARCH_DMA_MINALIGN - 1),
+				   ALIGN((u32)end, ARCH_DMA_MINALIGN));
 #elif defined(CONFIG_SANDBOX) && defined(CONFIG_VIDEO_SANDBOX_SDL)
 	static ulong last_sync;
 
@@ -160,6 +171,14 @@ void lcd_sync(void)
 #endif
 }
 
+/* Flush LCD activity to the caches */
+void lcd_sync(void)
+{
+	int line_length;
+
+	lcd_sync_range(lcd_base, lcd_base + lcd_get_size(&line_length));
+}
+
 void lcd_set_flush_dcache(int flush)
 {
 	lcd_flush_dcache = (flush != 0);
@@ -167,10 +186,109 @@ void lcd_set_flush_dcache(int flush)
 
 /*----------------------------------------------------------------------*/
 
+#ifdef CONFIG_CONSOLE_SHADOW
+/* Frame buffer address of text row @row, where lcd_drawchars() puts it */
+static void *lcd_shadow_row(int row)
+{
+	int y = row * VIDEO_FONT_HEIGHT;
+
+#if defined(CONFIG_LCD_LOGO) && !defined(CONFIG_LCD_INFO_BELOW_LOGO)
+	y += BMP_LOGO_HEIGHT;
+#endif
+	return lcd_base + y * lcd_line_length;
+}
+
+static void lcd_shadow_draw(void *priv, int col, int row, const u16 *cells,
+			    int count)
+{
+	uchar buf[32];
+	int i, n;
+
+	for (; count > 0; col += n, cells += n, count -= n) {
+		n = min(count, (int)sizeof(buf));
+		for (i = 0; i < n; i++)
+			buf[i] = cells[i];
+		lcd_drawchars(col * VIDEO_FONT_WIDTH, row * VIDEO_FONT_HEIGHT,
+			      buf, n);
+	}
+}
+
+static void lcd_shadow_clear(void *priv, int col, int row, u16 cell,
+			     int count)
+{
+	uchar *dest = lcd_shadow_row(row) +
+		col * VIDEO_FONT_WIDTH * NBITS(LCD_BPP) / 8;
+	int y;
+
+	for (y = 0; y < VIDEO_FONT_HEIGHT; y++, dest += lcd_line_length) {
+#if LCD_BPP == LCD_COLOR16
+		ushort *d = (ushort *)dest;
+		int i;
+
+		for (i = 0; i < count * VIDEO_FONT_WIDTH; i++)
+			d[i] = lcd_color_bg;
+#else
+		memset(dest, COLOR_MASK(lcd_color_bg),
+		       count * VIDEO_FONT_WIDTH * NBITS(LCD_BPP) / 8);
+#endif
+	}
+}
+
+/* Like console_scrollup(), rely on memcpy() copying upwards */
+static void lcd_shadow_move(void *priv, int dst, int src, int count)
+{
+	memcpy(lcd_shadow_row(dst), lcd_shadow_row(src),
+	       count * CONSOLE_ROW_SIZE);
+}
+
+static void lcd_shadow_sync(void *priv, int first, int last)
+{
+	lcd_sync_range(lcd_shadow_row(first), lcd_shadow_row(last + 1));
+}
+
+static const struct con_shadow_ops lcd_shadow_ops = {
+	.draw	= lcd_shadow_draw,
+	.clear	= lcd_shadow_clear,
+	.move	= lcd_shadow_move,
+	.sync	= lcd_shadow_sync,
+};
+#endif /* CONFIG_CONSOLE_SHADOW */
+
+/* Put a character in a console cell */
+static void console_putc_at(int col, int row, uchar c)
+{
+#ifdef CONFIG_CONSOLE_SHADOW
+	if (lcd_shadow_ok) {
+		con_shadow_putc(&lcd_shadow, col, row, c);
+		return;
+	}
+#endif
+	lcd_putc_xy(col * VIDEO_FONT_WIDTH, row * VIDEO_FONT_HEIGHT, c);
+}
+
+/* Bring the screen up to date after a batch of console output */
+static void console_sync(void)
+{
+#ifdef CONFIG_CONSOLE_SHADOW
+	if (lcd_shadow_ok) {
+		con_shadow_render(&lcd_shadow);
+		return;
+	}
+#endif
+	lcd_sync();
+}
+
 static void console_scrollup(void)
 {
 	const int rows = CONFIG_CONSOLE_SCROLL_LINES;
 
+#ifdef CONFIG_CONSOLE_SHADOW
+	if (lcd_shadow_ok) {
+		con_shadow_scroll(&lcd_shadow, rows);
+		console_row -= rows;
+		return;
+	}
+#endif
 	/* Copy up rows ignoring those that will be overwritten */
 	memcpy(CONSOLE_ROW_FIRST,
 	       lcd_console_address + CONSOLE_ROW_SIZE * rows,
@@ -195,8 +313,7 @@ static inline void console_back(void)
 			console_row = 0;
 	}
 
-	lcd_putc_xy(console_col * VIDEO_FONT_WIDTH,
-		console_row * VIDEO_FONT_HEIGHT, ' ');
+	console_putc_at(console_col, console_row, ' ');
 }
 
 /*----------------------------------------------------------------------*/
@@ -208,20 +325,18 @@ static inline void console_newline(void)
 	/* Check if we need to scroll the terminal */
 	if (++console_row >= CONSOLE_ROWS)
 		console_scrollup();
+#ifdef CONFIG_CONSOLE_SHADOW
+	else if (lcd_shadow_ok)
+		return;		/* console_sync() catches up */
+#endif
 	else
 		lcd_sync();
 }
 
 /*----------------------------------------------------------------------*/
 
-void lcd_putc(const char c)
+static void console_putc(const char c)
 {
-	if (!lcd_is_enabled) {
-		serial_putc(c);
-
-		return;
-	}
-
 	switch (c) {
 	case '\r':
 		console_col = 0;
@@ -244,13 +359,27 @@ void lcd_putc(const char c)
 
 		return;
 	default:
-		lcd_putc_xy(console_col * VIDEO_FONT_WIDTH,
-			console_row * VIDEO_FONT_HEIGHT, c);
+		console_putc_at(console_col, console_row, c);
 		if (++console_col >= CONSOLE_COLS)
 			console_newline();
 	}
 }
 
+void lcd_putc(const char c)
+{
+	if (!lcd_is_enabled) {
+		serial_putc(c);
+
+		return;
+	}
+
+	console_putc(c);
+#ifdef CONFIG_CONSOLE_SHADOW
+	if (lcd_shadow_ok)
+		console_sync();
+#endif
+}
+
 /*----------------------------------------------------------------------*/
 
 void lcd_puts(const char *s)
@@ -262,9 +391,9 @@ void lcd_puts(const char *s)
 	}
 
 	while (*s)
-		lcd_putc(*s++);
+		console_putc(*s++);
 
-	lcd_sync();
+	console_sync();
 }
 
 /*----------------------------------------------------------------------*/
@@ -469,6 +598,10 @@ void lcd_clear(void)
 	memset((char *)lcd_base,
 		COLOR_MASK(lcd_getbgcolor()),
 		lcd_line_length * panel_info.vl_row);
+#endif
+#ifdef CONFIG_CONSOLE_SHADOW
+	if (lcd_shadow_ok)
+		con_shadow_clear(&lcd_shadow, 1);
 #endif
 	/* Paint the logo and retrieve LCD base address */
 	debug("[LCD] Drawing the logo...\n");
@@ -513,6 +646,10 @@ static int lcd_init(void *lcdbase)
 	debug("[LCD] Using LCD frambuffer at %p\n", lcd_base);
 
 	lcd_get_size(&lcd_line_length);
+#ifdef CONFIG_CONSOLE_SHADOW
+	lcd_shadow_ok = !con_shadow_init(&lcd_shadow, CONSOLE_COLS,
+					 CONSOLE_ROWS, &lcd_shadow_ops, NULL);
+#endif
 	lcd_is_enabled = 1;
 	lcd_clear();
 	lcd_enable();
@@ -1071,6 +1208,148 @@ int lcd_display_bitmap(ulong bmp_image, int x, int y)
 	lcd_sync();
 	return 0;
 }
+
+#ifdef CONFIG_SPLASH_RAW
+#ifdef CONFIG_GZIP
+/* Inflate exactly @len bytes to @dst */
+static int splash_raw_inflate(z_stream *s, void *dst, uint len)
+{
+	int r;
+
+	s->next_out = dst;
+	s->avail_out = len;
+	while (s->avail_out) {
+		r = inflate(s, Z_SYNC_FLUSH);
+		if (r != Z_OK)
+			break;
+	}
+
+	return s->avail_out ? -EIO : 0;
+}
+#endif
+
+/*
+ * Display a raw splash image (see splash.h), which may be gzipped.
+ *
+ * Returns -ENOENT if there is no raw splash image at @addr, so that the
+ * caller can try it as a BMP instead.
+ */
+int lcd_display_splash_raw(ulong addr, int x, int y)
+{
+	struct splash_raw_header hdr;
+	uchar *src = map_sysmem(addr, 0);
+	uchar *fb, *fb_start;
+	ulong width, height, row_bytes, stride, i;
+	int bpix = NBITS(panel_info.vl_bpix);
+	int ret = 0;
+#ifdef CONFIG_GZIP
+	int line_length, gzipped = 0;
+	ulong len;
+	z_stream s;
+
+	if (src[0] == 0x1f && src[1] == 0x8b) {
+		/*
+		 * The length of the image is not known, but it cannot need
+		 * more than the frame buffer plus the overhead of deflate's
+		 * stored blocks.
+		 */
+		len = lcd_get_size(&line_length);
+		len += len / 1000 + 1024;
+		ret = gzip_parse_header(src, len);
+		if (ret < 0)
+			return -EINVAL;
+		s.zalloc = gzalloc;
+		s.zfree = gzfree;
+		s.next_in = src + ret;
+		s.avail_in = len - ret;
+		if (inflateInit2(&s, -MAX_WBITS) != Z_OK)
+			return -ENOMEM;
+		gzipped = 1;
+		ret = splash_raw_inflate(&s, &hdr, sizeof(hdr));
+	} else
+#endif
+	{
+		memcpy(&hdr, src, sizeof(hdr));
+		src += sizeof(hdr);
+	}
+
+	if (ret || memcmp(hdr.magic, SPLASH_RAW_MAGIC, sizeof(hdr.magic))) {
+		ret = -ENOENT;
+		goto out;
+	}
+
+	width = le16_to_cpu(hdr.width);
+	height = le16_to_cpu(hdr.height);
+	if (hdr.bpp != bpix) {
+		printf("Error: %d bit/pixel mode, but splash has %d bit/pixel\n",
+		       bpix, hdr.bpp);
+		ret = -EINVAL;
+		goto out;
+	}
+#ifdef __BIG_ENDIAN
+	if (!(hdr.flags & SPLASH_RAW_BIG_ENDIAN) && bpix > 8) {
+#else
+	if ((hdr.flags & SPLASH_RAW_BIG_ENDIAN) && bpix > 8) {
+#endif
+		puts("Error: splash has the wrong byte order\n");
+		ret = -EINVAL;
+		goto out;
+	}
+
+#ifdef CONFIG_SPLASH_SCREEN_ALIGN
+	splash_align_axis(&x, panel_info.vl_col, width);
+	splash_align_axis(&y, panel_info.vl_row, height);
+#endif
+	/* Rows are copied whole, so only the height can be cut */
+	if (x < 0 || y < 0 || x + width > panel_info.vl_col ||
+	    y >= panel_info.vl_row) {
+		printf("Error: %lu x %lu splash does not fit at %d,%d\n",
+		       width, height, x, y);
+		ret = -EINVAL;
+		goto out;
+	}
+	if (y + height > panel_info.vl_row)
+		height = panel_info.vl_row - y;
+
+	debug("Display-splash: %lu x %lu\n", width, height);
+	row_bytes = width * bpix / 8;
+	fb_start = (uchar *)lcd_base + y * lcd_line_length + x * bpix / 8;
+	fb = fb_start;
+	stride = lcd_line_length;
+
+	/* Full-width images are one block in the frame buffer */
+	if (row_bytes == stride) {
+		row_bytes *= height;
+		stride = row_bytes;
+		height = 1;
+	}
+	for (i = 0; i < height; i++) {
+		WATCHDOG_RESET();
+#ifdef CONFIG_GZIP
+		if (gzipped) {
+			ret = splash_raw_inflate(&s, fb, row_bytes);
+			if (ret) {
+				puts("Error: splash is truncated\n");
+				break;
+			}
+		} else
+#endif
+		{
+			memcpy(fb, src, row_bytes);
+			src += row_bytes;
+		}
+		fb += stride;
+	}
+	lcd_sync_range(fb_start, fb);
+
+out:
+#ifdef CONFIG_GZIP
+	if (gzipped)
+		inflateEnd(&s);
+#endif
+	return ret;
+}
+#endif /* CONFIG_SPLASH_RAW */
 #endif
 
 static void *lcd_logo(void)
@@ -18,6 +18,7 @@
 #include <malloc.h>
 #include <menu.h>
 #include <post.h>
+#include <ramlog.h>
 #include <version.h>
 #include <watchdog.h>
 #include <linux/ctype.h>
@@ -172,8 +173,10 @@ static int abortboot_keyed(int bootdelay)
 		debug_bootkeys("key timeout\n");
 
 #ifdef CONFIG_SILENT_CONSOLE
-	if (abort)
+	if (abort) {
 		gd->flags &= ~GD_FLG_SILENT;
+		ramlog_summary();
+	}
 #endif
 
 	return abort;
@@ -235,8 +238,10 @@ static int abortboot_normal(int bootdelay)
 	putc('\n');
 
 #ifdef CONFIG_SILENT_CONSOLE
-	if (abort)
+	if (abort) {
 		gd->flags &= ~GD_FLG_SILENT;
+		ramlog_summary();
+	}
 #endif
 
 	return abort;
@@ -0,0 +1,526 @@
+/*
+ * Front-end for dlmalloc: slab pools and heap statistics
+ *
+ * Most allocations in U-Boot are small: driver model devices and their
+ * private data, ext4 inodes, environment hash table entries, network
+ * buffers. With CONFIG_SYS_MALLOC_POOLS they come from slabs of objects of
+ * one size instead of the dlmalloc heap. That saves the per-chunk header
+ * and keeps short-lived small objects from breaking up the free space the
+ * large allocations need. With CONFIG_SYS_MALLOC_STATS every allocation is
+ * counted, and 'malloc stats' shows the peak usage, how fragmented the
+ * heap is and, with CONFIG_SYS_MALLOC_STATS_CALLERS, who allocates most.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <div64.h>
+#include <malloc.h>
+#include <asm/io.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#ifdef CONFIG_SYS_MALLOC_POOLS
+#ifndef CONFIG_SYS_MALLOC_POOL_SLAB
+#define CONFIG_SYS_MALLOC_POOL_SLAB	2048
+#endif
+
+#define POOL_SLABS	(CONFIG_SYS_MALLOC_POOLS / CONFIG_SYS_MALLOC_POOL_SLAB)
+#define POOL_BYTES	(POOL_SLABS * CONFIG_SYS_MALLOC_POOL_SLAB)
+#define POOL_NONE	0xff
+
+/* Object sizes, all multiples of the alignment malloc() guarantees */
+static const u16 pool_size[] = { 16, 32, 48, 64, 96, 128, 192, 256 };
+
+#define POOL_COUNT	ARRAY_SIZE(pool_size)
+
+struct pool_slab {
+	struct pool_slab *next;	/* in the list of its pool, or of empty slabs */
+	struct pool_slab *prev;
+	void *free;		/* freed objects, linked by their first word */
+	u16 used;		/* objects handed out */
+	u16 carved;		/* objects taken from the start of the slab */
+	u8 pool;
+};
+
+struct pool {
+	struct pool_slab *partial;	/* slabs with free objects */
+	u16 per_slab;
+	ulong allocs;
+};
+
+static char *pool_base;
+static struct pool_slab pool_slab[POOL_SLABS];
+static struct pool_slab *pool_empty;
+static struct pool pools[POOL_COUNT];
+static ulong pool_misses;	/* small objects that went to the heap */
+
+static void pool_link(struct pool_slab **head, struct pool_slab *slab)
+{
+	slab->prev = NULL;
+	slab->next = *head;
+	if (*head)
+		(*head)->prev = slab;
+	*head = slab;
+}
+
+static void pool_unlink(struct pool_slab **head, struct pool_slab *slab)
+{
+	if (slab->prev)
+		slab->prev->next = slab->next;
+	else
+		*head = slab->next;
+	if (slab->next)
+		slab->next->prev = slab->prev;
+}
+
+static char *pool_slab_mem(struct pool_slab *slab)
+{
+	return pool_base + (slab - pool_slab) * CONFIG_SYS_MALLOC_POOL_SLAB;
+}
+
+static struct pool_slab *pool_slab_of(const void *mem)
+{
+	return &pool_slab[((char *)mem - pool_base) /
+			  CONFIG_SYS_MALLOC_POOL_SLAB];
+}
+
+void malloc_pool_init(void)
+{
+	int i;
+
+	memset(pools, 0, sizeof(pools));
+	for (i = 0; i < POOL_COUNT; i++)
+		pools[i].per_slab = CONFIG_SYS_MALLOC_POOL_SLAB / pool_size[i];
+
+	/* The pools stay at the bottom of the heap for good */
+	pool_empty = NULL;
+	pool_base = dlmalloc(POOL_BYTES);
+	if (!pool_base)
+		return;
+	for (i = POOL_SLABS - 1; i >= 0; i--) {
+		pool_slab[i].pool = POOL_NONE;
+		pool_link(&pool_empty, &pool_slab[i]);
+	}
+}
+
+static int pool_owns(const void *mem)
+{
+	return pool_base && (char *)mem >= pool_base &&
+	       (char *)mem < pool_base + POOL_BYTES;
+}
+
+static size_t pool_obj_size(const void *mem)
+{
+	struct pool_slab *slab = pool_slab_of(mem);
+
+	return slab->pool == POOL_NONE ? 0 : pool_size[slab->pool];
+}
+
+static void *pool_alloc(size_t bytes)
+{
+	struct pool_slab *slab;
+	struct pool *pool;
+	void *obj;
+	int i;
+
+	if (!pool_base || bytes > pool_size[POOL_COUNT - 1])
+		return NULL;
+	for (i = 0; bytes > pool_size[i]; i++)
+		;
+	pool = &pools[i];
+
+	slab = pool->partial;
+	if (!slab) {
+		slab = pool_empty;
+		if (!slab) {
+			pool_misses++;
+			return NULL;
+		}
+		pool_unlink(&pool_empty, slab);
+		slab->pool = i;
+		slab->used = 0;
+		slab->carved = 0;
+		slab->free = NULL;
+		pool_link(&pool->partial, slab);
+	}
+
+	if (slab->free) {
+		obj = slab->free;
+		slab->free = *(void **)obj;
+	} else {
+		obj = pool_slab_mem(slab) + slab->carved++ * pool_size[i];
+	}
+	if (++slab->used == pool->per_slab)
+		pool_unlink(&pool->partial, slab);
+	pool->allocs++;
+
+	return obj;
+}
+
+static void pool_free(void *mem)
+{
+	struct pool_slab *slab = pool_slab_of(mem);
+	ulong offset = (char *)mem - pool_slab_mem(slab);
+	struct pool *pool;
+
+	if (slab->pool == POOL_NONE || offset % pool_size[slab->pool] ||
+	    offset >= slab->carved * pool_size[slab->pool]) {
+		debug("%s: bad pointer %p\n", __func__, mem);
+		return;
+	}
+
+	pool = &pools[slab->pool];
+	if (slab->used == pool->per_slab)
+		pool_link(&pool->partial, slab);
+	*(void **)mem = slab->free;
+	slab->free = mem;
+
+	/* Hand an empty slab back, so that any pool can use it */
+	if (!--slab->used) {
+		pool_unlink(&pool->partial, slab);
+		slab->pool = POOL_NONE;
+		pool_link(&pool_empty, slab);
+	}
+}
+#else
+static inline int pool_owns(const void *mem)
+{
+	return 0;
+}
+
+static inline size_t pool_obj_size(const void *mem)
+{
+	return 0;
+}
+
+static inline void *pool_alloc(size_t bytes)
+{
+	return NULL;
+}
+
+static inline void pool_free(void *mem) {}
+#endif /* CONFIG_SYS_MALLOC_POOLS */
+
+#ifdef CONFIG_SYS_MALLOC_STATS
+struct malloc_caller {
+	ulong addr;
+	ulong calls;
+	ulong bytes;		/* bytes asked for in total */
+};
+
+static struct {
+	ulong in_use;		/* usable bytes of the blocks handed out */
+	ulong peak;
+	ulong blocks;
+	ulong calls;
+	ulong frees;
+	ulong failed;
+} mstat;
+
+#ifdef CONFIG_SYS_MALLOC_STATS_CALLERS
+static struct malloc_caller malloc_caller[CONFIG_SYS_MALLOC_STATS_CALLERS];
+static ulong malloc_callers_lost;	/* calls by callers not in the table */
+
+static void malloc_account_caller(void *caller, size_t bytes)
+{
+	struct malloc_caller *mc;
+
+	/* The table fills from the start and is never thinned out */
+	for (mc = malloc_caller; mc < malloc_caller + ARRAY_SIZE(malloc_caller);
+	     mc++) {
+		if (mc->addr == (ulong)caller || !mc->addr) {
+			mc->addr = (ulong)caller;
+			mc->calls++;
+			mc->bytes += bytes;
+			return;
+		}
+	}
+	malloc_callers_lost++;
+}
+#else
+static inline void malloc_account_caller(void *caller, size_t bytes) {}
+#endif
+
+static size_t malloc_size(void *mem)
+{
+	return pool_owns(mem) ? pool_obj_size(mem) : dlmalloc_usable_size(mem);
+}
+
+/*
+ * Account for a call that returned @mem for @bytes. @old_size is the
+ * usable size of the block it replaces, if it was realloc().
+ */
+static void malloc_account(void *mem, size_t old_size, size_t bytes,
+			   void *caller)
+{
+	if (!mem) {
+		mstat.failed++;
+		return;
+	}
+
+	mstat.calls++;
+	if (!old_size)
+		mstat.blocks++;
+	mstat.in_use += malloc_size(mem) - old_size;
+	if (mstat.in_use > mstat.peak)
+		mstat.peak = mstat.in_use;
+	malloc_account_caller(caller, bytes);
+}
+
+static void malloc_account_free(void *mem)
+{
+	mstat.frees++;
+	mstat.blocks--;
+	mstat.in_use -= malloc_size(mem);
+}
+#else
+static inline size_t malloc_size(void *mem)
+{
+	return 0;
+}
+
+static inline void malloc_account(void *mem, size_t old_size, size_t bytes,
+				  void *caller) {}
+static inline void malloc_account_free(void *mem) {}
+#endif /* CONFIG_SYS_MALLOC_STATS */
+
+static void *malloc_front(size_t bytes)
+{
+	void *mem = pool_alloc(bytes);
+
+	return mem ? mem : dlmalloc(bytes);
+}
+
+void *malloc(size_t bytes)
+{
+	void *mem = malloc_front(bytes);
+
+	malloc_account(mem, 0, bytes, __builtin_return_address(0));
+
+	return mem;
+}
+
+void free(void *mem)
+{
+	if (!mem)
+		return;
+
+	malloc_account_free(mem);
+	if (pool_owns(mem))
+		pool_free(mem);
+	else
+		dlfree(mem);
+}
+
+void *realloc(void *oldmem, size_t bytes)
+{
+	void *caller = __builtin_return_address(0);
+	size_t old_size;
+	void *mem;
+
+	if (!oldmem) {
+		mem = malloc_front(bytes);
+		malloc_account(mem, 0, bytes, caller);
+		return mem;
+	}
+
+	if (!pool_owns(oldmem)) {
+		old_size = malloc_size(oldmem);
+		mem = dlrealloc(oldmem, bytes);
+		malloc_account(mem, old_size, bytes, caller);
+		return mem;
+	}
+
+	/* A pool object only moves if it has to grow */
+	old_size = pool_obj_size(oldmem);
+	mem = bytes <= old_size ? oldmem : malloc_front(bytes);
+	malloc_account(mem, old_size, bytes, caller);
+	if (mem && mem != oldmem) {
+		memcpy(mem, oldmem, old_size);
+		pool_free(oldmem);
+	}
+
+	return mem;
+}
+
+void *calloc(size_t n, size_t elem_size)
+{
+	size_t bytes = n * elem_size;
+	void *mem;
+
+	if (elem_size && bytes / elem_size != n) {
+		mem = NULL;
+	} else {
+		mem = pool_alloc(bytes);
+		if (mem)
+			memset(mem, 0, bytes);
+		else
+			mem = dlcalloc(n, elem_size);
+	}
+	malloc_account(mem, 0, bytes, __builtin_return_address(0));
+
+	return mem;
+}
+
+/* Pool objects are only aligned as malloc() needs, so leave this to dlmalloc */
+void *memalign(size_t alignment, size_t bytes)
+{
+	void *mem = dlmemalign(alignment, bytes);
+
+	malloc_account(mem, 0, bytes, __builtin_return_address(0));
+
+	return mem;
+}
+
+size_t malloc_usable_size(void *mem)
+{
+	if (pool_owns(mem))
+		return pool_obj_size(mem);
+
+	return dlmalloc_usable_size(mem);
+}
+
+#ifdef CONFIG_SYS_MALLOC_STATS
+#ifdef CONFIG_SYS_MALLOC_POOLS
+static void malloc_print_pools(void)
+{
+	ulong slabs[POOL_COUNT] = { 0 }, used[POOL_COUNT] = { 0 };
+	struct pool_slab *slab;
+	int i;
+
+	if (!pool_base)
+		return;
+
+	for (slab = pool_slab; slab < pool_slab + POOL_SLABS; slab++) {
+		if (slab->pool == POOL_NONE)
+			continue;
+		slabs[slab->pool]++;
+		used[slab->pool] += slab->used;
+	}
+
+	printf("pools         =  %d slabs of %d bytes at %08lx, %lu misses\n",
+	       POOL_SLABS, CONFIG_SYS_MALLOC_POOL_SLAB,
+	       (ulong)map_to_sysmem(pool_base), pool_misses);
+	printf("  size  slabs   used   free     allocs\n");
+	for (i = 0; i < POOL_COUNT; i++)
+		printf("  %4d  %5lu  %5lu  %5lu  %9lu\n", pool_size[i],
+		       slabs[i], used[i],
+		       slabs[i] * pools[i].per_slab - used[i], pools[i].allocs);
+}
+#endif
+
+#ifdef CONFIG_SYS_MALLOC_STATS_CALLERS
+static int malloc_caller_cmp(const void *a, const void *b)
+{
+	const struct malloc_caller *ca = a, *cb = b;
+
+	/* Unused entries last, the rest by bytes asked for, most first */
+	if (!ca->addr || !cb->addr)
+		return !ca->addr - !cb->addr;
+	if (ca->bytes != cb->bytes)
+		return ca->bytes < cb->bytes ? 1 : -1;
+
+	return 0;
+}
+
+/* Sandbox does not move its code, so there is no offset to take off */
+static ulong malloc_caller_addr(ulong addr)
+{
+#ifdef CONFIG_SANDBOX
+	return addr;
+#else
+	return addr - gd->reloc_off;
+#endif
+}
+
+static void malloc_print_callers(void)
+{
+	struct malloc_caller *end = malloc_caller + ARRAY_SIZE(malloc_caller);
+	struct malloc_caller *mc;
+
+	/* Order does not matter for the lookup, so sort in place */
+	qsort(malloc_caller, ARRAY_SIZE(malloc_caller), sizeof(*malloc_caller),
+	      malloc_caller_cmp);
+
+	printf("  caller        calls       bytes\n");
+	for (mc = malloc_caller; mc < end && mc->addr; mc++)
+		printf("  %08lx  %9lu  %10lu\n", malloc_caller_addr(mc->addr),
+		       mc->calls, mc->bytes);
+	if (malloc_callers_lost)
+		printf("  (%lu calls from further callers)\n",
+		       malloc_callers_lost);
+}
+#endif
+
+void malloc_print_stats(void)
+{
+	struct malloc_heap_info info;
+	ulong frag = 0;
+
+	malloc_heap_info(&info);
+	if (info.free)
+		frag = lldiv((u64)(info.free - info.largest) * 100, info.free);
+
+	printf("heap          =  %08lx, %lu bytes, %lu used at most\n",
+	       (ulong)map_to_sysmem((void *)mem_malloc_start),
+	       mem_malloc_end - mem_malloc_start, info.peak);
+	printf("in use        =  %lu bytes in %lu blocks, peak %lu\n",
+	       mstat.in_use, mstat.blocks, mstat.peak);
+	printf("calls         =  %lu, %lu frees, %lu failed\n", mstat.calls,
+	       mstat.frees, mstat.failed);
+	printf("free          =  %lu bytes in %lu blocks, largest %lu\n",
+	       info.free, info.blocks, info.largest);
+	printf("fragmentation =  %lu%%\n", frag);
+#ifdef CONFIG_SYS_MALLOC_POOLS
+	malloc_print_pools();
+#endif
+#ifdef CONFIG_SYS_MALLOC_STATS_CALLERS
+	malloc_print_callers();
+#endif
+}
+
+#ifndef CONFIG_SPL_BUILD
+static void malloc_reset_stats(void)
+{
+#ifdef CONFIG_SYS_MALLOC_POOLS
+	int i;
+
+	for (i = 0; i < POOL_COUNT; i++)
+		pools[i].allocs = 0;
+	pool_misses = 0;
+#endif
+#ifdef CONFIG_SYS_MALLOC_STATS_CALLERS
+	memset(malloc_caller, 0, sizeof(malloc_caller));
+	malloc_callers_lost = 0;
+#endif
+	mstat.peak = mstat.in_use;
+	mstat.calls = 0;
+	mstat.frees = 0;
+	mstat.failed = 0;
+}
+
+static int do_malloc(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	if (argc != 2)
+		return CMD_RET_USAGE;
+
+	if (!strcmp(argv[1], "stats"))
+		malloc_print_stats();
+	else if (!strcmp(argv[1], "reset"))
+		malloc_reset_stats();
+	else
+		return CMD_RET_USAGE;
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	malloc,	2,	1,	do_malloc,
+	"show malloc() statistics",
+	"stats  - show heap and pool usage, and the biggest callers\n"
+	"malloc reset  - restart the peak and the call counts"
+);
+#endif /* !CONFIG_SPL_BUILD */
+#endif /* CONFIG_SYS_MALLOC_STATS */
@@ -11,6 +11,7 @@
  */
 
 #include <common.h>
+#include <initcall.h>
 #include <miiphy.h>
 #include <phy.h>
 
@@ -40,6 +41,8 @@ struct mii_dev *miiphy_get_dev_by_name(const char *devname)
 	struct list_head *entry;
 	struct mii_dev *dev;
 
+	/* The buses are registered by the ethernet drivers */
+	initcall_run_deferred("eth");
 	if (!devname) {
 		printf("NULL device name!\n");
 		return NULL;
@@ -176,6 +179,7 @@ void mdio_list_devices(void)
 {
 	struct list_head *entry;
 
+	initcall_run_deferred("eth");
 	list_for_each(entry, &mii_devs) {
 		int i;
 		struct mii_dev *bus = list_entry(entry, struct mii_dev, link);
@@ -214,6 +218,7 @@ int miiphy_set_current_dev(const char *devname)
 
 struct mii_dev *mdio_get_current_dev(void)
 {
+	initcall_run_deferred("eth");
 	return current_mii;
 }
 
@@ -222,6 +227,7 @@ struct phy_device *mdio_phydev_for_ethname(const char *ethname)
 	struct list_head *entry;
 	struct mii_dev *bus;
 
+	initcall_run_deferred("eth");
 	list_for_each(entry, &mii_devs) {
 		int i;
 		bus = list_entry(entry, struct mii_dev, link);
@@ -241,6 +247,7 @@ struct phy_device *mdio_phydev_for_ethname(const char *ethname)
 
 const char *miiphy_get_current_dev(void)
 {
+	initcall_run_deferred("eth");
 	if (current_mii)
 		return current_mii->name;
 
@@ -320,6 +327,7 @@ void miiphy_listdev(void)
 	struct list_head *entry;
 	struct mii_dev *dev;
 
+	initcall_run_deferred("eth");
 	puts("MII devices: ");
 	list_for_each(entry, &mii_devs) {
 		dev = list_entry(entry, struct mii_dev, link);
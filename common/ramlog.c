@@ -0,0 +1,272 @@
+/*
+ * RAM log of console output
+ *
+ * Everything printed after relocation is kept in a ring buffer at the top
+ * of RAM, including what silent mode keeps off the console devices; with
+ * CONFIG_PRE_CONSOLE_BUFFER, so is what was printed before. A
+ * silent boot then costs no serial time but loses nothing: the log can be
+ * replayed with the 'log' command and is handed to the OS through the
+ * device tree.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <libfdt.h>
+#include <ramlog.h>
+#include <asm/io.h>
+
+#ifdef CONFIG_LOGBUFFER
+#error "CONFIG_RAMLOG and CONFIG_LOGBUFFER both provide the 'log' command"
+#endif
+
+DECLARE_GLOBAL_DATA_PTR;
+
+static struct ramlog_hdr *ramlog;
+static int ramlog_paused;	/* replaying the log, don't record it again */
+static ulong ramlog_hidden;	/* lines kept off the console */
+
+ulong ramlog_base(void)
+{
+	return gd->ram_top - CONFIG_RAMLOG_SIZE;
+}
+
+#ifdef CONFIG_PRE_CONSOLE_BUFFER
+/*
+ * Until the log is set up, output goes to the pre-console buffer. The
+ * console code fills it only until the console is up, carry on from
+ * there so that ramlog_init() finds all of it.
+ */
+static void ramlog_pre_putc(const char c)
+{
+	char *buffer;
+
+	if (!gd->have_console)
+		return;
+	buffer = map_sysmem(CONFIG_PRE_CON_BUF_ADDR, CONFIG_PRE_CON_BUF_SZ);
+	buffer[gd->precon_buf_idx++ % CONFIG_PRE_CON_BUF_SZ] = c;
+}
+
+static void ramlog_pre_puts(const char *s)
+{
+	while (*s)
+		ramlog_pre_putc(*s++);
+}
+
+static void ramlog_seed(void)
+{
+	char *buffer = map_sysmem(CONFIG_PRE_CON_BUF_ADDR,
+				  CONFIG_PRE_CON_BUF_SZ);
+	ulong i = 0;
+
+	if (gd->precon_buf_idx > CONFIG_PRE_CON_BUF_SZ)
+		i = gd->precon_buf_idx - CONFIG_PRE_CON_BUF_SZ;
+	while (i < gd->precon_buf_idx)
+		ramlog->buf[ramlog->head++ % ramlog->size] =
+			buffer[i++ % CONFIG_PRE_CON_BUF_SZ];
+}
+#else
+static inline void ramlog_pre_putc(const char c) {}
+static inline void ramlog_pre_puts(const char *s) {}
+static inline void ramlog_seed(void) {}
+#endif
+
+void ramlog_init(void)
+{
+	ramlog = map_sysmem(ramlog_base(), CONFIG_RAMLOG_SIZE);
+	ramlog->magic = RAMLOG_MAGIC;
+	ramlog->size = CONFIG_RAMLOG_SIZE - sizeof(*ramlog);
+	ramlog->head = 0;
+	ramlog->reserved = 0;
+	ramlog_seed();
+}
+
+/* The pointer to the log is in .bss, so it is only valid after relocation */
+static int ramlog_ready(void)
+{
+	return (gd->flags & GD_FLG_RELOC) && ramlog;
+}
+
+static int ramlog_active(void)
+{
+	return ramlog_ready() && !ramlog_paused;
+}
+
+static void ramlog_count_hidden(const char *s, uint len)
+{
+#ifdef CONFIG_SILENT_CONSOLE
+	if (!(gd->flags & GD_FLG_SILENT))
+		return;
+	while (len--)
+		if (*s++ == '\n')
+			ramlog_hidden++;
+#endif
+}
+
+void ramlog_putc(const char c)
+{
+	if (!ramlog_ready()) {
+		ramlog_pre_putc(c);
+		return;
+	}
+	if (!ramlog_active())
+		return;
+
+	ramlog->buf[ramlog->head++ % ramlog->size] = c;
+	ramlog_count_hidden(&c, 1);
+}
+
+void ramlog_puts(const char *s)
+{
+	uint len, pos, n;
+
+	if (!ramlog_ready()) {
+		ramlog_pre_puts(s);
+		return;
+	}
+	if (!ramlog_active())
+		return;
+
+	len = strlen(s);
+	ramlog_count_hidden(s, len);
+	pos = ramlog->head % ramlog->size;
+	ramlog->head += len;
+	/* Only the end of a string longer than the log survives */
+	if (len > ramlog->size) {
+		pos = (pos + len - ramlog->size) % ramlog->size;
+		s += len - ramlog->size;
+		len = ramlog->size;
+	}
+	while (len) {
+		n = min(len, ramlog->size - pos);
+		memcpy(ramlog->buf + pos, s, n);
+		s += n;
+		len -= n;
+		pos = 0;
+	}
+}
+
+void ramlog_summary(void)
+{
+	ulong flags = gd->flags;
+
+	if (!ramlog_hidden)
+		return;
+
+	gd->flags &= ~GD_FLG_SILENT;
+	ramlog_paused = 1;
+	printf("(%lu lines of output hidden, 'log show' to replay)\n",
+	       ramlog_hidden);
+	ramlog_paused = 0;
+	gd->flags = flags;
+	ramlog_hidden = 0;
+}
+
+#ifdef CONFIG_OF_LIBFDT
+static void ramlog_put_cells(fdt32_t **cellp, int cells, u64 val)
+{
+	fdt32_t *cell = *cellp;
+
+	if (cells == 2)
+		*cell++ = cpu_to_fdt32(val >> 32);
+	*cell++ = cpu_to_fdt32(val);
+	*cellp = cell;
+}
+
+static int ramlog_get_cells(void *blob, const char *name, int def)
+{
+	const fdt32_t *prop = fdt_getprop(blob, 0, name, NULL);
+
+	return prop ? fdt32_to_cpu(*prop) : def;
+}
+
+int ramlog_fdt_add(void *blob)
+{
+	ulong base = ramlog_base();
+	fdt32_t reg[4], *cell = reg;
+	uint64_t addr, size;
+	int node, ret, i;
+
+	if (!ramlog)
+		return 0;
+
+	/* Keep the OS off the log, unless an earlier boot did so already */
+	for (i = 0; i < fdt_num_mem_rsv(blob); i++) {
+		fdt_get_mem_rsv(blob, i, &addr, &size);
+		if (addr == base)
+			break;
+	}
+	if (i == fdt_num_mem_rsv(blob)) {
+		ret = fdt_add_mem_rsv(blob, base, CONFIG_RAMLOG_SIZE);
+		if (ret)
+			return ret;
+	}
+
+	node = fdt_subnode_offset(blob, 0, "u-boot-log");
+	if (node < 0)
+		node = fdt_add_subnode(blob, 0, "u-boot-log");
+	if (node < 0)
+		return node;
+
+	ramlog_put_cells(&cell, ramlog_get_cells(blob, "#address-cells", 2),
+			 base);
+	ramlog_put_cells(&cell, ramlog_get_cells(blob, "#size-cells", 1),
+			 CONFIG_RAMLOG_SIZE);
+	ret = fdt_setprop_string(blob, node, "compatible", "u-boot,ram-log");
+	if (!ret)
+		ret = fdt_setprop(blob, node, "reg", reg,
+				  (cell - reg) * sizeof(*reg));
+
+	return ret;
+}
+#endif /* CONFIG_OF_LIBFDT */
+
+static void ramlog_show(void)
+{
+	char buf[128];
+	uint i, n, pos;
+
+	i = ramlog->head > ramlog->size ? ramlog->head - ramlog->size : 0;
+	ramlog_paused = 1;
+	while (i != ramlog->head) {
+		pos = i % ramlog->size;
+		n = min(ramlog->head - i, ramlog->size - pos);
+		n = min(n, sizeof(buf) - 1);
+		memcpy(buf, ramlog->buf + pos, n);
+		buf[n] = '\0';
+		puts(buf);
+		i += n;
+	}
+	ramlog_paused = 0;
+}
+
+static int do_log(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
+{
+	if (argc != 2 || !ramlog)
+		return CMD_RET_USAGE;
+
+	if (!strcmp(argv[1], "show")) {
+		ramlog_show();
+	} else if (!strcmp(argv[1], "info")) {
+		printf("RAM log at %08lx, %u bytes\n", ramlog_base(),
+		       ramlog->size);
+		printf("written      =  %08x\n", ramlog->head);
+		printf("hidden lines =  %lu\n", ramlog_hidden);
+	} else if (!strcmp(argv[1], "reset")) {
+		ramlog->head = 0;
+		ramlog_hidden = 0;
+	} else {
+		return CMD_RET_USAGE;
+	}
+
+	return 0;
+}
+
+U_BOOT_CMD(
+	log,	2,	1,	do_log,
+	"show the RAM log of console output",
+	"show   - replay the log on the console\n"
+	"log info   - show where the log is and how much it holds\n"
+	"log reset  - clear the log"
+);
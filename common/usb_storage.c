@@ -33,6 +33,7 @@
 
 #include <common.h>
 #include <command.h>
+#include <malloc.h>
 #include <asm/byteorder.h>
 #include <asm/processor.h>
 
@@ -144,6 +145,26 @@ struct us_data {
 
 static struct us_data usb_stor[USB_MAX_STOR_DEV];
 
+/*
+ * Data buffers that are not cache line aligned cannot be handed to the host
+ * controller, as invalidating the cache over them would also drop whatever
+ * shares their first and last line. They go through this bounce buffer
+ * instead, as many blocks at a time as it holds. Aligned buffers are used
+ * for the transfer directly.
+ */
+#define USB_STOR_BOUNCE_SIZE	(64 << 10)
+
+static void *usb_stor_bounce;
+
+/* Per device transfer counts, shown by 'usb storage' */
+struct usb_stor_stats {
+	unsigned long	direct_blks;	/* blocks moved in place */
+	unsigned long	bounce_blks;	/* blocks moved via the bounce buffer */
+	unsigned long	copies;		/* copies to/from the bounce buffer */
+};
+
+static struct usb_stor_stats usb_stor_stats[USB_MAX_STOR_DEV];
+
 
 #define USB_STOR_TRANSPORT_GOOD	   0
 #define USB_STOR_TRANSPORT_FAILED -1
@@ -184,6 +205,11 @@ int usb_stor_info(void)
 		for (i = 0; i < usb_max_devs; i++) {
 			printf("  Device %d: ", i);
 			dev_print(&usb_dev_desc[i]);
+			printf("            Transfers: %lu blocks in place, "
+			       "%lu bounced in %lu copies\n",
+			       usb_stor_stats[i].direct_blks,
+			       usb_stor_stats[i].bounce_blks,
+			       usb_stor_stats[i].copies);
 		}
 		return 0;
 	}
@@ -231,7 +257,10 @@ int usb_stor_scan(int mode)
 		usb_dev_desc[i].type = DEV_TYPE_UNKNOWN;
 		usb_dev_desc[i].block_read = usb_stor_read;
 		usb_dev_desc[i].block_write = usb_stor_write;
+		/* unaligned buffers are bounced here, see usb_stor_bounce */
+		usb_dev_desc[i].any_align = 1;
 	}
+	memset(usb_stor_stats, '\0', sizeof(usb_stor_stats));
 
 	usb_max_devs = 0;
 	for (i = 0; i < USB_MAX_DEVICE; i++) {
@@ -1037,6 +1066,30 @@ static void usb_bin_fixup(struct usb_device_descriptor descriptor,
 }
 #endif /* CONFIG_USB_BIN_FIXUP */
 
+/*
+ * Return the bounce buffer if @buf_addr is not cache line aligned, cutting
+ * *blks down to what fits in it, or NULL to transfer in place.
+ */
+static void *usb_stor_bounce_buf(int device, uintptr_t buf_addr,
+				 unsigned short *blks)
+{
+	unsigned long max = USB_STOR_BOUNCE_SIZE / usb_dev_desc[device].blksz;
+
+	if (!(buf_addr & (ARCH_DMA_MINALIGN - 1)) || !max)
+		return NULL;
+
+	if (!usb_stor_bounce) {
+		usb_stor_bounce = memalign(ARCH_DMA_MINALIGN,
+					   USB_STOR_BOUNCE_SIZE);
+		if (!usb_stor_bounce)
+			return NULL;
+	}
+	if (*blks > max)
+		*blks = max;
+
+	return usb_stor_bounce;
+}
+
 unsigned long usb_stor_read(int device, lbaint_t blknr,
 			    lbaint_t blkcnt, void *buffer)
 {
@@ -1045,6 +1098,7 @@ unsigned long usb_stor_read(int device, lbaint_t blknr,
 	unsigned short smallblks;
 	struct usb_device *dev;
 	struct us_data *ss;
+	void *bounce;
 	int retry, i;
 	ccb *srb = &usb_ccb;
 
@@ -1081,24 +1135,37 @@ unsigned long usb_stor_read(int device, lbaint_t blknr,
 			smallblks = USB_MAX_XFER_BLK;
 		else
 			smallblks = (unsigned short) blks;
+		bounce = usb_stor_bounce_buf(device, buf_addr, &smallblks);
 retry_it:
 		if (smallblks == USB_MAX_XFER_BLK)
 			usb_show_progress();
 		srb->datalen = usb_dev_desc[device].blksz * smallblks;
-		srb->pdata = (unsigned char *)buf_addr;
+		srb->pdata = bounce ? bounce : (unsigned char *)buf_addr;
 		if (usb_read_10(srb, ss, start, smallblks)) {
 			debug("Read ERROR\n");
 			usb_request_sense(srb, ss);
+			ss->flags &= ~USB_READY;
 			if (retry--)
 				goto retry_it;
 			blkcnt -= blks;
 			break;
 		}
+		/*
+		 * The device has answered, there is no need to wait after
+		 * the CBW of the next command until it fails again.
+		 */
+		ss->flags |= USB_READY;
+		if (bounce) {
+			memcpy((void *)buf_addr, bounce, srb->datalen);
+			usb_stor_stats[device].bounce_blks += smallblks;
+			usb_stor_stats[device].copies++;
+		} else {
+			usb_stor_stats[device].direct_blks += smallblks;
+		}
 		start += smallblks;
 		blks -= smallblks;
 		buf_addr += srb->datalen;
 	} while (blks != 0);
-	ss->flags &= ~USB_READY;
 
 	debug("usb_read: end startblk " LBAF
 	      ", blccnt %x buffer %lx\n",
@@ -1118,6 +1185,7 @@ unsigned long usb_stor_write(int device, lbaint_t blknr,
 	unsigned short smallblks;
 	struct usb_device *dev;
 	struct us_data *ss;
+	void *bounce;
 	int retry, i;
 	ccb *srb = &usb_ccb;
 
@@ -1157,24 +1225,38 @@ unsigned long usb_stor_write(int device, lbaint_t blknr,
 			smallblks = USB_MAX_XFER_BLK;
 		else
 			smallblks = (unsigned short) blks;
+		bounce = usb_stor_bounce_buf(device, buf_addr, &smallblks);
+		if (bounce) {
+			memcpy(bounce, (void *)buf_addr,
+			       usb_dev_desc[device].blksz * smallblks);
+			usb_stor_stats[device].bounce_blks += smallblks;
+			usb_stor_stats[device].copies++;
+		} else {
+			usb_stor_stats[device].direct_blks += smallblks;
+		}
 retry_it:
 		if (smallblks == USB_MAX_XFER_BLK)
 			usb_show_progress();
 		srb->datalen = usb_dev_desc[device].blksz * smallblks;
-		srb->pdata = (unsigned char *)buf_addr;
+		srb->pdata = bounce ? bounce : (unsigned char *)buf_addr;
 		if (usb_write_10(srb, ss, start, smallblks)) {
 			debug("Write ERROR\n");
 			usb_request_sense(srb, ss);
+			ss->flags &= ~USB_READY;
 			if (retry--)
 				goto retry_it;
 			blkcnt -= blks;
 			break;
 		}
+		/*
+		 * The device has answered, there is no need to wait after
+		 * the CBW of the next command until it fails again.
+		 */
+		ss->flags |= USB_READY;
 		start += smallblks;
 		blks -= smallblks;
 		buf_addr += srb->datalen;
 	} while (blks != 0);
-	ss->flags &= ~USB_READY;
 
 	debug("usb_write: end startblk " LBAF ", blccnt %x buffer %lx\n",
 	      start, smallblks, buf_addr);
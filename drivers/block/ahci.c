@@ -37,6 +37,19 @@ u16 *ataid[AHCI_MAX_PORTS];
 #define MAX_SATA_BLOCKS_READ_WRITE	0x80
 #endif
 
+/*
+ * With native command queuing, up to AHCI_NCQ_MAX_SLOTS such requests are
+ * kept in flight at once, each with its own command table.
+ */
+#ifdef CONFIG_AHCI_NCQ
+#ifndef AHCI_NCQ_MAX_SLOTS
+#define AHCI_NCQ_MAX_SLOTS	AHCI_MAX_CMD_SLOT
+#endif
+#define AHCI_NCQ_TBL_SZ		((AHCI_NCQ_MAX_SLOTS - 1) * (AHCI_CMD_TBL_SZ))
+#else
+#define AHCI_NCQ_TBL_SZ		0
+#endif
+
 /* Maximum timeouts for each event */
 #define WAIT_MS_SPINUP	20000
 #define WAIT_MS_DATAIO	5000
@@ -101,10 +114,16 @@ static int waiting_for_cmd_completed(volatile u8 *offset,
 	int i;
 	u32 status;
 
-	for (i = 0; ((status = readl(offset)) & sign) && i < timeout_msec; i++)
-		msleep(1);
+	/*
+	 * Poll every microsecond: a whole request of
+	 * MAX_SATA_BLOCKS_READ_WRITE blocks takes an SSD far less than a
+	 * millisecond.
+	 */
+	for (i = 0; ((status = readl(offset)) & sign) &&
+		    i < timeout_msec * 1000; i++)
+		udelay(1);
 
-	return (i < timeout_msec) ? 0 : -1;
+	return (i < timeout_msec * 1000) ? 0 : -1;
 }
 
 int __weak ahci_link_up(struct ahci_probe_ent *probe_ent, u8 port)
@@ -422,10 +441,9 @@ static int ahci_init_one(pci_dev_t pdev)
 
 #define MAX_DATA_BYTE_COUNT  (4*1024*1024)
 
-static int ahci_fill_sg(u8 port, unsigned char *buf, int buf_len)
+static int ahci_fill_sg(struct ahci_sg *ahci_sg, unsigned char *buf,
+			int buf_len)
 {
-	struct ahci_ioports *pp = &(probe_ent->port[port]);
-	struct ahci_sg *ahci_sg = pp->cmd_tbl_sg;
 	u32 sg_count;
 	int i;
 
@@ -505,7 +523,7 @@ static int ahci_port_start(u8 port)
 		return -1;
 	}
 
-	mem = (u32) malloc(AHCI_PORT_PRIV_DMA_SZ + 2048);
+	mem = (u32) malloc(AHCI_PORT_PRIV_DMA_SZ + AHCI_NCQ_TBL_SZ + 2048);
 	if (!mem) {
 		free(pp);
 		printf("%s: No mem for table!\n", __func__);
@@ -513,7 +531,7 @@ static int ahci_port_start(u8 port)
 	}
 
 	mem = (mem + 0x800) & (~0x7ff);	/* Aligned to 2048-bytes */
-	memset((u8 *) mem, 0, AHCI_PORT_PRIV_DMA_SZ);
+	memset((u8 *) mem, 0, AHCI_PORT_PRIV_DMA_SZ + AHCI_NCQ_TBL_SZ);
 
 	/*
 	 * First item in chunk of DMA memory: 32-slot command table,
@@ -522,7 +540,7 @@ static int ahci_port_start(u8 port)
 	pp->cmd_slot =
 		(struct ahci_cmd_hdr *)(uintptr_t)virt_to_phys((void *)mem);
 	debug("cmd_slot = 0x%x\n", (unsigned)pp->cmd_slot);
-	mem += (AHCI_CMD_SLOT_SZ + 224);
+	mem += AHCI_CMD_SLOT_SZ * AHCI_MAX_CMD_SLOT;
 
 	/*
 	 * Second item: Received-FIS area
@@ -532,7 +550,8 @@ static int ahci_port_start(u8 port)
 
 	/*
 	 * Third item: data area for storing a single command
-	 * and its scatter-gather table
+	 * and its scatter-gather table. With NCQ, the tables of
+	 * the other slots follow it.
 	 */
 	pp->cmd_tbl = virt_to_phys((void *)mem);
 	debug("cmd_tbl_dma = 0x%x\n", pp->cmd_tbl);
@@ -580,7 +599,7 @@ static int ahci_device_data_io(u8 port, u8 *fis, int fis_len, u8 *buf,
 
 	memcpy((unsigned char *)pp->cmd_tbl, fis, fis_len);
 
-	sg_count = ahci_fill_sg(port, buf, buf_len);
+	sg_count = ahci_fill_sg(pp->cmd_tbl_sg, buf, buf_len);
 	opts = (fis_len >> 2) | (sg_count << 16) | (is_write << 6);
 	ahci_fill_cmd_slot(pp, opts);
 
@@ -602,6 +621,174 @@ static int ahci_device_data_io(u8 port, u8 *fis, int fis_len, u8 *buf,
 }
 
 
+#ifdef CONFIG_AHCI_NCQ
+/*
+ * Use NCQ on a port if both the controller and the identified device
+ * support it. A queue of one would gain nothing over the plain commands.
+ */
+static void ahci_ncq_setup(u8 port, u16 *id)
+{
+	struct ahci_ioports *pp = &(probe_ent->port[port]);
+	u32 depth = 0;
+
+	if ((probe_ent->cap & HOST_CAP_NCQ) && ata_id_has_ncq(id)) {
+		depth = ata_id_queue_depth(id);
+		depth = min(depth, ((probe_ent->cap >> 8) & 0x1f) + 1);
+		depth = min(depth, (u32)AHCI_NCQ_MAX_SLOTS);
+	}
+	pp->ncq_depth = depth > 1 ? depth : 0;
+	debug("scsi_ahci: port %d NCQ depth %d\n", port, pp->ncq_depth);
+}
+
+/*
+ * After an error the port stops processing its command list until it is
+ * restarted, and the device rejects further commands until the NCQ error
+ * log has been read.
+ */
+static void ahci_ncq_recover(u8 port)
+{
+	struct ahci_ioports *pp = &(probe_ent->port[port]);
+	volatile u8 *port_mmio = (volatile u8 *)pp->port_mmio;
+	ALLOC_CACHE_ALIGN_BUFFER(u8, log, ATA_SECT_SIZE);
+	u8 fis[20];
+	u32 tmp;
+
+	tmp = readl(port_mmio + PORT_CMD);
+	writel_with_flush(tmp & ~PORT_CMD_START, port_mmio + PORT_CMD);
+	waiting_for_cmd_completed(port_mmio + PORT_CMD, 500,
+				  PORT_CMD_LIST_ON);
+
+	writel(readl(port_mmio + PORT_SCR_ERR), port_mmio + PORT_SCR_ERR);
+	writel(readl(port_mmio + PORT_IRQ_STAT), port_mmio + PORT_IRQ_STAT);
+
+	tmp = readl(port_mmio + PORT_CMD);
+	if ((readl(port_mmio + PORT_TFDATA) & (ATA_BUSY | ATA_DRQ)) &&
+	    (probe_ent->cap & HOST_CAP_CLO)) {
+		writel_with_flush(tmp | PORT_CMD_CLO, port_mmio + PORT_CMD);
+		waiting_for_cmd_completed(port_mmio + PORT_CMD, 500,
+					  PORT_CMD_CLO);
+	}
+	writel_with_flush(tmp | PORT_CMD_START, port_mmio + PORT_CMD);
+
+	memset(fis, 0, sizeof(fis));
+	fis[0] = 0x27;		/* Host to device FIS. */
+	fis[1] = 1 << 7;	/* Command FIS. */
+	fis[2] = ATA_CMD_READ_LOG_EXT;
+	fis[4] = ATA_LOG_SATA_NCQ;
+	fis[12] = 1;		/* one page */
+	if (ahci_device_data_io(port, fis, sizeof(fis), log, ATA_SECT_SIZE, 0))
+		printf("scsi_ahci: can't read NCQ error log on port %d\n",
+		       port);
+}
+
+static void ahci_ncq_fill_slot(struct ahci_ioports *pp, int tag, u32 lba,
+			       u32 blocks, u8 *buf, u8 is_write)
+{
+	struct ahci_cmd_hdr *cmd_slot = pp->cmd_slot + tag;
+	u32 cmd_tbl = pp->cmd_tbl + tag * (AHCI_CMD_TBL_SZ);
+	u8 *fis = (u8 *)cmd_tbl;
+	int sg_count;
+
+	memset(fis, 0, 20);
+	fis[0] = 0x27;		/* Host to device FIS. */
+	fis[1] = 1 << 7;	/* Command FIS. */
+	fis[2] = is_write ? ATA_CMD_FPDMA_WRITE : ATA_CMD_FPDMA_READ;
+	fis[3] = blocks & 0xff;	/* features: block count */
+	fis[4] = (lba >> 0) & 0xff;
+	fis[5] = (lba >> 8) & 0xff;
+	fis[6] = (lba >> 16) & 0xff;
+	fis[7] = 1 << 6;	/* device reg: set LBA mode */
+	fis[8] = (lba >> 24) & 0xff;
+	fis[11] = (blocks >> 8) & 0xff;
+	fis[12] = tag << 3;	/* sector count: tag */
+
+	sg_count = ahci_fill_sg((struct ahci_sg *)(cmd_tbl + AHCI_CMD_TBL_HDR),
+				buf, blocks * ATA_SECT_SIZE);
+
+	cmd_slot->opts = cpu_to_le32(5 | (sg_count << 16) | (is_write << 6));
+	cmd_slot->status = 0;
+	cmd_slot->tbl_addr = cpu_to_le32(cmd_tbl);
+	cmd_slot->tbl_addr_hi = 0;
+
+	ahci_dcache_flush_range((unsigned long)pp->cmd_slot,
+				AHCI_CMD_SLOT_SZ * AHCI_MAX_CMD_SLOT);
+	ahci_dcache_flush_range(cmd_tbl, AHCI_CMD_TBL_SZ);
+}
+
+/*
+ * READ/WRITE FPDMA QUEUED: split the request as the plain path does, but
+ * keep a command in every free slot instead of waiting for each one.
+ */
+static int ahci_ncq_read_write(u8 port, u32 lba, u32 blocks, u8 *buf,
+			       u8 is_write)
+{
+	struct ahci_ioports *pp = &(probe_ent->port[port]);
+	volatile u8 *port_mmio = (volatile u8 *)pp->port_mmio;
+	u32 len = blocks * ATA_SECT_SIZE;
+	u8 *start_buf = buf;
+	u32 busy = 0, done, act, tf;
+	ulong start;
+	int tag;
+
+	ahci_dcache_flush_range((unsigned)buf, len);
+	writel(readl(port_mmio + PORT_IRQ_STAT), port_mmio + PORT_IRQ_STAT);
+
+	start = get_timer(0);
+	while (blocks || busy) {
+		for (tag = 0; blocks && tag < pp->ncq_depth; tag++) {
+			u32 now_blocks;
+
+			if (busy & (1 << tag))
+				continue;
+
+			now_blocks = min(blocks, (u32)MAX_SATA_BLOCKS_READ_WRITE);
+			ahci_ncq_fill_slot(pp, tag, lba, now_blocks, buf,
+					   is_write);
+			writel(1 << tag, port_mmio + PORT_SCR_ACT);
+			writel_with_flush(1 << tag, port_mmio + PORT_CMD_ISSUE);
+			busy |= 1 << tag;
+
+			buf += now_blocks * ATA_SECT_SIZE;
+			lba += now_blocks;
+			blocks -= now_blocks;
+		}
+
+		/*
+		 * A tag is done once it has left both CI and SActive. Read
+		 * those before the error state, so a tag is never counted
+		 * as done by a batch that failed.
+		 */
+		act = readl(port_mmio + PORT_SCR_ACT) |
+		      readl(port_mmio + PORT_CMD_ISSUE);
+		tf = readl(port_mmio + PORT_TFDATA);
+		if ((readl(port_mmio + PORT_IRQ_STAT) &
+		     (PORT_IRQ_TF_ERR | PORT_IRQ_FATAL)) ||
+		    (tf & (ATA_ERR | ATA_DF))) {
+			printf("scsi_ahci: NCQ error on port %d, tfdata 0x%x, sactive 0x%x\n",
+			       port, tf, act);
+			goto err;
+		}
+
+		done = busy & ~act;
+		if (done) {
+			busy &= ~done;
+			start = get_timer(0);
+		} else if (get_timer(start) > WAIT_MS_DATAIO) {
+			printf("scsi_ahci: NCQ timeout on port %d\n", port);
+			goto err;
+		}
+	}
+
+	ahci_dcache_invalidate_range((unsigned)start_buf, len);
+	return 0;
+
+err:
+	ahci_ncq_recover(port);
+	return -EIO;
+}
+#endif
+
+
 static char *ata_id_strcpy(u16 *target, u16 *src, int len)
 {
 	int i;
@@ -663,6 +850,10 @@ static int ata_scsiop_inquiry(ccb *pccb)
 	memcpy(idbuf, tmpid, ATA_ID_WORDS * 2);
 	ata_swap_buf_le16(idbuf, ATA_ID_WORDS);
 
+#ifdef CONFIG_AHCI_NCQ
+	ahci_ncq_setup(port, idbuf);
+#endif
+
 	memcpy(&pccb->pdata[8], "ATA     ", 8);
 	ata_id_strcpy((u16 *)&pccb->pdata[16], &idbuf[ATA_ID_PROD], 16);
 	ata_id_strcpy((u16 *)&pccb->pdata[32], &idbuf[ATA_ID_FW_REV], 4);
@@ -704,6 +895,24 @@ static int ata_scsiop_read_write(ccb *pccb, u8 is_write)
 	debug("scsi_ahci: %s %d blocks starting from lba 0x%x\n",
 	      is_write ?  "write" : "read", (unsigned)lba, blocks);
 
+#ifdef CONFIG_AHCI_NCQ
+	if (probe_ent->port[pccb->target].ncq_depth) {
+		if (ATA_SECT_SIZE * blocks > user_buffer_size) {
+			printf("scsi_ahci: Error: buffer too small.\n");
+			return -EIO;
+		}
+		if (!ahci_ncq_read_write(pccb->target, lba, blocks,
+					 user_buffer, is_write)) {
+			if (is_write && ata_io_flush(pccb->target) == -EIO)
+				return -EIO;
+			return 0;
+		}
+		/* Fall back to one command at a time from now on */
+		printf("scsi_ahci: disabling NCQ on port %d\n", pccb->target);
+		probe_ent->port[pccb->target].ncq_depth = 0;
+	}
+#endif
+
 	/* Preset the FIS */
 	memset(fis, 0, sizeof(fis));
 	fis[0] = 0x27;		 /* Host to device FIS. */
@@ -739,7 +948,7 @@ static int ata_scsiop_read_write(ccb *pccb, u8 is_write)
 
 		/* Read/Write from ahci */
 		if (ahci_device_data_io(pccb->target, (u8 *) &fis, sizeof(fis),
-					user_buffer, user_buffer_size,
+					user_buffer, transfer_size,
 					is_write)) {
 			debug("scsi_ahci: SCSI %s10 command failure.\n",
 			      is_write ? "WRITE" : "READ");
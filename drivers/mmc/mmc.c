@@ -10,6 +10,7 @@
 #include <config.h>
 #include <common.h>
 #include <command.h>
+#include <initcall.h>
 #include <mmc.h>
 #include <part.h>
 #include <malloc.h>
@@ -170,6 +171,7 @@ struct mmc *find_mmc_device(int dev_num)
 	struct mmc *m;
 	struct list_head *entry;
 
+	initcall_run_deferred("mmc");
 	list_for_each(entry, &mmc_devices) {
 		m = list_entry(entry, struct mmc, link);
 
@@ -1348,6 +1350,7 @@ void print_mmc_devices(char separator)
 	struct mmc *m;
 	struct list_head *entry;
 
+	initcall_run_deferred("mmc");
 	list_for_each(entry, &mmc_devices) {
 		m = list_entry(entry, struct mmc, link);
 
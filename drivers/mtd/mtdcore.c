@@ -211,6 +211,7 @@ int mtd_erase(struct mtd_info *mtd, struct erase_info *instr)
 		mtd_erase_callback(instr);
 		return 0;
 	}
+	mtd->write_gen++;
 	return mtd->_erase(mtd, instr);
 }
 
@@ -246,6 +247,7 @@ int mtd_write(struct mtd_info *mtd, loff_t to, size_t len, size_t *retlen,
 		return -EROFS;
 	if (!len)
 		return 0;
+	mtd->write_gen++;
 	return mtd->_write(mtd, to, len, retlen, buf);
 }
 
@@ -386,5 +388,6 @@ int mtd_block_markbad(struct mtd_info *mtd, loff_t ofs)
 		return -EINVAL;
 	if (!(mtd->flags & MTD_WRITEABLE))
 		return -EROFS;
+	mtd->write_gen++;
 	return mtd->_block_markbad(mtd, ofs);
 }
@@ -913,6 +913,10 @@ static int nand_read_page_swecc(struct mtd_info *mtd, struct nand_chip *chip,
 	for (i = 0; i < chip->ecc.total; i++)
 		ecc_code[i] = chip->oob_poi[eccpos[i]];
 
+	/* Nothing to correct in any step if the whole page's ECC matches */
+	if (!memcmp(ecc_code, ecc_calc, chip->ecc.total))
+		return 0;
+
 	eccsteps = chip->ecc.steps;
 	p = buf;
 
@@ -1239,6 +1243,8 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 
 	uint8_t *bufpoi, *oob, *buf;
 	unsigned int max_bitflips = 0;
+	int pagemask = (1 << (chip->phys_erase_shift - chip->page_shift)) - 1;
+	int cached = 0;
 
 	stats = mtd->ecc_stats;
 
@@ -1264,7 +1270,24 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 		if (realpage != chip->pagebuf || oob) {
 			bufpoi = aligned ? buf : chip->buffers->databuf;
 
-			chip->cmdfunc(mtd, NAND_CMD_READ0, 0x00, page);
+			/*
+			 * With read cache the page has already been loaded
+			 * into the data register by the previous READCACHESEQ.
+			 * Move it to the cache register and, unless this is
+			 * the last page we need from the block, start loading
+			 * the next one while this one is transferred.
+			 */
+			if (!cached)
+				chip->cmdfunc(mtd, NAND_CMD_READ0, 0x00, page);
+			if (NAND_HAS_CACHEREAD(chip) && readlen > bytes &&
+			    ((page + 1) & pagemask) &&
+			    (oob || realpage + 1 != chip->pagebuf)) {
+				chip->cmdfunc(mtd, NAND_CMD_READCACHESEQ, -1, -1);
+				cached = 1;
+			} else if (cached) {
+				chip->cmdfunc(mtd, NAND_CMD_READCACHEEND, -1, -1);
+				cached = 0;
+			}
 
 			/*
 			 * Now read the page into the buffer.  Absent an error,
@@ -1341,6 +1364,10 @@ static int nand_do_read_ops(struct mtd_info *mtd, loff_t from,
 		}
 	}
 
+	/* Stop the array load still running after a failed read */
+	if (cached)
+		chip->cmdfunc(mtd, NAND_CMD_READCACHEEND, -1, -1);
+
 	ops->retlen = ops->len - (size_t) readlen;
 	if (oob)
 		ops->oobretlen = ops->ooblen - oobreadlen;
@@ -3029,6 +3056,16 @@ ident_done:
 	if (mtd->writesize > 512 && chip->cmdfunc == nand_command)
 		chip->cmdfunc = nand_command_lp;
 
+#ifdef CONFIG_SYS_NAND_ONFI_DETECTION
+	/*
+	 * Use the read cache commands if the chip has them. Drivers with
+	 * their own command function have to opt in with NAND_CACHERD.
+	 */
+	if (chip->onfi_version && chip->cmdfunc == nand_command_lp &&
+	    (le16_to_cpu(chip->onfi_params.opt_cmd) & ONFI_OPT_CMD_READ_CACHE))
+		chip->options |= NAND_CACHERD;
+#endif
+
 	name = type->name;
 #ifdef CONFIG_SYS_NAND_ONFI_DETECTION
 	if (chip->onfi_version)
@@ -3355,6 +3392,17 @@ int nand_scan_tail(struct mtd_info *mtd)
 	if ((chip->ecc.mode == NAND_ECC_SOFT) && (chip->page_shift > 9))
 		chip->options |= NAND_SUBPAGE_READ;
 
+	/*
+	 * Read cache needs page readers that take the data from the cache
+	 * register as it is, without sending READ0 themselves.
+	 */
+	if ((chip->ecc.read_page != nand_read_page_swecc &&
+	     chip->ecc.read_page != nand_read_page_hwecc &&
+	     chip->ecc.read_page != nand_read_page_syndrome) ||
+	    (chip->ecc.read_page_raw != nand_read_page_raw &&
+	     chip->ecc.read_page_raw != nand_read_page_raw_syndrome))
+		chip->options &= ~NAND_CACHERD;
+
 	/* Fill in remaining MTD driver data */
 	mtd->type = MTD_NANDFLASH;
 	mtd->flags = (chip->options & NAND_ROM) ? MTD_CAP_ROM :
@@ -0,0 +1,668 @@
+/*
+ * Simulate an ONFI NAND flash on a host file
+ *
+ * The chip is driven through the generic nand_base command function, so
+ * everything the core sends (command, address and data cycles) goes
+ * through the model below and is checked the way a real chip would.
+ *
+ * The image holds each page followed by its OOB area. The geometry, bad
+ * blocks, bit-flip injection and array timings come from the --nand
+ * argument, see README.sandbox.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <nand.h>
+#include <os.h>
+#include <linux/mtd/nand.h>
+
+#include <asm/getopt.h>
+#include <asm/nand.h>
+#include <asm/state.h>
+
+/* Default geometry; the number of blocks comes from the file */
+#define SB_NAND_PAGE_SIZE	2048
+#define SB_NAND_OOB_SIZE	64
+#define SB_NAND_PAGES_PER_BLOCK	64
+
+#define SB_NAND_MAX_BAD		32
+
+#define SB_NAND_MFR_ID		NAND_MFR_MICRON
+#define SB_NAND_DEV_ID		0x38
+
+/* What the data output cycles return */
+enum sb_nand_output {
+	SB_NAND_OUT_NONE,
+	SB_NAND_OUT_ID,
+	SB_NAND_OUT_ONFI_ID,
+	SB_NAND_OUT_PARAM,
+	SB_NAND_OUT_STATUS,
+	SB_NAND_OUT_CACHE,
+};
+
+struct sb_nand {
+	int fd;
+	uint page_size;
+	uint oob_size;
+	uint raw_page;
+	uint pages_per_block;
+	uint blocks;
+	uint row_cycles;
+	/* Factory bad blocks */
+	uint bad[SB_NAND_MAX_BAD];
+	uint nbad;
+	/* Bits flipped in the data area by each array load */
+	uint flips;
+	/* ECC strength for software BCH, 0 for software Hamming */
+	uint bch;
+	/* Array timings in us and when the chip will be ready again */
+	ulong t_r, t_prog, t_bers;
+	ulong busy_until;
+	/* When the page being loaded reaches the data register */
+	ulong array_done;
+	u32 seed;
+	/* Last command latched and the address cycles seen since */
+	uint cmd;
+	uint naddr;
+	u8 addr[5];
+	enum sb_nand_output output;
+	uint pos;
+	/*
+	 * Page held in the data register, -1 if none. READCACHESEQ moves it
+	 * to the cache register and starts loading the next one.
+	 */
+	int data_page;
+	/* Page last loaded into the cache register, -1 if none */
+	int cache_page;
+	/* Page being programmed, -1 if none */
+	int prog_page;
+	u8 *cache;
+	u8 *prog;
+	u8 *tmp;
+	struct nand_onfi_params param;
+	u8 status;
+	struct sandbox_nand_stats stats;
+};
+
+static struct sb_nand sb_nand = { .fd = -1 };
+
+static u16 sb_nand_onfi_crc16(u16 crc, u8 const *p, size_t len)
+{
+	int i;
+
+	while (len--) {
+		crc ^= *p++ << 8;
+		for (i = 0; i < 8; i++)
+			crc = (crc << 1) ^ ((crc & 0x8000) ? 0x8005 : 0);
+	}
+
+	return crc;
+}
+
+static void sb_nand_init_param(struct sb_nand *sn)
+{
+	struct nand_onfi_params *p = &sn->param;
+
+	memset(p, '\0', sizeof(*p));
+	memcpy(p->sig, "ONFI", 4);
+	p->revision = cpu_to_le16(1 << 2 | 1 << 1);
+	p->opt_cmd = cpu_to_le16(ONFI_OPT_CMD_READ_CACHE);
+	memcpy(p->manufacturer, "SANDBOX     ", sizeof(p->manufacturer));
+	memcpy(p->model, "SANDBOX NAND        ", sizeof(p->model));
+	p->jedec_id = SB_NAND_MFR_ID;
+	p->byte_per_page = cpu_to_le32(sn->page_size);
+	p->spare_bytes_per_page = cpu_to_le16(sn->oob_size);
+	p->pages_per_block = cpu_to_le32(sn->pages_per_block);
+	p->blocks_per_lun = cpu_to_le32(sn->blocks);
+	p->lun_count = 1;
+	p->addr_cycles = (2 << 4) | sn->row_cycles;
+	p->bits_per_cell = 1;
+	p->programs_per_page = 4;
+	p->ecc_bits = sn->bch ? sn->bch : 1;
+	p->crc = cpu_to_le16(sb_nand_onfi_crc16(ONFI_CRC_BASE, (u8 *)p, 254));
+}
+
+static int sb_nand_seek(struct sb_nand *sn, int page)
+{
+	if (page < 0 || page >= sn->blocks * sn->pages_per_block) {
+		printf("sandbox_nand: page %#x out of range\n", page);
+		return -1;
+	}
+	if (os_lseek(sn->fd, (off_t)page * sn->raw_page, OS_SEEK_SET) < 0) {
+		puts("sandbox_nand: os_lseek() failed\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int sb_nand_is_bad(struct sb_nand *sn, int page)
+{
+	uint block = page / sn->pages_per_block;
+	uint i;
+
+	for (i = 0; i < sn->nbad; i++) {
+		if (sn->bad[i] == block)
+			return 1;
+	}
+
+	return 0;
+}
+
+/* xorshift32, so that a run can be repeated */
+static u32 sb_nand_rand(struct sb_nand *sn)
+{
+	sn->seed ^= sn->seed << 13;
+	sn->seed ^= sn->seed >> 17;
+	sn->seed ^= sn->seed << 5;
+
+	return sn->seed;
+}
+
+/*
+ * Flip one bit in each of sn->flips equal slices of the data area. When
+ * the number of flips divides the number of ECC steps, no step sees more
+ * than one of them.
+ */
+static void sb_nand_flip(struct sb_nand *sn)
+{
+	uint slice = sn->page_size * 8 / sn->flips;
+	uint i, bit;
+
+	for (i = 0; i < sn->flips; i++) {
+		bit = i * slice + sb_nand_rand(sn) % slice;
+		sn->cache[bit / 8] ^= 1 << (bit % 8);
+	}
+	sn->stats.flips += sn->flips;
+}
+
+/* Keep the chip busy for @us from @start, the time it was started */
+static void sb_nand_busy(struct sb_nand *sn, ulong start, ulong us)
+{
+	ulong now = timer_get_us();
+
+	if ((long)(start - now) < 0)
+		start = now;
+	sn->busy_until = start + us;
+	sn->stats.busy_us += sn->busy_until - now;
+}
+
+static int sb_nand_is_busy(struct sb_nand *sn)
+{
+	return (long)(timer_get_us() - sn->busy_until) < 0;
+}
+
+/* Load a page from the array into the cache register */
+static void sb_nand_load(struct sb_nand *sn, int page)
+{
+	sn->stats.loads++;
+	sn->cache_page = page;
+	if (sb_nand_seek(sn, page) ||
+	    os_read(sn->fd, sn->cache, sn->raw_page) != sn->raw_page) {
+		memset(sn->cache, 0xff, sn->raw_page);
+		sn->status |= NAND_STATUS_FAIL;
+		return;
+	}
+	/* Factory bad block marker in the first two OOB bytes */
+	if (sb_nand_is_bad(sn, page))
+		memset(sn->cache + sn->page_size, '\0', 2);
+	if (sn->flips)
+		sb_nand_flip(sn);
+}
+
+static void sb_nand_program(struct sb_nand *sn)
+{
+	int i;
+
+	sn->stats.programs++;
+	if (sb_nand_is_bad(sn, sn->prog_page))
+		goto err;
+	/* Programming can only clear bits */
+	if (sb_nand_seek(sn, sn->prog_page) ||
+	    os_read(sn->fd, sn->tmp, sn->raw_page) != sn->raw_page)
+		goto err;
+	for (i = 0; i < sn->raw_page; i++)
+		sn->tmp[i] &= sn->prog[i];
+	if (sb_nand_seek(sn, sn->prog_page) ||
+	    os_write(sn->fd, sn->tmp, sn->raw_page) != sn->raw_page)
+		goto err;
+	return;
+ err:
+	sn->status |= NAND_STATUS_FAIL;
+}
+
+static void sb_nand_erase(struct sb_nand *sn, int page)
+{
+	int i;
+
+	sn->stats.erases++;
+	if (sb_nand_is_bad(sn, page))
+		goto err;
+	memset(sn->tmp, 0xff, sn->raw_page);
+	page -= page % sn->pages_per_block;
+	if (sb_nand_seek(sn, page))
+		goto err;
+	for (i = 0; i < sn->pages_per_block; i++) {
+		if (os_write(sn->fd, sn->tmp, sn->raw_page) != sn->raw_page)
+			goto err;
+	}
+	return;
+ err:
+	sn->status |= NAND_STATUS_FAIL;
+}
+
+static uint sb_nand_column(struct sb_nand *sn)
+{
+	return sn->addr[0] | sn->addr[1] << 8;
+}
+
+static int sb_nand_row(struct sb_nand *sn, uint first)
+{
+	int row = 0;
+	uint i;
+
+	for (i = 0; i < sn->row_cycles; i++)
+		row |= sn->addr[first + i] << (8 * i);
+
+	return row;
+}
+
+static void sb_nand_command(struct sb_nand *sn, uint cmd)
+{
+	int page;
+
+	switch (cmd) {
+	case NAND_CMD_READSTART:
+		if (sn->cmd != NAND_CMD_READ0 ||
+		    sn->naddr != 2 + sn->row_cycles)
+			goto bad_seq;
+		page = sb_nand_row(sn, 2);
+		sb_nand_load(sn, page);
+		sn->data_page = page;
+		sb_nand_busy(sn, 0, sn->t_r);
+		sn->array_done = sn->busy_until;
+		sn->output = SB_NAND_OUT_CACHE;
+		sn->pos = sb_nand_column(sn);
+		break;
+	case NAND_CMD_READCACHESEQ:
+	case NAND_CMD_READCACHEEND:
+		if (sn->data_page < 0)
+			goto bad_seq;
+		/* Right after READSTART the page is in the cache already */
+		if (sn->data_page != sn->cache_page)
+			sb_nand_load(sn, sn->data_page);
+		/*
+		 * The page in the data register moves to the cache register
+		 * once its load is done; the next load then runs while the
+		 * host reads the cache.
+		 */
+		sb_nand_busy(sn, sn->array_done, 0);
+		if (cmd == NAND_CMD_READCACHEEND) {
+			sn->data_page = -1;
+			debug("sandbox_nand: %lu array loads, %lu overlapped\n",
+			      sn->stats.loads, sn->stats.cache_loads);
+		} else {
+			sn->stats.cache_loads++;
+			sn->array_done = sn->busy_until + sn->t_r;
+			sn->data_page++;
+			if (!(sn->data_page % sn->pages_per_block)) {
+				printf("sandbox_nand: read cache crossed into block %d\n",
+				       sn->data_page / sn->pages_per_block);
+				sn->data_page = -1;
+			}
+		}
+		sn->output = SB_NAND_OUT_CACHE;
+		sn->pos = 0;
+		break;
+	case NAND_CMD_RNDOUTSTART:
+		if (sn->cmd != NAND_CMD_RNDOUT || sn->naddr != 2)
+			goto bad_seq;
+		sn->output = SB_NAND_OUT_CACHE;
+		sn->pos = sb_nand_column(sn);
+		break;
+	case NAND_CMD_STATUS:
+		sn->output = SB_NAND_OUT_STATUS;
+		break;
+	case NAND_CMD_SEQIN:
+		memset(sn->prog, 0xff, sn->raw_page);
+		sn->prog_page = -1;
+		sn->output = SB_NAND_OUT_NONE;
+		break;
+	case NAND_CMD_PAGEPROG:
+		if (sn->prog_page < 0)
+			goto bad_seq;
+		sb_nand_program(sn);
+		sn->prog_page = -1;
+		sb_nand_busy(sn, 0, sn->t_prog);
+		break;
+	case NAND_CMD_ERASE2:
+		if (sn->cmd != NAND_CMD_ERASE1 || sn->naddr != sn->row_cycles)
+			goto bad_seq;
+		sb_nand_erase(sn, sb_nand_row(sn, 0));
+		sb_nand_busy(sn, 0, sn->t_bers);
+		break;
+	case NAND_CMD_RESET:
+		sn->data_page = -1;
+		sn->prog_page = -1;
+		sn->status = NAND_STATUS_READY | NAND_STATUS_WP;
+		sn->output = SB_NAND_OUT_NONE;
+		sn->busy_until = timer_get_us();
+		break;
+	case NAND_CMD_READ0:
+	case NAND_CMD_RNDOUT:
+	case NAND_CMD_RNDIN:
+	case NAND_CMD_ERASE1:
+	case NAND_CMD_READID:
+	case NAND_CMD_PARAM:
+		break;
+	default:
+		printf("sandbox_nand: unknown command %#x\n", cmd);
+		return;
+	}
+
+	/* Only the read path commands keep a cache read going */
+	if (cmd != NAND_CMD_STATUS && cmd != NAND_CMD_READCACHESEQ &&
+	    cmd != NAND_CMD_READCACHEEND && cmd != NAND_CMD_RNDOUT &&
+	    cmd != NAND_CMD_RNDOUTSTART && cmd != NAND_CMD_READSTART)
+		sn->data_page = -1;
+
+	/* Starting a new operation clears the failed bit */
+	if (cmd == NAND_CMD_READ0 || cmd == NAND_CMD_SEQIN ||
+	    cmd == NAND_CMD_ERASE1)
+		sn->status &= ~NAND_STATUS_FAIL;
+
+	if (cmd != NAND_CMD_STATUS) {
+		sn->cmd = cmd;
+		sn->naddr = 0;
+	}
+	return;
+
+ bad_seq:
+	printf("sandbox_nand: command %#x after %#x with %u address cycles\n",
+	       cmd, sn->cmd, sn->naddr);
+}
+
+static void sb_nand_address(struct sb_nand *sn, u8 addr)
+{
+	if (sn->naddr < ARRAY_SIZE(sn->addr))
+		sn->addr[sn->naddr] = addr;
+	sn->naddr++;
+
+	switch (sn->cmd) {
+	case NAND_CMD_READID:
+		sn->output = addr == 0x20 ? SB_NAND_OUT_ONFI_ID : SB_NAND_OUT_ID;
+		sn->pos = 0;
+		break;
+	case NAND_CMD_PARAM:
+		sn->output = SB_NAND_OUT_PARAM;
+		sn->pos = 0;
+		break;
+	case NAND_CMD_SEQIN:
+		if (sn->naddr == 2 + sn->row_cycles) {
+			sn->prog_page = sb_nand_row(sn, 2);
+			sn->pos = sb_nand_column(sn);
+		}
+		break;
+	case NAND_CMD_RNDIN:
+		if (sn->naddr == 2)
+			sn->pos = sb_nand_column(sn);
+		break;
+	}
+}
+
+static void sb_nand_cmd_ctrl(struct mtd_info *mtd, int dat, unsigned int ctrl)
+{
+	struct sb_nand *sn = ((struct nand_chip *)mtd->priv)->priv;
+
+	if (dat == NAND_CMD_NONE)
+		return;
+
+	if (ctrl & NAND_CLE)
+		sb_nand_command(sn, dat);
+	else if (ctrl & NAND_ALE)
+		sb_nand_address(sn, dat);
+}
+
+static uint8_t sb_nand_read_byte(struct mtd_info *mtd)
+{
+	struct sb_nand *sn = ((struct nand_chip *)mtd->priv)->priv;
+	static const u8 id[] = { SB_NAND_MFR_ID, SB_NAND_DEV_ID, 0, 0, 0 };
+	uint pos = sn->pos++;
+
+	switch (sn->output) {
+	case SB_NAND_OUT_ID:
+		return pos < sizeof(id) ? id[pos] : 0;
+	case SB_NAND_OUT_ONFI_ID:
+		return pos < 4 ? "ONFI"[pos] : 0;
+	case SB_NAND_OUT_PARAM:
+		/* The core reads up to three copies of the parameter page */
+		return ((u8 *)&sn->param)[pos % sizeof(sn->param)];
+	case SB_NAND_OUT_STATUS:
+		if (sb_nand_is_busy(sn))
+			return sn->status & ~NAND_STATUS_READY;
+		return sn->status;
+	case SB_NAND_OUT_CACHE:
+		return pos < sn->raw_page ? sn->cache[pos] : 0xff;
+	default:
+		printf("sandbox_nand: data read after command %#x\n", sn->cmd);
+		return 0xff;
+	}
+}
+
+/* The bus is 8 bits wide, so a word is two byte cycles */
+static u16 sb_nand_read_word(struct mtd_info *mtd)
+{
+	u16 lo = sb_nand_read_byte(mtd);
+
+	return lo | sb_nand_read_byte(mtd) << 8;
+}
+
+static void sb_nand_read_buf(struct mtd_info *mtd, uint8_t *buf, int len)
+{
+	struct sb_nand *sn = ((struct nand_chip *)mtd->priv)->priv;
+
+	if (sn->output == SB_NAND_OUT_CACHE &&
+	    sn->pos + len <= sn->raw_page) {
+		memcpy(buf, sn->cache + sn->pos, len);
+		sn->pos += len;
+		return;
+	}
+	while (len--)
+		*buf++ = sb_nand_read_byte(mtd);
+}
+
+static void sb_nand_write_buf(struct mtd_info *mtd, const uint8_t *buf,
+			      int len)
+{
+	struct sb_nand *sn = ((struct nand_chip *)mtd->priv)->priv;
+
+	if (sn->prog_page < 0 || sn->pos + len > sn->raw_page) {
+		printf("sandbox_nand: bad data input after command %#x\n",
+		       sn->cmd);
+		return;
+	}
+	memcpy(sn->prog + sn->pos, buf, len);
+	sn->pos += len;
+}
+
+static int sb_nand_verify_buf(struct mtd_info *mtd, const uint8_t *buf,
+			      int len)
+{
+	while (len--)
+		if (*buf++ != sb_nand_read_byte(mtd))
+			return -EFAULT;
+
+	return 0;
+}
+
+static int sb_nand_dev_ready(struct mtd_info *mtd)
+{
+	struct sb_nand *sn = ((struct nand_chip *)mtd->priv)->priv;
+
+	return !sb_nand_is_busy(sn);
+}
+
+void sandbox_nand_get_stats(struct sandbox_nand_stats *stats, int reset)
+{
+	*stats = sb_nand.stats;
+	if (reset)
+		memset(&sb_nand.stats, '\0', sizeof(sb_nand.stats));
+}
+
+/*
+ * Parse the options in front of the file name, e.g.
+ * "page=4096,oob=128,bad=3,flips=1,tr=25:nand.bin", and return the name
+ */
+static const char *sb_nand_parse(struct sb_nand *sn, const char *arg)
+{
+	const char *name = strchr(arg, ':');
+	const char *opt, *val;
+	ulong num;
+	char *end;
+
+	sn->page_size = SB_NAND_PAGE_SIZE;
+	sn->oob_size = SB_NAND_OOB_SIZE;
+	sn->pages_per_block = SB_NAND_PAGES_PER_BLOCK;
+
+	/* A colon without options in front is part of the file name */
+	val = strchr(arg, '=');
+	if (!name || !val || val > name)
+		return arg;
+
+	for (opt = arg; opt < name; opt = end + 1) {
+		val = strchr(opt, '=');
+		if (!val || val > name)
+			goto err;
+		num = simple_strtoul(val + 1, &end, 0);
+		if (end == val + 1 || (*end != ',' && *end != ':'))
+			goto err;
+
+		if (!strncmp(opt, "page=", 5)) {
+			sn->page_size = num;
+		} else if (!strncmp(opt, "oob=", 4)) {
+			sn->oob_size = num;
+		} else if (!strncmp(opt, "ppb=", 4)) {
+			sn->pages_per_block = num;
+		} else if (!strncmp(opt, "bad=", 4)) {
+			if (sn->nbad == SB_NAND_MAX_BAD) {
+				printf("sandbox_nand: more than %d bad blocks\n",
+				       SB_NAND_MAX_BAD);
+				return NULL;
+			}
+			sn->bad[sn->nbad++] = num;
+		} else if (!strncmp(opt, "flips=", 6)) {
+			sn->flips = num;
+		} else if (!strncmp(opt, "bch=", 4)) {
+			sn->bch = num;
+		} else if (!strncmp(opt, "seed=", 5)) {
+			sn->seed = num;
+		} else if (!strncmp(opt, "tr=", 3)) {
+			sn->t_r = num;
+		} else if (!strncmp(opt, "tprog=", 6)) {
+			sn->t_prog = num;
+		} else if (!strncmp(opt, "tbers=", 6)) {
+			sn->t_bers = num;
+		} else {
+			goto err;
+		}
+	}
+
+	/* Only large page chips, which nand_command_lp() drives */
+	if (sn->page_size < 2048 || (sn->page_size & (sn->page_size - 1)) ||
+	    !sn->pages_per_block ||
+	    (sn->pages_per_block & (sn->pages_per_block - 1)) ||
+	    sn->oob_size < 2 || sn->flips > sn->page_size * 8) {
+		puts("sandbox_nand: unsupported geometry\n");
+		return NULL;
+	}
+
+	return name + 1;
+
+ err:
+	printf("sandbox_nand: bad option '%.*s'\n", (int)(name - opt), opt);
+	return NULL;
+}
+
+int board_nand_init(struct nand_chip *nand)
+{
+	struct sandbox_state *state = state_get_current();
+	struct sb_nand *sn = &sb_nand;
+	const char *fname;
+	off_t size;
+
+	if (!state->nand_fname)
+		return -ENODEV;
+
+	sn->seed = 1;
+	fname = sb_nand_parse(sn, state->nand_fname);
+	if (!fname)
+		return -EINVAL;
+	sn->raw_page = sn->page_size + sn->oob_size;
+
+	sn->fd = os_open(fname, OS_O_RDWR);
+	if (sn->fd < 0) {
+		printf("sandbox_nand: unable to open '%s'\n", fname);
+		return -ENODEV;
+	}
+	size = os_lseek(sn->fd, 0, OS_SEEK_END);
+	sn->blocks = size / (sn->pages_per_block * sn->raw_page);
+	if (!sn->blocks) {
+		printf("sandbox_nand: '%s' is smaller than a block\n", fname);
+		goto err;
+	}
+	sn->cache = malloc(sn->raw_page);
+	sn->prog = malloc(sn->raw_page);
+	sn->tmp = malloc(sn->raw_page);
+	if (!sn->cache || !sn->prog || !sn->tmp) {
+		puts("sandbox_nand: out of memory\n");
+		goto err;
+	}
+	/* Same rule as nand_command_lp() */
+	sn->row_cycles = (u64)sn->blocks * sn->pages_per_block *
+			 sn->page_size > (128 << 20) ? 3 : 2;
+	sn->data_page = -1;
+	sn->cache_page = -1;
+	sn->prog_page = -1;
+	sn->status = NAND_STATUS_READY | NAND_STATUS_WP;
+	sb_nand_init_param(sn);
+
+	nand->priv = sn;
+	if (sn->bch) {
+		/* 13-bit symbols cover a 512-byte step */
+		nand->ecc.mode = NAND_ECC_SOFT_BCH;
+		nand->ecc.size = 512;
+		nand->ecc.bytes = DIV_ROUND_UP(13 * sn->bch, 8);
+	} else {
+		nand->ecc.mode = NAND_ECC_SOFT;
+	}
+	nand->cmd_ctrl = sb_nand_cmd_ctrl;
+	nand->dev_ready = sb_nand_dev_ready;
+	/* Replace every default accessor, they would do MMIO */
+	nand->read_byte = sb_nand_read_byte;
+	nand->read_word = sb_nand_read_word;
+	nand->read_buf = sb_nand_read_buf;
+	nand->write_buf = sb_nand_write_buf;
+	nand->verify_buf = sb_nand_verify_buf;
+	nand->chip_delay = 0;
+
+	return 0;
+
+ err:
+	free(sn->tmp);
+	free(sn->prog);
+	free(sn->cache);
+	os_close(sn->fd);
+	sn->fd = -1;
+	return -ENODEV;
+}
+
+static int sandbox_cmdline_cb_nand(struct sandbox_state *state,
+				   const char *arg)
+{
+	state->nand_fname = arg;
+	return 0;
+}
+SANDBOX_CMDLINE_OPT(nand, 1,
+		    "Connect a NAND flash backed by a file: [opt=val,...:]file");
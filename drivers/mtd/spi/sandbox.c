@@ -34,12 +34,14 @@ enum sandbox_sf_state {
 	SF_ERASE, /* erase the flash */
 	SF_READ_STATUS, /* read the flash's status register */
 	SF_READ_STATUS1, /* read the flash's status register upper 8 bits*/
+	SF_WRITE_STATUS, /* write the flash's status register */
 };
 
 static const char *sandbox_sf_state_name(enum sandbox_sf_state state)
 {
 	static const char * const states[] = {
 		"CMD", "ID", "ADDR", "READ", "WRITE", "ERASE", "READ_STATUS",
+		"READ_STATUS1", "WRITE_STATUS",
 	};
 	return states[state];
 }
@@ -47,6 +49,7 @@ static const char *sandbox_sf_state_name(enum sandbox_sf_state state)
 /* Bits for the status register */
 #define STAT_WIP	(1 << 0)
 #define STAT_WEL	(1 << 1)
+#define STAT_QE		(STATUS_QEB_WINSPAN << 8)
 
 /* Assume all SPI flashes have 3 byte addresses since they do atm */
 #define SF_ADDR_LEN	3
@@ -116,6 +119,10 @@ struct sandbox_spi_flash {
 	uint addr_bytes, pad_addr_bytes;
 	/* The current flash status (see STAT_XXX defines above) */
 	u16 status;
+	/* How many status bytes we've consumed */
+	uint status_bytes;
+	/* Data lines used by the current xfer and by each command phase */
+	uint lines, addr_lines, data_lines;
 	/* Data describing the flash we're emulating */
 	const struct sandbox_spi_flash_data *data;
 	/* The file on disk to serv up data from */
@@ -195,10 +202,33 @@ static void sandbox_sf_cs_activate(void *priv)
 	sbsf->off = 0;
 	sbsf->addr_bytes = 0;
 	sbsf->pad_addr_bytes = 0;
+	sbsf->status_bytes = 0;
+	sbsf->addr_lines = 1;
+	sbsf->data_lines = 1;
 	sbsf->state = SF_CMD;
 	sbsf->cmd = SF_CMD;
 }
 
+static void sandbox_sf_set_lines(void *priv, uint lines)
+{
+	struct sandbox_spi_flash *sbsf = priv;
+
+	sbsf->lines = lines;
+}
+
+/* The data lines each state expects the bus to use */
+static uint sandbox_sf_state_lines(struct sandbox_spi_flash *sbsf)
+{
+	switch (sbsf->state) {
+	case SF_ADDR:
+		return sbsf->addr_lines;
+	case SF_READ:
+		return sbsf->data_lines;
+	default:
+		return 1;
+	}
+}
+
 static void sandbox_sf_cs_deactivate(void *priv)
 {
 	debug("sandbox_sf: CS deactivated; cmd done processing!\n");
@@ -219,6 +249,24 @@ static int sandbox_sf_process_cmd(struct sandbox_spi_flash *sbsf, const u8 *rx,
 		sbsf->state = SF_ID;
 		sbsf->cmd = SF_ID;
 		break;
+	case CMD_READ_QUAD_IO_FAST:
+		sbsf->pad_addr_bytes = 2;
+		sbsf->addr_lines = 4;
+		sbsf->data_lines = 4;
+		goto state_quad;
+	case CMD_READ_QUAD_OUTPUT_FAST:
+		sbsf->pad_addr_bytes = 1;
+		sbsf->data_lines = 4;
+ state_quad:
+		if (!(sbsf->status & STAT_QE)) {
+			puts("sandbox_sf: quad enable not set before quad read\n");
+			return 1;
+		}
+		goto state_addr;
+	case CMD_READ_DUAL_IO_FAST:
+		sbsf->addr_lines = 2;
+	case CMD_READ_DUAL_OUTPUT_FAST:
+		sbsf->data_lines = 2;
 	case CMD_READ_ARRAY_FAST:
 		sbsf->pad_addr_bytes = 1;
 	case CMD_READ_ARRAY_SLOW:
@@ -236,6 +284,9 @@ static int sandbox_sf_process_cmd(struct sandbox_spi_flash *sbsf, const u8 *rx,
 	case CMD_READ_STATUS1:
 		sbsf->state = SF_READ_STATUS1;
 		break;
+	case CMD_WRITE_STATUS:
+		sbsf->state = SF_WRITE_STATUS;
+		break;
 	case CMD_WRITE_ENABLE:
 		debug(" write enabled\n");
 		sbsf->status |= STAT_WEL;
@@ -296,6 +347,10 @@ static int sandbox_sf_xfer(void *priv, const u8 *rx, u8 *tx,
 	      sandbox_sf_state_name(sbsf->state), bytes);
 
 	if (sbsf->state == SF_CMD) {
+		if (sbsf->lines != 1) {
+			printf("sandbox_sf: cmd sent on %u lines\n", sbsf->lines);
+			return 1;
+		}
 		/* Figure out the initial state */
 		if (sandbox_sf_process_cmd(sbsf, rx, tx))
 			return 1;
@@ -304,6 +359,13 @@ static int sandbox_sf_xfer(void *priv, const u8 *rx, u8 *tx,
 
 	/* Process the remaining data */
 	while (pos < bytes) {
+		if (sbsf->lines != sandbox_sf_state_lines(sbsf)) {
+			printf("sandbox_sf: %s phase of cmd %#x sent on %u lines, expected %u\n",
+			       sandbox_sf_state_name(sbsf->state), sbsf->cmd,
+			       sbsf->lines, sandbox_sf_state_lines(sbsf));
+			return 1;
+		}
+
 		switch (sbsf->state) {
 		case SF_ID: {
 			u8 id;
@@ -341,6 +403,10 @@ static int sandbox_sf_xfer(void *priv, const u8 *rx, u8 *tx,
 			switch (sbsf->cmd) {
 			case CMD_READ_ARRAY_FAST:
 			case CMD_READ_ARRAY_SLOW:
+			case CMD_READ_DUAL_OUTPUT_FAST:
+			case CMD_READ_DUAL_IO_FAST:
+			case CMD_READ_QUAD_OUTPUT_FAST:
+			case CMD_READ_QUAD_IO_FAST:
 				sbsf->state = SF_READ;
 				break;
 			case CMD_PAGE_PROGRAM:
@@ -381,6 +447,25 @@ static int sandbox_sf_xfer(void *priv, const u8 *rx, u8 *tx,
 			memset(tx + pos, sbsf->status >> 8, cnt);
 			pos += cnt;
 			break;
+		case SF_WRITE_STATUS:
+			if (!(sbsf->status & STAT_WEL)) {
+				puts("sandbox_sf: write enable not set before write status\n");
+				goto done;
+			}
+
+			/* First byte is the low status byte, second the upper */
+			debug(" write status: byte:%u rx:%02x\n",
+			      sbsf->status_bytes, rx[pos]);
+			if (sbsf->status_bytes++ == 0)
+				sbsf->status = (sbsf->status & ~0xfc) |
+					       (rx[pos] & 0xfc);
+			else
+				sbsf->status = (sbsf->status & 0xff) |
+					       (rx[pos] << 8);
+			sandbox_spi_tristate(&tx[pos++], 1);
+			if (pos == bytes)
+				sbsf->status &= ~STAT_WEL;
+			break;
 		case SF_WRITE:
 			/*
 			 * XXX: need to handle exotic behavior:
@@ -457,6 +542,7 @@ static const struct sandbox_spi_emu_ops sandbox_sf_ops = {
 	.cs_activate   = sandbox_sf_cs_activate,
 	.cs_deactivate = sandbox_sf_cs_deactivate,
 	.xfer          = sandbox_sf_xfer,
+	.set_lines     = sandbox_sf_set_lines,
 };
 
 static int sandbox_cmdline_cb_spi_sf(struct sandbox_state *state,
@@ -359,6 +359,64 @@ int spi_flash_read_common(struct spi_flash *flash, const u8 *cmd,
 	return ret;
 }
 
+/*
+ * Dual and quad reads send the opcode on one line. The output modes keep
+ * the address and dummy bytes on one line too and only read the data on
+ * 2 or 4 lines, the I/O modes use all lines for everything after the
+ * opcode. Other reads go through spi_flash_read_common().
+ */
+static int spi_flash_read_multi(struct spi_flash *flash, const u8 *cmd,
+		size_t cmd_len, void *data, size_t data_len)
+{
+	struct spi_slave *spi = flash->spi;
+	unsigned long flags = SPI_XFER_BEGIN;
+	unsigned long addr_flags = 0, data_flags;
+	int ret;
+
+	switch (flash->read_cmd) {
+	case CMD_READ_DUAL_IO_FAST:
+		addr_flags = SPI_XFER_DUAL;
+	case CMD_READ_DUAL_OUTPUT_FAST:
+		data_flags = SPI_XFER_DUAL;
+		break;
+	case CMD_READ_QUAD_IO_FAST:
+		addr_flags = SPI_XFER_QUAD;
+	case CMD_READ_QUAD_OUTPUT_FAST:
+		data_flags = SPI_XFER_QUAD;
+		break;
+	default:
+		return spi_flash_read_common(flash, cmd, cmd_len, data,
+					     data_len);
+	}
+
+#ifdef CONFIG_SF_DUAL_FLASH
+	if (spi->flags & SPI_XFER_U_PAGE)
+		flags |= SPI_XFER_U_PAGE;
+#endif
+
+	ret = spi_claim_bus(spi);
+	if (ret) {
+		debug("SF: unable to claim SPI bus\n");
+		return ret;
+	}
+
+	ret = spi_xfer(spi, 8, cmd, NULL, flags);
+	if (!ret)
+		ret = spi_xfer(spi, (cmd_len - 1) * 8, cmd + 1, NULL,
+			       addr_flags);
+	if (!ret)
+		ret = spi_xfer(spi, data_len * 8, NULL, data,
+			       data_flags | SPI_XFER_END);
+	if (ret) {
+		debug("SF: read cmd %#x failed: %d\n", cmd[0], ret);
+		spi_xfer(spi, 0, NULL, NULL, SPI_XFER_END);
+	}
+
+	spi_release_bus(spi);
+
+	return ret;
+}
+
 int spi_flash_cmd_read_ops(struct spi_flash *flash, u32 offset,
 		size_t len, void *data)
 {
@@ -410,7 +468,7 @@ int spi_flash_cmd_read_ops(struct spi_flash *flash, u32 offset,
 
 		spi_flash_addr(read_addr, cmd);
 
-		ret = spi_flash_read_common(flash, cmd, cmdsz, data, read_len);
+		ret = spi_flash_read_multi(flash, cmd, cmdsz, data, read_len);
 		if (ret < 0) {
 			debug("SF: read failed\n");
 			break;
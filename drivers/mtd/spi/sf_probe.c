@@ -197,6 +197,13 @@ static struct spi_flash *spi_flash_validate_params(struct spi_slave *spi,
 		/* Go for default supported write cmd */
 		flash->write_cmd = CMD_PAGE_PROGRAM;
 
+	/* Poll cmd selection - needed by the quad enable write below */
+	flash->poll_cmd = CMD_READ_STATUS;
+#ifdef CONFIG_SPI_FLASH_STMICRO
+	if (params->flags & E_FSR)
+		flash->poll_cmd = CMD_FLAG_STATUS;
+#endif
+
 	/* Set the quad enable bit - only for quad commands */
 	if ((flash->read_cmd == CMD_READ_QUAD_OUTPUT_FAST) ||
 	    (flash->read_cmd == CMD_READ_QUAD_IO_FAST) ||
@@ -226,13 +233,6 @@ static struct spi_flash *spi_flash_validate_params(struct spi_slave *spi,
 		flash->dummy_byte = 1;
 	}
 
-	/* Poll cmd selection */
-	flash->poll_cmd = CMD_READ_STATUS;
-#ifdef CONFIG_SPI_FLASH_STMICRO
-	if (params->flags & E_FSR)
-		flash->poll_cmd = CMD_FLAG_STATUS;
-#endif
-
 	/* Configure the BAR - discover bank cmds and read current bank */
 #ifdef CONFIG_SPI_FLASH_BAR
 	u8 curr_bank = 0;
@@ -312,6 +312,12 @@ static struct spi_flash *spi_flash_probe_slave(struct spi_slave *spi)
 
 	/* Read the ID codes */
 	ret = spi_flash_cmd(spi, CMD_READ_ID, idcode, sizeof(idcode));
+
+	/*
+	 * Release spi bus - the quad enable and bank address setup below
+	 * go through spi_flash_read/write_common(), which claim it again
+	 */
+	spi_release_bus(spi);
 	if (ret) {
 		printf("SF: Failed to get idcodes\n");
 		goto err_read_id;
@@ -352,13 +358,9 @@ static struct spi_flash *spi_flash_probe_slave(struct spi_slave *spi)
 	}
 #endif
 
-	/* Release spi bus */
-	spi_release_bus(spi);
-
 	return flash;
 
 err_read_id:
-	spi_release_bus(spi);
 err_claim_bus:
 	spi_free_slave(spi);
 	return NULL;
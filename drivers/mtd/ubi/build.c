@@ -441,17 +441,22 @@ static void uif_close(struct ubi_device *ubi)
  * This function returns zero in case of success and a negative error code in
  * case of failure.
  *
- * Note, currently this is the only method to attach UBI devices. Hopefully in
- * the future we'll have more scalable attaching methods and avoid full media
- * scanning. But even in this case scanning will be needed as a fall-back
- * attaching method if there are some on-flash table corruptions.
+ * With %CONFIG_MTD_UBI_FASTMAP the scanning information is taken from the
+ * fastmap if there is a valid one, and full media scanning is the fall-back
+ * attaching method.
  */
 static int attach_by_scanning(struct ubi_device *ubi)
 {
 	int err;
-	struct ubi_scan_info *si;
+	struct ubi_scan_info *si = NULL;
 
-	si = ubi_scan(ubi);
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	si = ubi_scan_fastmap(ubi);
+	if (IS_ERR(si))
+		return PTR_ERR(si);
+#endif
+	if (!si)
+		si = ubi_scan(ubi);
 	if (IS_ERR(si))
 		return PTR_ERR(si);
 
@@ -764,6 +769,9 @@ int ubi_attach_mtd_dev(struct mtd_info *mtd, int ubi_num, int vid_hdr_offset)
 	ubi->ubi_num = ubi_num;
 	ubi->vid_hdr_offset = vid_hdr_offset;
 	ubi->autoresize_vol_id = -1;
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	ubi->fm_anchor = -1;
+#endif
 
 	mutex_init(&ubi->buf_mutex);
 	mutex_init(&ubi->ckvol_mutex);
@@ -0,0 +1,751 @@
+/*
+ * Copyright (c) 2012 Linutronix GmbH
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * Based on the Linux UBI fastmap code by Richard Weinberger.
+ */
+
+/*
+ * UBI fastmap attach.
+ *
+ * A fastmap is a checkpoint of the UBI state (erase counters, volumes and
+ * their EBA tables) which Linux writes to a few PEBs. Its super block lives
+ * in an "anchor" PEB among the first %UBI_FM_MAX_START PEBs. Everything
+ * written after the checkpoint went to PEBs taken from the fastmap pools, so
+ * attaching needs to read the anchor, the fastmap data and the pool PEBs
+ * only, instead of the headers of every PEB on the device.
+ *
+ * This unit builds the same &struct ubi_scan_info the scanning unit would,
+ * so the rest of the attach process does not care how the device was
+ * attached. If there is no fastmap, or anything about it does not add up,
+ * %NULL is returned and the caller falls back to full scanning.
+ *
+ * Fastmaps are not written here. To keep the on-flash fastmap consistent
+ * with what UBI does in U-Boot, PEBs the fastmap still owns (its own blocks
+ * and PEBs pending erasure) are left alone and not counted as available,
+ * and the anchor is erased before the first write or erase on the device.
+ * Linux then attaches by scanning once and writes a new fastmap.
+ */
+
+#ifdef UBI_LINUX
+#include <linux/crc32.h>
+#endif
+
+#include <ubi_uboot.h>
+#include "ubi.h"
+
+/* Reserved by the EBA and WL units whatever the volumes are */
+#define FM_OTHER_RSVD_PEBS	2
+
+/* What the fastmap told us about each PEB */
+enum {
+	FM_PEB_UNKNOWN = 0,
+	FM_PEB_KNOWN,		/* free, pending erasure or fastmap block */
+	FM_PEB_USED,		/* used, but not mapped by an EBA table yet */
+	FM_PEB_SCRUB,		/* like %FM_PEB_USED, needs scrubbing */
+	FM_PEB_MAPPED,		/* mapped by an EBA table */
+};
+
+/**
+ * struct fm_attach - state of a fastmap attach.
+ * @si: scanning information being built
+ * @state: per-PEB %FM_PEB_* state
+ * @ec: per-PEB erase counter taken from the fastmap
+ * @vidh: VID header buffer
+ * @ech: EC header buffer
+ */
+struct fm_attach {
+	struct ubi_scan_info *si;
+	unsigned char *state;
+	int *ec;
+	struct ubi_vid_hdr *vidh;
+	struct ubi_ec_hdr *ech;
+};
+
+/**
+ * fm_add_to_list - add a physical eraseblock to one of the scanning lists.
+ * @fa: fastmap attach state
+ * @pnum: physical eraseblock number
+ * @ec: erase counter of the physical eraseblock
+ * @list: the list to add to
+ */
+static int fm_add_to_list(struct fm_attach *fa, int pnum, int ec,
+			  struct list_head *list)
+{
+	struct ubi_scan_leb *seb;
+
+	seb = kzalloc(sizeof(struct ubi_scan_leb), GFP_KERNEL);
+	if (!seb)
+		return -ENOMEM;
+
+	seb->pnum = pnum;
+	seb->ec = ec;
+	list_add_tail(&seb->u.list, list);
+	if (list == &fa->si->alien)
+		fa->si->alien_peb_count += 1;
+	return 0;
+}
+
+/**
+ * fm_account_ec - account an erase counter in the scanning statistics.
+ * @si: scanning information
+ * @ec: erase counter
+ */
+static void fm_account_ec(struct ubi_scan_info *si, int ec)
+{
+	si->ec_sum += ec;
+	si->ec_count += 1;
+	if (ec > si->max_ec)
+		si->max_ec = ec;
+	if (ec < si->min_ec)
+		si->min_ec = ec;
+}
+
+/**
+ * fm_add_volume - add a volume described by the fastmap.
+ * @si: scanning information
+ * @fmvhdr: fastmap volume header
+ *
+ * Returns the new scanning volume, %NULL if the volume is already known and
+ * an error pointer if memory is short.
+ */
+static struct ubi_scan_volume *fm_add_volume(struct ubi_scan_info *si,
+					const struct ubi_fm_volhdr *fmvhdr)
+{
+	struct ubi_scan_volume *sv;
+	struct rb_node **p = &si->volumes.rb_node, *parent = NULL;
+	int vol_id = be32_to_cpu(fmvhdr->vol_id);
+
+	/* Same ordering as the scanning unit, see ubi_scan_find_sv() */
+	while (*p) {
+		parent = *p;
+		sv = rb_entry(parent, struct ubi_scan_volume, rb);
+
+		if (vol_id == sv->vol_id)
+			return NULL;
+
+		if (vol_id > sv->vol_id)
+			p = &(*p)->rb_left;
+		else
+			p = &(*p)->rb_right;
+	}
+
+	sv = kzalloc(sizeof(struct ubi_scan_volume), GFP_KERNEL);
+	if (!sv)
+		return ERR_PTR(-ENOMEM);
+
+	sv->vol_id = vol_id;
+	sv->root = RB_ROOT;
+	sv->used_ebs = be32_to_cpu(fmvhdr->used_ebs);
+	sv->data_pad = be32_to_cpu(fmvhdr->data_pad);
+	sv->last_data_size = be32_to_cpu(fmvhdr->last_eb_bytes);
+	/* Linux stores the in-memory volume type, accept VID types too */
+	if (fmvhdr->vol_type == UBI_STATIC_VOLUME ||
+	    fmvhdr->vol_type == UBI_VID_STATIC)
+		sv->vol_type = UBI_STATIC_VOLUME;
+	else
+		sv->vol_type = UBI_DYNAMIC_VOLUME;
+	if (vol_id == UBI_LAYOUT_VOLUME_ID)
+		sv->compat = UBI_LAYOUT_VOLUME_COMPAT;
+	if (vol_id > si->highest_vol_id)
+		si->highest_vol_id = vol_id;
+
+	rb_link_node(&sv->rb, parent, p);
+	rb_insert_color(&sv->rb, &si->volumes);
+	si->vols_found += 1;
+	dbg_bld("fastmap: added volume %d", vol_id);
+	return sv;
+}
+
+/**
+ * fm_map_leb - add a logical eraseblock from a fastmap EBA table.
+ * @fa: fastmap attach state
+ * @sv: volume the logical eraseblock belongs to
+ * @lnum: logical eraseblock number
+ * @pnum: physical eraseblock it is mapped to
+ *
+ * The sequence number is not known without reading the VID header, it is
+ * left at zero: any copy of the LEB found in a pool is newer.
+ */
+static int fm_map_leb(struct fm_attach *fa, struct ubi_scan_volume *sv,
+		      int lnum, int pnum)
+{
+	struct ubi_scan_leb *seb, *tmp;
+	struct rb_node **p = &sv->root.rb_node, *parent = NULL;
+
+	while (*p) {
+		parent = *p;
+		tmp = rb_entry(parent, struct ubi_scan_leb, u.rb);
+		if (lnum < tmp->lnum)
+			p = &(*p)->rb_left;
+		else
+			p = &(*p)->rb_right;
+	}
+
+	seb = kzalloc(sizeof(struct ubi_scan_leb), GFP_KERNEL);
+	if (!seb)
+		return -ENOMEM;
+
+	seb->ec = fa->ec[pnum];
+	seb->pnum = pnum;
+	seb->lnum = lnum;
+	seb->scrub = fa->state[pnum] == FM_PEB_SCRUB;
+	fa->state[pnum] = FM_PEB_MAPPED;
+
+	if (sv->highest_lnum <= lnum)
+		sv->highest_lnum = lnum;
+	sv->leb_count += 1;
+	rb_link_node(&seb->u.rb, parent, p);
+	rb_insert_color(&seb->u.rb, &sv->root);
+	return 0;
+}
+
+/**
+ * fm_find_anchor - find the most recent fastmap anchor PEB.
+ * @ubi: UBI device description object
+ * @fa: fastmap attach state
+ *
+ * Returns the anchor PEB number or %-1 if there is none.
+ */
+static int fm_find_anchor(struct ubi_device *ubi, struct fm_attach *fa)
+{
+	unsigned long long sqnum, max_sqnum = 0;
+	int pnum, err, anchor = -1;
+
+	for (pnum = 0; pnum < UBI_FM_MAX_START && pnum < ubi->peb_count;
+	     pnum++) {
+		if (ubi_io_is_bad(ubi, pnum))
+			continue;
+
+		err = ubi_io_read_vid_hdr(ubi, pnum, fa->vidh, 0);
+		if (err && err != UBI_IO_BITFLIPS)
+			continue;
+
+		if (be32_to_cpu(fa->vidh->vol_id) != UBI_FM_SB_VOLUME_ID)
+			continue;
+
+		sqnum = be64_to_cpu(fa->vidh->sqnum);
+		if (anchor < 0 || sqnum > max_sqnum) {
+			anchor = pnum;
+			max_sqnum = sqnum;
+		}
+	}
+
+	return anchor;
+}
+
+/**
+ * fm_read - read and check the fastmap blocks.
+ * @ubi: UBI device description object
+ * @fa: fastmap attach state
+ * @anchor: fastmap anchor PEB
+ * @fm_size: the fastmap size is returned here
+ *
+ * Returns a buffer holding the fastmap, %NULL if the fastmap is not valid
+ * and an error pointer in case of failure.
+ */
+static void *fm_read(struct ubi_device *ubi, struct fm_attach *fa, int anchor,
+		     int *fm_size)
+{
+	struct ubi_fm_sb *fmsb;
+	void *fm_raw;
+	uint32_t crc;
+	int i, err, pnum, used_blocks, vol_id;
+
+	fmsb = kzalloc(sizeof(struct ubi_fm_sb), GFP_KERNEL);
+	if (!fmsb)
+		return ERR_PTR(-ENOMEM);
+
+	err = ubi_io_read_data(ubi, fmsb, anchor, 0, sizeof(*fmsb));
+	if (err && err != UBI_IO_BITFLIPS)
+		goto out_invalid;
+
+	used_blocks = be32_to_cpu(fmsb->used_blocks);
+	if (be32_to_cpu(fmsb->magic) != UBI_FM_SB_MAGIC ||
+	    fmsb->version != UBI_FM_FMT_VERSION ||
+	    used_blocks < 1 || used_blocks > UBI_FM_MAX_BLOCKS ||
+	    be32_to_cpu(fmsb->block_loc[0]) != anchor) {
+		ubi_warn("bad fastmap super block at PEB %d", anchor);
+		goto out_invalid;
+	}
+
+	*fm_size = used_blocks * ubi->leb_size;
+	fm_raw = vmalloc(*fm_size);
+	if (!fm_raw) {
+		kfree(fmsb);
+		return ERR_PTR(-ENOMEM);
+	}
+
+	for (i = 0; i < used_blocks; i++) {
+		pnum = be32_to_cpu(fmsb->block_loc[i]);
+		if (pnum < 0 || pnum >= ubi->peb_count ||
+		    fa->state[pnum] != FM_PEB_UNKNOWN ||
+		    ubi_io_is_bad(ubi, pnum))
+			goto out_invalid_raw;
+
+		err = ubi_io_read_ec_hdr(ubi, pnum, fa->ech, 0);
+		if (err && err != UBI_IO_BITFLIPS)
+			goto out_invalid_raw;
+
+		err = ubi_io_read_vid_hdr(ubi, pnum, fa->vidh, 0);
+		if (err && err != UBI_IO_BITFLIPS)
+			goto out_invalid_raw;
+
+		vol_id = be32_to_cpu(fa->vidh->vol_id);
+		if (vol_id != (i ? UBI_FM_DATA_VOLUME_ID : UBI_FM_SB_VOLUME_ID))
+			goto out_invalid_raw;
+
+		if (fa->si->max_sqnum < be64_to_cpu(fa->vidh->sqnum))
+			fa->si->max_sqnum = be64_to_cpu(fa->vidh->sqnum);
+
+		err = ubi_io_read(ubi, fm_raw + i * ubi->leb_size, pnum,
+				  ubi->leb_start, ubi->leb_size);
+		if (err && err != UBI_IO_BITFLIPS)
+			goto out_invalid_raw;
+
+		/* The fastmap blocks stay out of UBI's way in U-Boot */
+		fa->state[pnum] = FM_PEB_KNOWN;
+		fa->ec[pnum] = be64_to_cpu(fa->ech->ec);
+		err = fm_add_to_list(fa, pnum, fa->ec[pnum], &fa->si->alien);
+		if (err) {
+			vfree(fm_raw);
+			kfree(fmsb);
+			return ERR_PTR(err);
+		}
+	}
+
+	/* The CRC covers the whole fastmap with the CRC field zeroed */
+	fmsb = memcpy(fmsb, fm_raw, sizeof(*fmsb));
+	((struct ubi_fm_sb *)fm_raw)->data_crc = 0;
+	crc = crc32(UBI_CRC32_INIT, fm_raw, *fm_size);
+	if (crc != be32_to_cpu(fmsb->data_crc)) {
+		ubi_warn("fastmap data CRC is invalid");
+		goto out_invalid_raw;
+	}
+
+	if (fa->si->max_sqnum < be64_to_cpu(fmsb->sqnum))
+		fa->si->max_sqnum = be64_to_cpu(fmsb->sqnum);
+
+	kfree(fmsb);
+	return fm_raw;
+
+out_invalid_raw:
+	vfree(fm_raw);
+out_invalid:
+	kfree(fmsb);
+	return NULL;
+}
+
+/**
+ * fm_scan_pool - scan the PEBs of a fastmap pool.
+ * @ubi: UBI device description object
+ * @fa: fastmap attach state
+ * @fmpl: the pool
+ *
+ * Pool PEBs may have been written after the fastmap, so they are scanned
+ * like a full scan would. Returns zero in case of success, %1 if the fastmap
+ * cannot be trusted and a negative error code in case of failure.
+ */
+static int fm_scan_pool(struct ubi_device *ubi, struct fm_attach *fa,
+			const struct ubi_fm_scan_pool *fmpl)
+{
+	struct ubi_scan_info *si = fa->si;
+	struct ubi_scan_volume *sv;
+	struct ubi_scan_leb *seb;
+	int i, err, pnum, ec, vol_id, bitflips, size = be16_to_cpu(fmpl->size);
+
+	if (be32_to_cpu(fmpl->magic) != UBI_FM_POOL_MAGIC ||
+	    size > UBI_FM_MAX_POOL_SIZE)
+		return 1;
+
+	for (i = 0; i < size; i++) {
+		pnum = be32_to_cpu(fmpl->pebs[i]);
+		if (pnum < 0 || pnum >= ubi->peb_count)
+			return 1;
+		if (fa->state[pnum] != FM_PEB_UNKNOWN &&
+		    fa->state[pnum] != FM_PEB_MAPPED)
+			return 1;
+
+		err = ubi_io_is_bad(ubi, pnum);
+		if (err)
+			return err < 0 ? err : 1;
+
+		bitflips = 0;
+		err = ubi_io_read_ec_hdr(ubi, pnum, fa->ech, 0);
+		if (err < 0)
+			return err;
+		if (err == UBI_IO_PEB_EMPTY) {
+			/* Linux erases it on its next attach */
+			fa->state[pnum] = FM_PEB_KNOWN;
+			err = fm_add_to_list(fa, pnum, UBI_SCAN_UNKNOWN_EC,
+					     &si->alien);
+			if (err)
+				return err;
+			continue;
+		}
+		if (err == UBI_IO_BITFLIPS)
+			bitflips = 1;
+		else if (err)
+			return 1;
+
+		ec = be64_to_cpu(fa->ech->ec);
+		if (fa->state[pnum] == FM_PEB_UNKNOWN)
+			fm_account_ec(si, ec);
+
+		err = ubi_io_read_vid_hdr(ubi, pnum, fa->vidh, 0);
+		if (err < 0)
+			return err;
+		if (err == UBI_IO_PEB_FREE) {
+			if (fa->state[pnum] == FM_PEB_MAPPED)
+				return 1;
+			fa->state[pnum] = FM_PEB_KNOWN;
+			err = fm_add_to_list(fa, pnum, ec, &si->free);
+			if (err)
+				return err;
+			continue;
+		}
+		if (err == UBI_IO_BITFLIPS)
+			bitflips = 1;
+		else if (err)
+			return 1;
+
+		vol_id = be32_to_cpu(fa->vidh->vol_id);
+		if (vol_id > UBI_MAX_VOLUMES && vol_id != UBI_LAYOUT_VOLUME_ID)
+			return 1;
+
+		if (fa->state[pnum] == FM_PEB_MAPPED) {
+			/*
+			 * The PEB was taken from the pool before the fastmap
+			 * was written. It must still hold the LEB the EBA
+			 * table says it does; we learn its sequence number.
+			 */
+			sv = ubi_scan_find_sv(si, vol_id);
+			seb = sv ? ubi_scan_find_seb(sv,
+					be32_to_cpu(fa->vidh->lnum)) : NULL;
+			if (!seb || seb->pnum != pnum)
+				return 1;
+			seb->sqnum = be64_to_cpu(fa->vidh->sqnum);
+			seb->scrub |= bitflips;
+			if (si->max_sqnum < seb->sqnum)
+				si->max_sqnum = seb->sqnum;
+			continue;
+		}
+
+		fa->state[pnum] = FM_PEB_MAPPED;
+		err = ubi_scan_add_used(ubi, si, pnum, ec, fa->vidh, bitflips);
+		if (err)
+			return err;
+	}
+
+	return 0;
+}
+
+/**
+ * fm_attach - build scanning information from the fastmap.
+ * @ubi: UBI device description object
+ * @fa: fastmap attach state
+ * @fm_raw: the fastmap
+ * @fm_size: fastmap size
+ *
+ * Returns zero in case of success, %1 if the fastmap cannot be trusted and a
+ * negative error code in case of failure.
+ */
+static int fm_attach(struct ubi_device *ubi, struct fm_attach *fa,
+		     void *fm_raw, int fm_size)
+{
+	struct ubi_scan_info *si = fa->si;
+	struct ubi_fm_hdr *fmhdr;
+	struct ubi_fm_scan_pool *fmpl1, *fmpl2;
+	struct ubi_fm_volhdr *fmvhdr;
+	struct ubi_fm_eba *fm_eba;
+	struct ubi_fm_ec *fmec;
+	struct ubi_scan_volume *sv;
+	struct ubi_scan_leb *seb, *tmp;
+	int fm_pos = sizeof(struct ubi_fm_sb);
+	int i, j, err, pnum, ec, count, state, vol_count, reserved_pebs;
+	int rsvd = FM_OTHER_RSVD_PEBS;
+	int counts[4];
+
+	fmhdr = fm_raw + fm_pos;
+	fm_pos += sizeof(*fmhdr);
+	if (be32_to_cpu(fmhdr->magic) != UBI_FM_HDR_MAGIC)
+		return 1;
+
+	fmpl1 = fm_raw + fm_pos;
+	fm_pos += sizeof(*fmpl1);
+	fmpl2 = fm_raw + fm_pos;
+	fm_pos += sizeof(*fmpl2);
+
+	/* Erase counters of the free, used, scrub and erase lists follow */
+	counts[0] = be32_to_cpu(fmhdr->free_peb_count);
+	counts[1] = be32_to_cpu(fmhdr->used_peb_count);
+	counts[2] = be32_to_cpu(fmhdr->scrub_peb_count);
+	counts[3] = be32_to_cpu(fmhdr->erase_peb_count);
+
+	for (i = 0; i < 4; i++) {
+		if (counts[i] < 0 || counts[i] > ubi->peb_count ||
+		    fm_pos + counts[i] * sizeof(*fmec) > fm_size)
+			return 1;
+
+		for (j = 0; j < counts[i]; j++) {
+			fmec = fm_raw + fm_pos;
+			fm_pos += sizeof(*fmec);
+
+			pnum = be32_to_cpu(fmec->pnum);
+			ec = be32_to_cpu(fmec->ec);
+			if (pnum < 0 || pnum >= ubi->peb_count ||
+			    fa->state[pnum] != FM_PEB_UNKNOWN ||
+			    ec < 0 || ec > UBI_MAX_ERASECOUNTER)
+				return 1;
+
+			fa->ec[pnum] = ec;
+			fm_account_ec(si, ec);
+
+			if (i == 0) {
+				fa->state[pnum] = FM_PEB_KNOWN;
+				err = fm_add_to_list(fa, pnum, ec, &si->free);
+			} else if (i == 3) {
+				/* Linux erases it, leave it alone here */
+				fa->state[pnum] = FM_PEB_KNOWN;
+				err = fm_add_to_list(fa, pnum, ec, &si->alien);
+			} else {
+				fa->state[pnum] = i == 1 ? FM_PEB_USED
+							 : FM_PEB_SCRUB;
+				err = 0;
+			}
+			if (err)
+				return err;
+		}
+	}
+
+	/* Volume headers, each followed by its EBA table */
+	vol_count = be32_to_cpu(fmhdr->vol_count);
+	if (vol_count < 0 || vol_count > UBI_MAX_VOLUMES + UBI_INT_VOL_COUNT)
+		return 1;
+
+	for (i = 0; i < vol_count; i++) {
+		if (fm_pos + sizeof(*fmvhdr) + sizeof(*fm_eba) > fm_size)
+			return 1;
+
+		fmvhdr = fm_raw + fm_pos;
+		fm_pos += sizeof(*fmvhdr);
+		if (be32_to_cpu(fmvhdr->magic) != UBI_FM_VHDR_MAGIC)
+			return 1;
+
+		sv = fm_add_volume(si, fmvhdr);
+		if (IS_ERR(sv))
+			return PTR_ERR(sv);
+		if (!sv)
+			return 1;
+
+		fm_eba = fm_raw + fm_pos;
+		fm_pos += sizeof(*fm_eba);
+		reserved_pebs = be32_to_cpu(fm_eba->reserved_pebs);
+		if (be32_to_cpu(fm_eba->magic) != UBI_FM_EBA_MAGIC ||
+		    reserved_pebs < 0 || reserved_pebs > ubi->peb_count ||
+		    fm_pos + reserved_pebs * sizeof(__be32) > fm_size)
+			return 1;
+		fm_pos += reserved_pebs * sizeof(__be32);
+		rsvd += reserved_pebs;
+
+		for (j = 0; j < reserved_pebs; j++) {
+			pnum = be32_to_cpu(fm_eba->pnum[j]);
+			if (pnum < 0)
+				continue;	/* unmapped */
+
+			if (pnum >= ubi->peb_count ||
+			    (fa->state[pnum] != FM_PEB_USED &&
+			     fa->state[pnum] != FM_PEB_SCRUB)) {
+				ubi_warn("fastmap: PEB %d is in EBA but not "
+					 "in the used list", pnum);
+				return 1;
+			}
+
+			err = fm_map_leb(fa, sv, j, pnum);
+			if (err)
+				return err;
+		}
+	}
+
+	err = fm_scan_pool(ubi, fa, fmpl1);
+	if (err)
+		return err;
+	err = fm_scan_pool(ubi, fa, fmpl2);
+	if (err)
+		return err;
+
+	/*
+	 * Used PEBs no EBA table refers to, and whatever the pool scan found
+	 * to be stale, are left to Linux to clean up.
+	 */
+	count = 0;
+	for (pnum = 0; pnum < ubi->peb_count; pnum++) {
+		state = fa->state[pnum];
+		if (state == FM_PEB_USED || state == FM_PEB_SCRUB) {
+			err = fm_add_to_list(fa, pnum, fa->ec[pnum],
+					     &si->alien);
+			if (err)
+				return err;
+		} else if (state == FM_PEB_UNKNOWN) {
+			continue;
+		}
+		count += 1;
+	}
+	list_for_each_entry_safe(seb, tmp, &si->erase, u.list) {
+		list_move_tail(&seb->u.list, &si->alien);
+		si->alien_peb_count += 1;
+	}
+	list_for_each_entry_safe(seb, tmp, &si->corr, u.list) {
+		list_move_tail(&seb->u.list, &si->alien);
+		si->alien_peb_count += 1;
+	}
+
+	si->bad_peb_count = be32_to_cpu(fmhdr->bad_peb_count);
+	if (count + si->bad_peb_count != ubi->peb_count) {
+		ubi_warn("fastmap accounts for %d of %d PEBs (%d bad)",
+			 count, ubi->peb_count, si->bad_peb_count);
+		return 1;
+	}
+
+	/*
+	 * The PEBs on the alien list are not available to UBI here. If the
+	 * rest cannot back what the volumes and UBI itself reserve, scanning
+	 * gives them back.
+	 */
+	ubi->good_peb_count = ubi->peb_count - si->bad_peb_count;
+	if (ubi->bad_allowed) {
+		ubi_calculate_reserved(ubi);
+		rsvd += ubi->beb_rsvd_level;
+	}
+	if (rsvd + si->alien_peb_count > ubi->good_peb_count) {
+		ubi_msg("fastmap owns %d PEBs, %d are reserved, of %d",
+			si->alien_peb_count, rsvd, ubi->good_peb_count);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * ubi_scan_fastmap - attach an MTD device using its fastmap.
+ * @ubi: UBI device description object
+ *
+ * This function returns the scanning information built from the fastmap,
+ * %NULL if there is no usable fastmap and the device has to be scanned, and
+ * an error pointer in case of failure.
+ */
+struct ubi_scan_info *ubi_scan_fastmap(struct ubi_device *ubi)
+{
+	struct fm_attach fa;
+	struct ubi_scan_info *si;
+	struct ubi_scan_volume *sv;
+	struct ubi_scan_leb *seb;
+	struct rb_node *rb1, *rb2;
+	void *fm_raw = NULL;
+	int err, anchor, fm_size;
+
+	memset(&fa, 0, sizeof(fa));
+	err = -ENOMEM;
+	si = kzalloc(sizeof(struct ubi_scan_info), GFP_KERNEL);
+	if (!si)
+		return ERR_PTR(err);
+
+	INIT_LIST_HEAD(&si->corr);
+	INIT_LIST_HEAD(&si->free);
+	INIT_LIST_HEAD(&si->erase);
+	INIT_LIST_HEAD(&si->alien);
+	si->volumes = RB_ROOT;
+	si->min_ec = UBI_MAX_ERASECOUNTER;
+	fa.si = si;
+
+	fa.state = vmalloc(ubi->peb_count);
+	fa.ec = vmalloc(ubi->peb_count * sizeof(int));
+	fa.ech = kzalloc(ubi->ec_hdr_alsize, GFP_KERNEL);
+	fa.vidh = ubi_zalloc_vid_hdr(ubi, GFP_KERNEL);
+	if (!fa.state || !fa.ec || !fa.ech || !fa.vidh)
+		goto out;
+	memset(fa.state, FM_PEB_UNKNOWN, ubi->peb_count);
+
+	anchor = fm_find_anchor(ubi, &fa);
+	if (anchor < 0) {
+		dbg_bld("no fastmap found");
+		err = 1;
+		goto out;
+	}
+
+	fm_raw = fm_read(ubi, &fa, anchor, &fm_size);
+	if (IS_ERR(fm_raw)) {
+		err = PTR_ERR(fm_raw);
+		fm_raw = NULL;
+		goto out;
+	}
+	if (!fm_raw) {
+		err = 1;
+		goto out;
+	}
+
+	err = fm_attach(ubi, &fa, fm_raw, fm_size);
+	if (err)
+		goto out;
+
+	si->is_empty = 0;
+	if (si->ec_count) {
+		do_div(si->ec_sum, si->ec_count);
+		si->mean_ec = si->ec_sum;
+	}
+
+	ubi_rb_for_each_entry(rb1, sv, &si->volumes, rb) {
+		ubi_rb_for_each_entry(rb2, seb, &sv->root, u.rb)
+			if (seb->ec == UBI_SCAN_UNKNOWN_EC)
+				seb->ec = si->mean_ec;
+	}
+	list_for_each_entry(seb, &si->alien, u.list)
+		if (seb->ec == UBI_SCAN_UNKNOWN_EC)
+			seb->ec = si->mean_ec;
+
+	ubi->fm_anchor = anchor;
+	ubi->fm_anchor_ec = fa.ec[anchor];
+	ubi->fm_peb_count = si->alien_peb_count;
+	ubi_msg("attached by fastmap at PEB %d, %d PEBs left to it", anchor,
+		ubi->fm_peb_count);
+
+out:
+	vfree(fm_raw);
+	ubi_free_vid_hdr(ubi, fa.vidh);
+	kfree(fa.ech);
+	vfree(fa.ec);
+	vfree(fa.state);
+
+	if (err) {
+		ubi_scan_destroy_si(si);
+		if (err == 1) {
+			ubi_msg("no valid fastmap, scanning the device");
+			return NULL;
+		}
+		return ERR_PTR(err);
+	}
+
+	return si;
+}
+
+/**
+ * ubi_fastmap_invalidate - make sure the fastmap is not used any more.
+ * @ubi: UBI device description object
+ *
+ * Called before UBI modifies the flash after attaching by fastmap. Erasing
+ * the anchor makes the next attach scan the device, as the fastmap no
+ * longer matches its contents. Returns zero in case of success and a
+ * negative error code in case of failure.
+ */
+int ubi_fastmap_invalidate(struct ubi_device *ubi)
+{
+	int pnum = ubi->fm_anchor;
+
+	if (pnum < 0)
+		return 0;
+
+	ubi->fm_anchor = -1;
+	ubi_msg("invalidating fastmap at PEB %d", pnum);
+	return ubi_scan_erase_peb(ubi, NULL, pnum, ubi->fm_anchor_ec + 1);
+}
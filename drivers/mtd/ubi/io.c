@@ -224,6 +224,12 @@ int ubi_io_write(struct ubi_device *ubi, const void *buf, int pnum, int offset,
 		return -EROFS;
 	}
 
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	err = ubi_fastmap_invalidate(ubi);
+	if (err)
+		return err;
+#endif
+
 	/* The below has to be compiled out if paranoid checks are disabled */
 
 	err = paranoid_check_not_bad(ubi, pnum);
@@ -474,6 +480,12 @@ int ubi_io_sync_erase(struct ubi_device *ubi, int pnum, int torture)
 		return -EROFS;
 	}
 
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	err = ubi_fastmap_invalidate(ubi);
+	if (err)
+		return err;
+#endif
+
 	if (torture) {
 		ret = torture_peb(ubi, pnum);
 		if (ret < 0)
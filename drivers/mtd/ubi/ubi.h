@@ -329,6 +329,12 @@ struct ubi_wl_entry;
  *               not
  * @mtd: MTD device descriptor
  *
+ * @fm_anchor: fastmap anchor PEB the device was attached from, %-1 if it was
+ *             attached by scanning or the fastmap has been invalidated
+ * @fm_anchor_ec: erase counter of @fm_anchor
+ * @fm_peb_count: count of PEBs the fastmap owns (its own blocks, PEBs to be
+ *                erased, ...), which are left alone and not available
+ *
  * @peb_buf1: a buffer of PEB size used for different purposes
  * @peb_buf2: another buffer of PEB size used for different purposes
  * @buf_mutex: proptects @peb_buf1 and @peb_buf2
@@ -408,6 +414,12 @@ struct ubi_device {
 	int bad_allowed;
 	struct mtd_info *mtd;
 
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	int fm_anchor;
+	int fm_anchor_ec;
+	int fm_peb_count;
+#endif
+
 	void *peb_buf1;
 	void *peb_buf2;
 	struct mutex buf_mutex;
@@ -511,6 +523,12 @@ int ubi_io_read_vid_hdr(struct ubi_device *ubi, int pnum,
 int ubi_io_write_vid_hdr(struct ubi_device *ubi, int pnum,
 			 struct ubi_vid_hdr *vid_hdr);
 
+/* fastmap.c */
+#ifdef CONFIG_MTD_UBI_FASTMAP
+struct ubi_scan_info *ubi_scan_fastmap(struct ubi_device *ubi);
+int ubi_fastmap_invalidate(struct ubi_device *ubi);
+#endif
+
 /* build.c */
 int ubi_attach_mtd_dev(struct mtd_info *mtd, int ubi_num, int vid_hdr_offset);
 int ubi_detach_mtd_dev(int ubi_num, int anyway);
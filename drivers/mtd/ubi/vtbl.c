@@ -780,6 +780,9 @@ int ubi_read_volume_table(struct ubi_device *ubi, struct ubi_scan_info *si)
 	}
 
 	ubi->avail_pebs = ubi->good_peb_count;
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	ubi->avail_pebs -= ubi->fm_peb_count;
+#endif
 
 	/*
 	 * The layout volume is OK, initialize the corresponding in-RAM data
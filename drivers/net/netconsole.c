@@ -7,6 +7,7 @@
 
 #include <common.h>
 #include <command.h>
+#include <initcall.h>
 #include <stdio_dev.h>
 #include <net.h>
 
@@ -28,6 +29,26 @@ static short nc_out_port; /* target output port */
 static short nc_in_port; /* source input port */
 static const char *output_packet; /* used by first send udp */
 static int output_packet_len;
+
+#ifdef CONFIG_NETCONSOLE_BUFFERED_OUTPUT
+/*
+ * Console output is collected here and sent in as few packets as
+ * possible: when the buffer is full, at a newline or console input poll
+ * once the oldest character has waited CONFIG_NETCONSOLE_FLUSH_MS, and
+ * before the network is used for something else or U-Boot stops
+ * (panic, hang, reset, booting an OS).
+ */
+#ifndef CONFIG_NETCONSOLE_OUTPUT_BUFFER_SIZE
+#define CONFIG_NETCONSOLE_OUTPUT_BUFFER_SIZE 1024
+#endif
+#ifndef CONFIG_NETCONSOLE_FLUSH_MS
+#define CONFIG_NETCONSOLE_FLUSH_MS 20
+#endif
+
+static char output_buffer[CONFIG_NETCONSOLE_OUTPUT_BUFFER_SIZE];
+static int output_size;
+static ulong output_start;	/* get_timer() when the buffer was empty */
+#endif
 /*
  * Start with a default last protocol.
  * We are only interested in NETCONS or not.
@@ -219,6 +240,9 @@ static int nc_start(void)
 {
 	int retval;
 
+	/* no interface to send on before the network is up */
+	initcall_run_deferred("eth");
+
 	nc_out_port = 6666; /* default port */
 	nc_in_port = nc_out_port;
 
@@ -235,6 +259,91 @@ static int nc_start(void)
 	return 0;
 }
 
+#ifdef CONFIG_NETCONSOLE_BUFFERED_OUTPUT
+static void nc_flush_buffer(void)
+{
+	if (output_size)
+		nc_send_packet(output_buffer, output_size);
+	output_size = 0;
+}
+
+void nc_flush(void)
+{
+	if (output_recursion)
+		return;
+	output_recursion = 1;
+
+	nc_flush_buffer();
+
+	output_recursion = 0;
+}
+
+/*
+ * Called whenever the console polls for input, whatever device stdin is,
+ * so a short line does not sit in the buffer while a long command runs.
+ */
+void nc_poll(void)
+{
+	struct eth_device *eth;
+
+	if (!output_size || output_recursion || input_recursion)
+		return;
+	if (get_timer(output_start) < CONFIG_NETCONSOLE_FLUSH_MS)
+		return;
+
+	eth = eth_get_dev();
+	if (eth && eth->state == ETH_STATE_ACTIVE)
+		return;	/* inside net loop, NetTxPacket may be in use */
+
+	nc_flush();
+}
+
+static void nc_buffer_output(const char *s, int len)
+{
+	int newline = 0;
+	int chunk;
+
+	while (len) {
+		if (!output_size)
+			output_start = get_timer(0);
+		chunk = min(len, sizeof(output_buffer) - output_size);
+		memcpy(output_buffer + output_size, s, chunk);
+		if (memchr(s, '\n', chunk))
+			newline = 1;
+		output_size += chunk;
+		s += chunk;
+		len -= chunk;
+		if (output_size == sizeof(output_buffer))
+			nc_flush_buffer();
+	}
+
+	if (newline && output_size &&
+	    get_timer(output_start) >= CONFIG_NETCONSOLE_FLUSH_MS)
+		nc_flush_buffer();
+}
+
+static void nc_putc(char c)
+{
+	if (output_recursion)
+		return;
+	output_recursion = 1;
+
+	nc_buffer_output(&c, 1);
+
+	output_recursion = 0;
+}
+
+static void nc_puts(const char *s)
+{
+	if (output_recursion)
+		return;
+	output_recursion = 1;
+
+	nc_buffer_output(s, strlen(s));
+
+	output_recursion = 0;
+}
+#else
 static void nc_putc(char c)
 {
 	if (output_recursion)
@@ -264,11 +373,13 @@ static void nc_puts(const char *s)
 
 	output_recursion = 0;
 }
+#endif
 
 static int nc_getc(void)
 {
 	uchar c;
 
+	nc_flush();
 	input_recursion = 1;
 
 	net_timeout = 0;	/* no timeout */
@@ -300,6 +411,9 @@ static int nc_tstc(void)
 	if (eth && eth->state == ETH_STATE_ACTIVE)
 		return 0;	/* inside net loop */
 
+	/* the console is idle waiting for input, send what we have */
+	nc_flush();
+
 	input_recursion = 1;
 
 	net_timeout = 1;
@@ -4,8 +4,9 @@
  * modified to use CONFIG_SYS_ISA_MEM and new defines
  */
 
-#include <config.h>
+#include <common.h>
 #include <ns16550.h>
+#include <serial.h>
 #include <watchdog.h>
 #include <linux/types.h>
 #include <asm/io.h>
@@ -34,6 +35,107 @@
 #define CONFIG_SYS_NS16550_IER  0x00
 #endif /* CONFIG_SYS_NS16550_IER */
 
+#if defined(CONFIG_SYS_NS16550_TX_BUFFER) && !defined(CONFIG_SPL_BUILD)
+#define NS16550_TX_BUFFER
+#endif
+
+#ifdef NS16550_TX_BUFFER
+DECLARE_GLOBAL_DATA_PTR;
+
+#define TX_SIZE		CONFIG_SYS_NS16550_TX_BUFFER
+#if TX_SIZE & (TX_SIZE - 1)
+#error "CONFIG_SYS_NS16550_TX_BUFFER must be a power of two"
+#endif
+
+#ifndef CONFIG_SYS_NS16550_FIFO_SIZE
+#define CONFIG_SYS_NS16550_FIFO_SIZE	16
+#endif
+
+/*
+ * Output waiting for the transmit FIFO. This lives in .bss, so it is only
+ * used after relocation, by the first port that prints; any other port is
+ * written to directly.
+ */
+static struct {
+	NS16550_t port;
+	uint head;		/* free-running index of the next byte to add */
+	uint tail;		/* free-running index of the next byte to send */
+	char buf[TX_SIZE];
+} ns16550_tx;
+
+static int ns16550_tx_ready(void)
+{
+	return (gd->flags & GD_FLG_RELOC) && ns16550_tx.port;
+}
+
+/* Move as much of the buffer to the FIFO as it will take without waiting */
+static void ns16550_tx_fill(void)
+{
+	NS16550_t port = ns16550_tx.port;
+	int i;
+
+	if (ns16550_tx.tail == ns16550_tx.head ||
+	    !(serial_in(&port->lsr) & UART_LSR_THRE))
+		return;
+
+	/* With the FIFO enabled, THRE means the whole FIFO is free */
+	for (i = 0; i < CONFIG_SYS_NS16550_FIFO_SIZE &&
+	     ns16550_tx.tail != ns16550_tx.head; i++)
+		serial_out(ns16550_tx.buf[ns16550_tx.tail++ & (TX_SIZE - 1)],
+			   &port->thr);
+}
+
+/* Send everything down to @left bytes, recording the time this takes */
+static void ns16550_tx_drain(uint left)
+{
+	bootstage_start(BOOTSTAGE_ID_ACCUM_CONSOLE, "console output");
+	while (ns16550_tx.head - ns16550_tx.tail > left) {
+		ns16550_tx_fill();
+		WATCHDOG_RESET();
+	}
+	bootstage_accum(BOOTSTAGE_ID_ACCUM_CONSOLE);
+}
+
+/* Add @c to the buffer if it belongs to @port; returns 1 if it was added */
+static int ns16550_tx_add(NS16550_t port, char c)
+{
+	if (!(gd->flags & GD_FLG_RELOC))
+		return 0;
+	if (!ns16550_tx.port)
+		ns16550_tx.port = port;
+	if (ns16550_tx.port != port)
+		return 0;
+
+	if (ns16550_tx.head - ns16550_tx.tail == TX_SIZE)
+		ns16550_tx_drain(TX_SIZE - 1);
+	ns16550_tx.buf[ns16550_tx.head++ & (TX_SIZE - 1)] = c;
+	ns16550_tx_fill();
+
+	return 1;
+}
+
+void serial_tx_poll(void)
+{
+	if (ns16550_tx_ready())
+		ns16550_tx_fill();
+}
+
+void serial_tx_flush(void)
+{
+	if (!ns16550_tx_ready())
+		return;
+
+	ns16550_tx_drain(0);
+	while (!(serial_in(&ns16550_tx.port->lsr) & UART_LSR_TEMT))
+		;
+}
+#else
+static inline int ns16550_tx_add(NS16550_t port, char c)
+{
+	return 0;
+}
+#endif /* NS16550_TX_BUFFER */
+
 void NS16550_init(NS16550_t com_port, int baud_divisor)
 {
 #if (defined(CONFIG_SPL_BUILD) && defined(CONFIG_OMAP34XX))
@@ -82,6 +184,9 @@ void NS16550_init(NS16550_t com_port, int baud_divisor)
 #ifndef CONFIG_NS16550_MIN_FUNCTIONS
 void NS16550_reinit(NS16550_t com_port, int baud_divisor)
 {
+	/* Resetting the FIFO drops what is in it */
+	serial_tx_flush();
+
 	serial_out(CONFIG_SYS_NS16550_IER, &com_port->ier);
 	serial_out(UART_LCR_BKSE | UART_LCRVAL, &com_port->lcr);
 	serial_out(0, &com_port->dll);
@@ -98,9 +203,11 @@ void NS16550_reinit(NS16550_t com_port, int baud_divisor)
 
 void NS16550_putc(NS16550_t com_port, char c)
 {
-	while ((serial_in(&com_port->lsr) & UART_LSR_THRE) == 0)
-		;
-	serial_out(c, &com_port->thr);
+	if (!ns16550_tx_add(com_port, c)) {
+		while ((serial_in(&com_port->lsr) & UART_LSR_THRE) == 0)
+			;
+		serial_out(c, &com_port->thr);
+	}
 
 	/*
 	 * Call watchdog_reset() upon newline. This is done here in putc
@@ -116,6 +223,7 @@ void NS16550_putc(NS16550_t com_port, char c)
 char NS16550_getc(NS16550_t com_port)
 {
 	while ((serial_in(&com_port->lsr) & UART_LSR_DR) == 0) {
+		serial_tx_poll();
 #if !defined(CONFIG_SPL_BUILD) && defined(CONFIG_USB_TTY)
 		extern void usbtty_poll(void);
 		usbtty_poll();
@@ -127,6 +235,7 @@ char NS16550_getc(NS16550_t com_port)
 
 int NS16550_tstc(NS16550_t com_port)
 {
+	serial_tx_poll();
 	return (serial_in(&com_port->lsr) & UART_LSR_DR) != 0;
 }
 
@@ -21,6 +21,11 @@
 # define CONFIG_SPI_IDLE_VAL 0xFF
 #endif
 
+/* Read modes the emulated controller offers to SPI flash */
+#ifndef CONFIG_SANDBOX_SPI_OP_MODE_RX
+# define CONFIG_SANDBOX_SPI_OP_MODE_RX	(SPI_OPM_RX_EXTN)
+#endif
+
 struct sandbox_spi_slave {
 	struct spi_slave slave;
 	const struct sandbox_spi_emu_ops *ops;
@@ -94,6 +99,7 @@ struct spi_slave *spi_setup_slave(unsigned int bus, unsigned int cs,
 		debug("sandbox_spi: Out of memory\n");
 		return NULL;
 	}
+	sss->slave.op_mode_rx = CONFIG_SANDBOX_SPI_OP_MODE_RX;
 
 	spec = state->spi[bus][cs].spec;
 	sss->ops = state->spi[bus][cs].ops;
@@ -183,6 +189,9 @@ int spi_xfer(struct spi_slave *slave, unsigned int bitlen, const void *dout,
 		debug(" %u:%02x", i, tx[i]);
 	debug("\n");
 
+	if (sss->ops->set_lines)
+		sss->ops->set_lines(sss->priv, flags & SPI_XFER_QUAD ? 4 :
+				    flags & SPI_XFER_DUAL ? 2 : 1);
 	ret = sss->ops->xfer(sss->priv, tx, rx, bytes);
 
 	debug("sandbox_spi: xfer: got back %i (that's %s)\n rx:",
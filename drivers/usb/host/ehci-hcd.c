@@ -545,15 +545,19 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 	/* Wait for TDs to be processed. */
 	ts = get_timer(0);
 	vtd = &qtd[qtd_counter - 1];
-	timeout = USB_TIMEOUT_MS(pipe);
+	/*
+	 * A mass-storage transfer of 65535 blocks is 32 MiB, so allow for at
+	 * least 1 MiB/s on top of the fixed timeout.
+	 */
+	timeout = USB_TIMEOUT_MS(pipe) + (length >> 10);
 	do {
-		/* Invalidate dcache */
-		invalidate_dcache_range((uint32_t)&ctrl->qh_list,
-			ALIGN_END_ADDR(struct QH, &ctrl->qh_list, 1));
-		invalidate_dcache_range((uint32_t)qh,
-			ALIGN_END_ADDR(struct QH, qh, 1));
-		invalidate_dcache_range((uint32_t)qtd,
-			ALIGN_END_ADDR(struct qTD, qtd, qtd_count));
+		/*
+		 * Only the last qTD tells us whether the chain is done, so
+		 * don't invalidate the whole (possibly large) qTD array on
+		 * every poll.
+		 */
+		invalidate_dcache_range((uint32_t)vtd & ~(USB_DMA_MINALIGN - 1),
+			ALIGN((uint32_t)(vtd + 1), USB_DMA_MINALIGN));
 
 		token = hc32_to_cpu(vtd->qt_token);
 		if (!(QT_TOKEN_GET_STATUS(token) & QT_TOKEN_STATUS_ACTIVE))
@@ -561,6 +565,14 @@ ehci_submit_async(struct usb_device *dev, unsigned long pipe, void *buffer,
 		WATCHDOG_RESET();
 	} while (get_timer(ts) < timeout);
 
+	/* Invalidate dcache */
+	invalidate_dcache_range((uint32_t)&ctrl->qh_list,
+		ALIGN_END_ADDR(struct QH, &ctrl->qh_list, 1));
+	invalidate_dcache_range((uint32_t)qh,
+		ALIGN_END_ADDR(struct QH, qh, 1));
+	invalidate_dcache_range((uint32_t)qtd,
+		ALIGN_END_ADDR(struct qTD, qtd, qtd_count));
+
 	/*
 	 * Invalidate the memory area occupied by buffer
 	 * Don't try to fix the buffer alignment, if it isn't properly
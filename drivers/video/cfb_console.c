@@ -208,6 +208,10 @@
 #include <splash.h>
 #endif
 
+#ifdef CONFIG_CONSOLE_SHADOW
+#include <con_shadow.h>
+#endif
+
 /*
  * Cursor definition:
  * CONFIG_CONSOLE_CURSOR:  Uses a timer function (see drivers/input/i8042.c)
@@ -370,6 +374,14 @@ static u32 eorx, fgx, bgx;	/* color pats */
 
 static int cfb_do_flush_cache;
 
+#ifdef CONFIG_CONSOLE_SHADOW
+static struct con_shadow cfb_shadow;
+static int cfb_shadow_ok;	/* 1 if the console goes through cfb_shadow */
+
+/* Cell attribute for ANSI inverse video */
+#define CFB_ATTR_INVERSE	(1 << CON_SHADOW_ATTR_SHIFT)
+#endif
+
 #ifdef CONFIG_CFB_CONSOLE_ANSI
 static char ansi_buf[10];
 static int ansi_buf_size;
@@ -654,6 +666,8 @@ static void video_invertchar(int xx, int yy)
 			*dest = ~*dest;
 		}
 	}
+	if (cfb_do_flush_cache)
+		flush_cache((ulong)video_fb_address + firsty, lasty - firsty);
 }
 
 void console_cursor(int state)
@@ -695,8 +709,10 @@ void console_cursor(int state)
 		}
 		cursor_state = state;
 	}
+#ifdef CONFIG_CONSOLE_TIME
 	if (cfb_do_flush_cache)
 		flush_cache(VIDEO_FB_ADRS, VIDEO_SIZE);
+#endif
 }
 #endif
 
@@ -716,7 +732,7 @@ static void memcpyl(int *d, int *s, int c)
 }
 #endif
 
-static void console_clear_line(int line, int begin, int end)
+static void video_clear_line(int line, int begin, int end)
 {
 #ifdef VIDEO_HW_RECTFILL
 	video_hw_rectfill(VIDEO_PIXEL_SIZE,		/* bytes per pixel */
@@ -751,8 +767,25 @@ static void console_clear_line(int line, int begin, int end)
 #endif
 }
 
+static void console_clear_line(int line, int begin, int end)
+{
+#ifdef CONFIG_CONSOLE_SHADOW
+	if (cfb_shadow_ok) {
+		con_shadow_clear_line(&cfb_shadow, line, begin, end);
+		return;
+	}
+#endif
+	video_clear_line(line, begin, end);
+}
+
 static void console_scrollup(void)
 {
+#ifdef CONFIG_CONSOLE_SHADOW
+	if (cfb_shadow_ok) {
+		con_shadow_scroll(&cfb_shadow, 1);
+		return;
+	}
+#endif
 	/* copy up rows ignoring the first one */
 
 #ifdef VIDEO_HW_BITBLT
@@ -775,6 +808,85 @@ static void console_scrollup(void)
 	console_clear_line(CONSOLE_ROWS - 1, 0, CONSOLE_COLS - 1);
 }
 
+#ifdef CONFIG_CONSOLE_SHADOW
+static void cfb_shadow_invert(void)
+{
+	u32 tmp = fgx;
+
+	fgx = bgx;
+	bgx = tmp;
+	eorx = fgx ^ bgx;
+}
+
+static void cfb_shadow_draw(void *priv, int col, int row, const u16 *cells,
+			    int count)
+{
+	unsigned char buf[32];
+	u16 attr;
+	int n;
+
+	for (; count > 0; col += n, cells += n, count -= n) {
+		/* A run of cells with the same attribute */
+		attr = cells[0] & CFB_ATTR_INVERSE;
+		for (n = 0; n < min(count, (int)sizeof(buf)) &&
+		     (cells[n] & CFB_ATTR_INVERSE) == attr; n++)
+			buf[n] = cells[n];
+
+		if (attr)
+			cfb_shadow_invert();
+		video_drawchars(col * VIDEO_FONT_WIDTH,
+				row * VIDEO_FONT_HEIGHT + video_logo_height,
+				buf, n);
+		if (attr)
+			cfb_shadow_invert();
+	}
+}
+
+static void cfb_shadow_clear(void *priv, int col, int row, u16 cell,
+			     int count)
+{
+	if (cell & CFB_ATTR_INVERSE)
+		cfb_shadow_invert();
+	video_clear_line(row, col, col + count - 1);
+	if (cell & CFB_ATTR_INVERSE)
+		cfb_shadow_invert();
+}
+
+static void cfb_shadow_move(void *priv, int dst, int src, int count)
+{
+#ifdef VIDEO_HW_BITBLT
+	video_hw_bitblt(VIDEO_PIXEL_SIZE,	/* bytes per pixel */
+			0,			/* source pos x */
+			video_logo_height +
+				VIDEO_FONT_HEIGHT * src, /* source pos y */
+			0,			/* dest pos x */
+			video_logo_height +
+				VIDEO_FONT_HEIGHT * dst, /* dest pos y */
+			VIDEO_VISIBLE_COLS,	/* frame width */
+			VIDEO_FONT_HEIGHT * count /* frame height */
+		);
+#else
+	memcpyl(CONSOLE_ROW_FIRST + CONSOLE_ROW_SIZE * dst,
+		CONSOLE_ROW_FIRST + CONSOLE_ROW_SIZE * src,
+		(CONSOLE_ROW_SIZE * count) >> 2);
+#endif
+}
+
+static void cfb_shadow_sync(void *priv, int first, int last)
+{
+	if (cfb_do_flush_cache)
+		flush_cache((ulong)CONSOLE_ROW_FIRST + CONSOLE_ROW_SIZE * first,
+			    CONSOLE_ROW_SIZE * (last - first + 1));
+}
+
+static const struct con_shadow_ops cfb_shadow_ops = {
+	.draw	= cfb_shadow_draw,
+	.clear	= cfb_shadow_clear,
+	.move	= cfb_shadow_move,
+	.sync	= cfb_shadow_sync,
+};
+#endif /* CONFIG_CONSOLE_SHADOW */
+
 static void console_back(void)
 {
 	console_col--;
@@ -791,6 +903,12 @@ static void console_back(void)
 
 static void console_clear(void)
 {
+#ifdef CONFIG_CONSOLE_SHADOW
+	if (cfb_shadow_ok) {
+		con_shadow_clear(&cfb_shadow, 0);
+		return;
+	}
+#endif
 #ifdef VIDEO_HW_RECTFILL
 	video_hw_rectfill(VIDEO_PIXEL_SIZE,	/* bytes per pixel */
 			  0,			/* dest pos x */
@@ -858,6 +976,12 @@ static void console_previousline(int n)
 
 static void console_swap_colors(void)
 {
+#ifdef CONFIG_CONSOLE_SHADOW
+	if (cfb_shadow_ok) {
+		cfb_shadow.attr ^= CFB_ATTR_INVERSE;
+		return;
+	}
+#endif
 	eorx = fgx;
 	fgx = bgx;
 	bgx = eorx;
@@ -875,6 +999,19 @@ static inline int console_cursor_is_visible(void)
 }
 #endif
 
+/*
+ * Whether the cursor follows each character. With the shadow console,
+ * video_sync() takes it off and puts it back once per batch instead.
+ */
+static inline int console_cursor_live(void)
+{
+#ifdef CONFIG_CONSOLE_SHADOW
+	if (cfb_shadow_ok)
+		return 0;
+#endif
+	return console_cursor_is_visible();
+}
+
 static void console_newline(int n)
 {
 	console_row += n;
@@ -899,7 +1036,7 @@ static void parse_putc(const char c)
 {
 	static int nl = 1;
 
-	if (console_cursor_is_visible())
+	if (console_cursor_live())
 		CURSOR_OFF;
 
 	switch (c) {
@@ -929,8 +1066,14 @@ static void parse_putc(const char c)
 		break;	/* ignored */
 
 	default:		/* draw the char */
-		video_putchar(console_col * VIDEO_FONT_WIDTH,
-			      console_row * VIDEO_FONT_HEIGHT, c);
+#ifdef CONFIG_CONSOLE_SHADOW
+		if (cfb_shadow_ok)
+			con_shadow_putc(&cfb_shadow, console_col, console_row,
+					c);
+		else
+#endif
+			video_putchar(console_col * VIDEO_FONT_WIDTH,
+				      console_row * VIDEO_FONT_HEIGHT, c);
 		console_col++;
 
 		/* check for newline */
@@ -940,11 +1083,28 @@ static void parse_putc(const char c)
 		}
 	}
 
-	if (console_cursor_is_visible())
+	if (console_cursor_live())
 		CURSOR_SET;
 }
 
-void video_putc(const char c)
+/* Bring the screen up to date after a batch of console output */
+static void video_sync(void)
+{
+#ifdef CONFIG_CONSOLE_SHADOW
+	if (cfb_shadow_ok) {
+		/* Nothing may be moved or redrawn with the cursor on it */
+		CURSOR_OFF;
+		con_shadow_render(&cfb_shadow);
+		if (console_cursor_is_visible())
+			CURSOR_SET;
+		return;
+	}
+#endif
+	if (cfb_do_flush_cache)
+		flush_cache(VIDEO_FB_ADRS, VIDEO_SIZE);
+}
+
+static void console_putc(const char c)
 {
 #ifdef CONFIG_CFB_CONSOLE_ANSI
 	int i;
@@ -1071,7 +1231,7 @@ void video_putc(const char c)
 		}
 
 		if (flush) {
-			if (!ansi_cursor_hidden)
+			if (console_cursor_live())
 				CURSOR_OFF;
 			ansi_buf_size = 0;
 			switch (cchar) {
@@ -1145,7 +1305,7 @@ void video_putc(const char c)
 				}
 				break;
 			}
-			if (!ansi_cursor_hidden)
+			if (console_cursor_live())
 				CURSOR_SET;
 		}
 	} else {
@@ -1154,8 +1314,12 @@ void video_putc(const char c)
 #else
 	parse_putc(c);
 #endif
-	if (cfb_do_flush_cache)
-		flush_cache(VIDEO_FB_ADRS, VIDEO_SIZE);
+}
+
+void video_putc(const char c)
+{
+	console_putc(c);
+	video_sync();
 }
 
 void video_puts(const char *s)
@@ -1163,7 +1327,8 @@ void video_puts(const char *s)
 	int count = strlen(s);
 
 	while (count--)
-		video_putc(*s++);
+		console_putc(*s++);
+	video_sync();
 }
 
 /*
@@ -2128,6 +2293,10 @@ void video_clear(void)
 	memsetl(video_fb_address,
 		(VIDEO_VISIBLE_ROWS * VIDEO_LINE_LEN) / sizeof(int), bgx);
 #endif
+#ifdef CONFIG_CONSOLE_SHADOW
+	if (cfb_shadow_ok)
+		con_shadow_clear(&cfb_shadow, 1);
+#endif
 }
 
 static int video_init(void)
@@ -2229,6 +2398,10 @@ static int video_init(void)
 	/* Initialize the console */
 	console_col = 0;
 	console_row = 0;
+#ifdef CONFIG_CONSOLE_SHADOW
+	cfb_shadow_ok = !con_shadow_init(&cfb_shadow, CONSOLE_COLS,
+					 CONSOLE_ROWS, &cfb_shadow_ops, NULL);
+#endif
 
 	if (cfb_do_flush_cache)
 		flush_cache(VIDEO_FB_ADRS, VIDEO_SIZE);
@@ -0,0 +1,157 @@
+/*
+ * Shadow text buffer for frame buffer consoles
+ *
+ * Text is written into a buffer of character cells instead of straight
+ * into the frame buffer. Rendering then draws only the cells that differ
+ * from what the frame buffer shows, scrolls once for all the lines that
+ * went by, and flushes once, so that a burst of output costs about as much
+ * as drawing the final screen.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <con_shadow.h>
+#include <errno.h>
+#include <malloc.h>
+
+static u16 *con_shadow_row(struct con_shadow *con, int row)
+{
+	row += con->top;
+	if (row >= con->rows)
+		row -= con->rows;
+
+	return con->text + row * con->cols;
+}
+
+static void con_shadow_touch(struct con_shadow *con, int first, int last)
+{
+	con->first = min(con->first, first);
+	con->last = max(con->last, last);
+}
+
+int con_shadow_init(struct con_shadow *con, int cols, int rows,
+		    const struct con_shadow_ops *ops, void *priv)
+{
+	int size = cols * rows;
+
+	free(con->text);
+	con->text = malloc(2 * size * sizeof(u16));
+	if (!con->text)
+		return -ENOMEM;
+	con->shown = con->text + size;
+	con->cols = cols;
+	con->rows = rows;
+	con->attr = 0;
+	con->ops = ops;
+	con->priv = priv;
+	con->first = rows;
+	con->last = -1;
+	con_shadow_clear(con, 1);
+
+	return 0;
+}
+
+void con_shadow_putc(struct con_shadow *con, int col, int row, uchar c)
+{
+	con_shadow_row(con, row)[col] = c | con->attr;
+	con_shadow_touch(con, row, row);
+}
+
+void con_shadow_clear_line(struct con_shadow *con, int row, int from,
+			   int to)
+{
+	u16 *cell = con_shadow_row(con, row);
+	int col;
+
+	for (col = from; col <= to; col++)
+		cell[col] = ' ' | con->attr;
+	con_shadow_touch(con, row, row);
+}
+
+void con_shadow_clear(struct con_shadow *con, int blank)
+{
+	int i;
+
+	con->top = 0;
+	con->scrolled = 0;
+	for (i = 0; i < con->rows; i++)
+		con_shadow_clear_line(con, i, 0, con->cols - 1);
+	if (blank)
+		memcpy(con->shown, con->text,
+		       con->cols * con->rows * sizeof(u16));
+}
+
+void con_shadow_scroll(struct con_shadow *con, int count)
+{
+	int i;
+
+	if (count >= con->rows) {
+		con_shadow_clear(con, 0);
+		return;
+	}
+
+	/* The top row becomes the bottom one */
+	for (i = 0; i < count; i++) {
+		con_shadow_clear_line(con, 0, 0, con->cols - 1);
+		if (++con->top == con->rows)
+			con->top = 0;
+	}
+	con->scrolled = min(con->scrolled + count, con->rows);
+	con_shadow_touch(con, 0, con->rows - 1);
+}
+
+void con_shadow_render(struct con_shadow *con)
+{
+	int cols = con->cols;
+	int first = con->rows, last = -1;
+	int row, col, end, blank, keep;
+	u16 *text, *shown;
+
+	/*
+	 * Move what is still on screen into place first. What the move
+	 * leaves behind in the bottom rows is unchanged, as is the end of
+	 * the shown buffer after memmove().
+	 */
+	keep = con->rows - con->scrolled;
+	if (con->scrolled && keep > 0 && con->ops->move) {
+		con->ops->move(con->priv, 0, con->scrolled, keep);
+		memmove(con->shown, con->shown + con->scrolled * cols,
+			keep * cols * sizeof(u16));
+		first = 0;
+		last = keep - 1;
+	}
+	con->scrolled = 0;
+
+	for (row = con->first; row <= con->last; row++) {
+		text = con_shadow_row(con, row);
+		shown = con->shown + row * cols;
+
+		for (col = 0; col < cols && text[col] == shown[col]; col++)
+			;
+		if (col == cols)
+			continue;
+		for (end = cols; text[end - 1] == shown[end - 1]; end--)
+			;
+
+		/* Filling is much quicker than drawing spaces */
+		blank = end;
+		if (con->ops->clear && (text[end - 1] & 0xff) == ' ')
+			while (blank > col && text[blank - 1] == text[end - 1])
+				blank--;
+		if (blank > col)
+			con->ops->draw(con->priv, col, row, text + col,
+				       blank - col);
+		if (blank < end)
+			con->ops->clear(con->priv, blank, row, text[end - 1],
+					end - blank);
+		memcpy(shown + col, text + col, (end - col) * sizeof(u16));
+		first = min(first, row);
+		last = max(last, row);
+	}
+	con->first = con->rows;
+	con->last = -1;
+
+	if (last >= 0 && con->ops->sync)
+		con->ops->sync(con->priv, first, last);
+}
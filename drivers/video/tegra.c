@@ -87,7 +87,12 @@ void lcd_ctrl_init(void *lcdbase)
 		type = DCACHE_WRITETHROUGH;
 	else if (config.cache_type & FDT_LCD_CACHE_WRITE_BACK)
 		type = DCACHE_WRITEBACK;
-	mmu_set_region_dcache_behaviour(disp_config->frame_buffer, size, type);
+	else if (config.cache_type & FDT_LCD_CACHE_WRITE_COMBINE)
+		type = DCACHE_WRITECOMBINE;
+	/* Leave the memory around the frame buffer alone if we can */
+	if (mmu_map_region(disp_config->frame_buffer, size, type))
+		mmu_set_region_dcache_behaviour(disp_config->frame_buffer,
+						size, type);
 
 	/* Enable flushing after LCD writes if requested */
 	lcd_set_flush_dcache(config.cache_type & FDT_LCD_CACHE_FLUSH);
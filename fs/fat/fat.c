@@ -271,7 +271,8 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 
 	debug("gc - clustnum: %d, startsect: %d\n", clustnum, startsect);
 
-	if ((unsigned long)buffer & (ARCH_DMA_MINALIGN - 1)) {
+	if (((unsigned long)buffer & (ARCH_DMA_MINALIGN - 1)) &&
+	    !cur_dev->any_align) {
 		ALLOC_CACHE_ALIGN_BUFFER(__u8, tmpbuf, mydata->sect_size);
 
 		printf("FAT: Misaligned buffer address (%p)\n", buffer);
@@ -168,45 +168,98 @@ static struct part_info *current_part;
 #endif
 #define NAND_CACHE_SIZE (NAND_CACHE_PAGES*NAND_PAGE_SIZE)
 
-static u8* nand_cache = NULL;
-static u32 nand_cache_off = (u32)-1;
+/*
+ * Number of NAND_CACHE_SIZE windows kept around. Node lists are not
+ * sorted by flash offset, so reading a file back jumps between a few
+ * areas of the partition; one window alone keeps getting thrown away.
+ */
+#ifndef NAND_CACHE_WINDOWS
+#define NAND_CACHE_WINDOWS 4
+#endif
+
+static struct nand_cache_window {
+	u8 *buf;
+	u32 off;
+	u32 len;	/* shorter than NAND_CACHE_SIZE at the chip end */
+	u32 stamp;	/* last use, for LRU replacement */
+} nand_cache[NAND_CACHE_WINDOWS];
+static u32 nand_cache_stamp;
+static int nand_cache_dev = -1;
+static u32 nand_cache_gen;	/* write_gen of nand_cache_dev when filled */
+
+static struct nand_cache_window *nand_cache_get(nand_info_t *nand, u32 off)
+{
+	struct nand_cache_window *w, *victim = &nand_cache[0];
+	size_t retlen;
+	int i;
+
+	for (i = 0; i < NAND_CACHE_WINDOWS; i++) {
+		w = &nand_cache[i];
+		if (w->off != (u32)-1 &&
+		    off >= w->off && off < w->off + w->len)
+			goto hit;
+		/* empty windows have stamp 0 and get picked first */
+		if (w->stamp < victim->stamp)
+			victim = w;
+	}
+
+	w = victim;
+	if (!w->buf) {
+		/* This memory never gets freed but 'cause
+		   it's a bootloader, nobody cares */
+		w->buf = malloc(NAND_CACHE_SIZE);
+		if (!w->buf) {
+			printf("read_nand_cached: can't alloc cache size %d bytes\n",
+			       NAND_CACHE_SIZE);
+			return NULL;
+		}
+	}
+
+	w->off = off & NAND_PAGE_MASK;
+	/* the window is page aligned only, don't run off the chip */
+	w->len = min_t(u64, NAND_CACHE_SIZE, nand->size - w->off);
+	retlen = w->len;
+	if (nand_read(nand, w->off, &retlen, w->buf) != 0 ||
+	    retlen != w->len) {
+		printf("read_nand_cached: error reading nand off %#x size %d bytes\n",
+		       w->off, w->len);
+		w->off = (u32)-1;
+		w->stamp = 0;
+		return NULL;
+	}
+hit:
+	w->stamp = ++nand_cache_stamp;
+	return w;
+}
 
 static int read_nand_cached(u32 off, u32 size, u_char *buf)
 {
 	struct mtdids *id = current_part->dev->id;
+	nand_info_t *nand = &nand_info[id->num];
+	struct nand_cache_window *w;
 	u32 bytes_read = 0;
-	size_t retlen;
 	int cpy_bytes;
+	int i;
 
-	while (bytes_read < size) {
-		if ((off + bytes_read < nand_cache_off) ||
-		    (off + bytes_read >= nand_cache_off+NAND_CACHE_SIZE)) {
-			nand_cache_off = (off + bytes_read) & NAND_PAGE_MASK;
-			if (!nand_cache) {
-				/* This memory never gets freed but 'cause
-				   it's a bootloader, nobody cares */
-				nand_cache = malloc(NAND_CACHE_SIZE);
-				if (!nand_cache) {
-					printf("read_nand_cached: can't alloc cache size %d bytes\n",
-					       NAND_CACHE_SIZE);
-					return -1;
-				}
-			}
-
-			retlen = NAND_CACHE_SIZE;
-			if (nand_read(&nand_info[id->num], nand_cache_off,
-						&retlen, nand_cache) != 0 ||
-					retlen != NAND_CACHE_SIZE) {
-				printf("read_nand_cached: error reading nand off %#x size %d bytes\n",
-						nand_cache_off, NAND_CACHE_SIZE);
-				return -1;
-			}
+	/* drop everything cached if the chip was written since */
+	if (nand_cache_dev != id->num || nand_cache_gen != nand->write_gen) {
+		for (i = 0; i < NAND_CACHE_WINDOWS; i++) {
+			nand_cache[i].off = (u32)-1;
+			nand_cache[i].stamp = 0;
 		}
-		cpy_bytes = nand_cache_off + NAND_CACHE_SIZE - (off + bytes_read);
+		nand_cache_dev = id->num;
+		nand_cache_gen = nand->write_gen;
+	}
+
+	while (bytes_read < size) {
+		w = nand_cache_get(nand, off + bytes_read);
+		if (!w)
+			return -1;
+		cpy_bytes = w->off + w->len - (off + bytes_read);
 		if (cpy_bytes > size - bytes_read)
 			cpy_bytes = size - bytes_read;
 		memcpy(buf + bytes_read,
-		       nand_cache + off + bytes_read - nand_cache_off,
+		       w->buf + off + bytes_read - w->off,
 		       cpy_bytes);
 		bytes_read += cpy_bytes;
 	}
@@ -271,12 +324,20 @@ static void put_fl_mem_nand(void *buf)
 static u8* onenand_cache;
 static u32 onenand_cache_off = (u32)-1;
 
+static u32 onenand_cache_gen;
+
 static int read_onenand_cached(u32 off, u32 size, u_char *buf)
 {
 	u32 bytes_read = 0;
 	size_t retlen;
 	int cpy_bytes;
 
+	/* drop the cached window if the chip was written since */
+	if (onenand_cache_gen != onenand_mtd.write_gen) {
+		onenand_cache_off = (u32)-1;
+		onenand_cache_gen = onenand_mtd.write_gen;
+	}
+
 	while (bytes_read < size) {
 		if ((off + bytes_read < onenand_cache_off) ||
 		    (off + bytes_read >= onenand_cache_off + ONENAND_CACHE_SIZE)) {
@@ -419,7 +480,7 @@ static inline void *get_fl_mem(u32 off, u32 size, void *ext_buf)
 		printf("get_fl_mem: unknown device type, " \
 			"using raw offset!\n");
 	}
-	return (void*)off;
+	return (void *)(uintptr_t)off;
 }
 
 static inline void *get_node_mem(u32 off, void *ext_buf)
@@ -447,7 +508,7 @@ static inline void *get_node_mem(u32 off, void *ext_buf)
 		printf("get_fl_mem: unknown device type, " \
 			"using raw offset!\n");
 	}
-	return (void*)off;
+	return (void *)(uintptr_t)off;
 }
 
 static inline void put_fl_mem(void *buf, void *ext_buf)
@@ -470,6 +531,31 @@ static inline void put_fl_mem(void *buf, void *ext_buf)
 	}
 }
 
+/*
+ * NAND and OneNAND are only ever changed through the MTD layer, which
+ * counts writes and erases in write_gen. NOR is memory mapped and may
+ * be written behind our back, so there is no such count for it.
+ */
+static int jffs2_write_gen(struct part_info *part, u32 *gen)
+{
+	struct mtdids *id = part->dev->id;
+
+	switch(id->type) {
+#if defined(CONFIG_JFFS2_NAND) && defined(CONFIG_CMD_NAND)
+	case MTD_DEV_TYPE_NAND:
+		*gen = nand_info[id->num].write_gen;
+		return 1;
+#endif
+#if defined(CONFIG_CMD_ONENAND)
+	case MTD_DEV_TYPE_ONENAND:
+		*gen = onenand_mtd.write_gen;
+		return 1;
+#endif
+	default:
+		return 0;
+	}
+}
+
 /* Compression names */
 static char *compr_names[] = {
 	"NONE",
@@ -1173,6 +1259,7 @@ jffs2_1pass_rescan_needed(struct part_info *part)
 	struct jffs2_unknown_node onode;
 	struct jffs2_unknown_node *node;
 	struct b_lists *pL = (struct b_lists *)part->jffs2_priv;
+	u32 gen;
 
 	if (part->jffs2_priv == 0){
 		DEBUGF ("rescan: First time in use\n");
@@ -1185,6 +1272,18 @@ jffs2_1pass_rescan_needed(struct part_info *part)
 		return 1;
 	}
 
+	/*
+	 * Keep the index for as long as the device has not been written
+	 * or erased, that saves reading back every dirent header.
+	 */
+	if (jffs2_write_gen(part, &gen)) {
+		if (gen != pL->write_gen) {
+			DEBUGF ("rescan: device written since last scan\n");
+			return 1;
+		}
+		return 0;
+	}
+
 	/* but suppose someone reflashed a partition at the same offset... */
 	b = pL->dir.listHead;
 	while (b) {
@@ -1201,20 +1300,20 @@ jffs2_1pass_rescan_needed(struct part_info *part)
 }
 
 #ifdef CONFIG_JFFS2_SUMMARY
-static u32 sum_get_unaligned32(u32 *ptr)
+static u32 sum_get_unaligned32(const void *ptr)
 {
 	u32 val;
-	u8 *p = (u8 *)ptr;
+	const u8 *p = ptr;
 
 	val = *p | (*(p + 1) << 8) | (*(p + 2) << 16) | (*(p + 3) << 24);
 
 	return __le32_to_cpu(val);
 }
 
-static u16 sum_get_unaligned16(u16 *ptr)
+static u16 sum_get_unaligned16(const void *ptr)
 {
 	u16 val;
-	u8 *p = (u8 *)ptr;
+	const u8 *p = ptr;
 
 	val = *p | (*(p + 1) << 8);
 
@@ -1229,11 +1328,12 @@ static u16 sum_get_unaligned16(u16 *ptr)
 
 static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 				struct jffs2_raw_summary *summary,
-				struct b_lists *pL)
+				struct b_lists *pL, u32 *max_totlen)
 {
 	void *sp;
 	int i, pass;
 	void *ret;
+	u32 totlen;
 
 	for (pass = 0; pass < 2; pass++) {
 		sp = summary->sum;
@@ -1255,6 +1355,10 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 								&spi->offset));
 						if (ret == NULL)
 							return -1;
+						totlen = sum_get_unaligned32(
+								&spi->totlen);
+						if (*max_totlen < totlen)
+							*max_totlen = totlen;
 					}
 
 					sp += JFFS2_SUMMARY_INODE_SIZE;
@@ -1272,6 +1376,10 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 								&spd->offset));
 						if (ret == NULL)
 							return -1;
+						totlen = sum_get_unaligned32(
+								&spd->totlen);
+						if (*max_totlen < totlen)
+							*max_totlen = totlen;
 					}
 
 					sp += JFFS2_SUMMARY_DIRENT_SIZE(
@@ -1299,16 +1407,14 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 /* Process the summary node - called from jffs2_scan_eraseblock() */
 int jffs2_sum_scan_sumnode(struct part_info *part, uint32_t offset,
 			   struct jffs2_raw_summary *summary, uint32_t sumsize,
-			   struct b_lists *pL)
+			   struct b_lists *pL, u32 *max_totlen)
 {
 	struct jffs2_unknown_node crcnode;
-	int ret, ofs;
+	int ret;
 	uint32_t crc;
 
-	ofs = part->sector_size - sumsize;
-
 	dbg_summary("summary found for 0x%08x at 0x%08x (0x%x bytes)\n",
-		    offset, offset + ofs, sumsize);
+		    offset, offset + part->sector_size - sumsize, sumsize);
 
 	/* OK, now check for node validity and CRC */
 	crcnode.magic = JFFS2_MAGIC_BITMASK;
@@ -1346,7 +1452,8 @@ int jffs2_sum_scan_sumnode(struct part_info *part, uint32_t offset,
 	if (summary->cln_mkr)
 		dbg_summary("Summary : CLEANMARKER node \n");
 
-	ret = jffs2_sum_process_sum_data(part, offset, summary, pL);
+	ret = jffs2_sum_process_sum_data(part, offset, summary, pL,
+					 max_totlen);
 	if (ret == -EBADMSG)
 		return 0;
 	if (ret)
@@ -1457,6 +1564,7 @@ jffs2_1pass_build_lists(struct part_info * part)
 	/* if we are building a list we need to refresh the cache. */
 	jffs_init_1pass_list(part);
 	pL = (struct b_lists *)part->jffs2_priv;
+	jffs2_write_gen(part, &pL->write_gen);
 	buf = malloc(buf_size);
 	puts ("Scanning JFFS2 FS:   ");
 
@@ -1515,7 +1623,7 @@ jffs2_1pass_build_lists(struct part_info * part)
 
 		if (sumptr) {
 			ret = jffs2_sum_scan_sumnode(part, sector_ofs, sumptr,
-					sumlen, pL);
+					sumlen, pL, &max_totlen);
 
 			if (buf_size && sumlen > buf_size)
 				free(sumptr);
@@ -26,6 +26,7 @@ struct b_lists {
 	struct b_list dir;
 	struct b_list frag;
 	void *readbuf;
+	u32 write_gen;	/* MTD write_gen the lists were built at */
 };
 
 struct b_compr_info {
@@ -90,7 +91,7 @@ static inline int
 data_crc(struct jffs2_raw_inode *node)
 {
 	if (node->data_crc != crc32_no_comp(0, (unsigned char *)
-					    ((int) &node->node_crc + sizeof (node->node_crc)),
+					    ((ulong) &node->node_crc + sizeof (node->node_crc)),
 					     node->csize)) {
 		return 0;
 	} else {
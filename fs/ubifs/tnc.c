@@ -1474,6 +1474,43 @@ out:
 	return err;
 }
 
+/**
+ * bu_lookup_level0 - find the first bulk-read key.
+ * @c: UBIFS file-system description object
+ * @bu: bulk-read parameters
+ * @zn: znode is returned here
+ * @n: znode branch slot number is returned here
+ *
+ * Same as 'ubifs_lookup_level0()' for @bu->key, but if the key right after
+ * the bulk-read cursor is @bu->key or beyond it, the position is taken from
+ * the cursor instead of looking the key up from the root.
+ */
+static int bu_lookup_level0(struct ubifs_info *c, struct bu_info *bu,
+			    struct ubifs_znode **zn, int *n)
+{
+	struct ubifs_znode *znode = bu->cursor;
+	int nn = bu->cursor_n, cmp;
+
+	if (!znode ||
+	    keys_cmp(c, &znode->zbranch[nn].key, &bu->key) >= 0 ||
+	    tnc_next(c, &znode, &nn))
+		return ubifs_lookup_level0(c, &bu->key, zn, n);
+
+	cmp = keys_cmp(c, &znode->zbranch[nn].key, &bu->key);
+	if (cmp < 0)
+		return ubifs_lookup_level0(c, &bu->key, zn, n);
+	if (cmp == 0) {
+		*zn = znode;
+		*n = nn;
+		return 1;
+	}
+
+	/* Not found, position at the key before, as the lookup would */
+	*zn = bu->cursor;
+	*n = bu->cursor_n;
+	return 0;
+}
+
 /**
  * ubifs_tnc_get_bu_keys - lookup keys for bulk-read.
  * @c: UBIFS file-system description object
@@ -1500,7 +1537,7 @@ int ubifs_tnc_get_bu_keys(struct ubifs_info *c, struct bu_info *bu)
 
 	mutex_lock(&c->tnc_mutex);
 	/* Find first key */
-	err = ubifs_lookup_level0(c, &bu->key, &znode, &n);
+	err = bu_lookup_level0(c, bu, &znode, &n);
 	if (err < 0)
 		goto out;
 	if (err) {
@@ -1514,6 +1551,8 @@ int ubifs_tnc_get_bu_keys(struct ubifs_info *c, struct bu_info *bu)
 		/* Add this key */
 		bu->zbranch[bu->cnt++] = znode->zbranch[n];
 		bu->blk_cnt += 1;
+		bu->cursor = znode;
+		bu->cursor_n = n;
 		lnum = znode->zbranch[n].lnum;
 		offs = ALIGN(znode->zbranch[n].offs + len, 8);
 	}
@@ -1565,6 +1604,8 @@ int ubifs_tnc_get_bu_keys(struct ubifs_info *c, struct bu_info *bu)
 		/* Add this key */
 		bu->zbranch[bu->cnt++] = *zbr;
 		bu->blk_cnt += 1;
+		bu->cursor = znode;
+		bu->cursor_n = n;
 		/* See if we have room for more */
 		if (bu->cnt >= UBIFS_MAX_BULK_READ)
 			goto out;
@@ -25,6 +25,7 @@
 
 #include "ubifs.h"
 #include <u-boot/zlib.h>
+#include <asm/io.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -519,23 +520,13 @@ static inline void *kmap(struct page *page)
 	return page->addr;
 }
 
-static int read_block(struct inode *inode, void *addr, unsigned int block,
-		      struct ubifs_data_node *dn)
+static int decompress_block(struct ubifs_info *c, struct inode *inode,
+			    void *addr, unsigned int block,
+			    struct ubifs_data_node *dn)
 {
-	struct ubifs_info *c = inode->i_sb->s_fs_info;
 	int err, len, out_len;
-	union ubifs_key key;
 	unsigned int dlen;
 
-	data_key_init(c, &key, inode->i_ino, block);
-	err = ubifs_tnc_lookup(c, &key, dn);
-	if (err) {
-		if (err == -ENOENT)
-			/* Not found, so it must be a hole */
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		return err;
-	}
-
 	ubifs_assert(le64_to_cpu(dn->ch.sqnum) > ubifs_inode(inode)->creat_sqnum);
 
 	len = le32_to_cpu(dn->size);
@@ -566,6 +557,71 @@ dump:
 	return -EINVAL;
 }
 
+static int read_block(struct inode *inode, void *addr, unsigned int block,
+		      struct ubifs_data_node *dn)
+{
+	struct ubifs_info *c = inode->i_sb->s_fs_info;
+	union ubifs_key key;
+	int err;
+
+	data_key_init(c, &key, inode->i_ino, block);
+	err = ubifs_tnc_lookup(c, &key, dn);
+	if (err) {
+		if (err == -ENOENT)
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		return err;
+	}
+
+	return decompress_block(c, inode, addr, block, dn);
+}
+
+/*
+ * Read up to @count whole blocks starting at @block with one flash read of
+ * the data nodes that follow each other in the same LEB. Returns the number
+ * of blocks filled in (holes included), 0 if the first block cannot be bulk
+ * read, or a negative error code.
+ */
+static int do_bulk_read(struct ubifs_info *c, struct inode *inode,
+			struct bu_info *bu, void *addr, unsigned int block,
+			unsigned int count)
+{
+	struct ubifs_data_node *dn;
+	unsigned int i, n, blk;
+	int err;
+
+	data_key_init(c, &bu->key, inode->i_ino, block);
+	err = ubifs_tnc_get_bu_keys(c, bu);
+	if (err)
+		return err;
+	if (!bu->cnt || key_block(c, &bu->zbranch[0].key) != block)
+		return 0;
+
+	err = ubifs_tnc_bulk_read(c, bu);
+	if (err)
+		return err;
+
+	n = min_t(unsigned int, bu->blk_cnt, count);
+	for (i = 0, blk = 0; blk < n; blk++, addr += UBIFS_BLOCK_SIZE) {
+		while (i < bu->cnt &&
+		       key_block(c, &bu->zbranch[i].key) < block + blk)
+			i++;
+		if (i == bu->cnt ||
+		    key_block(c, &bu->zbranch[i].key) != block + blk) {
+			/* Not in the TNC, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+			continue;
+		}
+
+		dn = bu->buf + bu->zbranch[i].offs - bu->zbranch[0].offs;
+		err = decompress_block(c, inode, addr, block + blk, dn);
+		if (err)
+			return err;
+	}
+
+	return n;
+}
+
 static int do_readpage(struct ubifs_info *c, struct inode *inode,
 		       struct page *page, int last_block_size)
 {
@@ -683,10 +739,13 @@ int ubifs_load(char *filename, u32 addr, u32 size)
 	unsigned long inum;
 	struct inode *inode;
 	struct page page;
+	struct bu_info *bu;
+	void *buf;
 	int err = 0;
 	int i;
 	int count;
 	int last_block_size = 0;
+	unsigned int full_blocks;
 
 	c->ubi = ubi_open_volume(c->vi.ubi_num, c->vi.vol_id, UBI_READONLY);
 	/* ubifs_findfile will resolve symlinks, so we know that we get
@@ -718,23 +777,61 @@ int ubifs_load(char *filename, u32 addr, u32 size)
 	printf("Loading file '%s' to addr 0x%08x with size %d (0x%08x)...\n",
 	       filename, addr, size, size);
 
-	page.addr = (void *)addr;
+	/*
+	 * Blocks that lie completely within the requested size are bulk-read
+	 * whenever their data nodes are stored one after the other; the rest
+	 * goes through do_readpage() one block at a time.
+	 */
+	full_blocks = size >> UBIFS_BLOCK_SHIFT;
+	bu = kzalloc(sizeof(struct bu_info), GFP_NOFS);
+	if (bu) {
+		bu->buf_len = c->max_bu_buf_len;
+		bu->buf = malloc(bu->buf_len);
+		if (!bu->buf) {
+			kfree(bu);
+			bu = NULL;
+		}
+	}
+
+	buf = map_sysmem(addr, size);
+	page.addr = buf;
 	page.index = 0;
 	page.inode = inode;
-	for (i = 0; i < count; i++) {
-		/*
-		 * Make sure to not read beyond the requested size
-		 */
-		if (((i + 1) == count) && (size < inode->i_size))
-			last_block_size = size - (i * PAGE_SIZE);
+	for (i = 0; i < count; ) {
+		int n = 0;
+
+		if (bu && i < full_blocks) {
+			n = do_bulk_read(c, inode, bu, page.addr, i,
+					 full_blocks - i);
+			if (n < 0) {
+				err = n;
+				break;
+			}
+		}
 
-		err = do_readpage(c, inode, &page, last_block_size);
-		if (err)
-			break;
+		if (!n) {
+			/*
+			 * Make sure to not read beyond the requested size
+			 */
+			if (((i + 1) == count) && (size < inode->i_size))
+				last_block_size = size - (i * PAGE_SIZE);
+
+			err = do_readpage(c, inode, &page, last_block_size);
+			if (err)
+				break;
+			n = 1;
+		}
+
+		i += n;
+		page.addr += n * PAGE_SIZE;
+		page.index += n;
+	}
 
-		page.addr += PAGE_SIZE;
-		page.index++;
+	if (bu) {
+		free(bu->buf);
+		kfree(bu);
 	}
+	unmap_sysmem(buf);
 
 	if (err)
 		printf("Error reading file '%s'\n", filename);
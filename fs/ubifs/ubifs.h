@@ -1197,6 +1197,12 @@ struct ubifs_znode {
  * @cnt: number of data nodes for bulk read
  * @blk_cnt: number of data blocks including holes
  * @oef: end of file reached
+ * @cursor: level 0 znode of the last key collected, or %NULL
+ * @cursor_n: zbranch index of the last key collected in @cursor
+ *
+ * The TNC does not change while U-Boot reads a file, so sequential
+ * bulk-reads resume from @cursor instead of descending the index again.
+ * It must be %NULL for the first bulk-read of a file.
  */
 struct bu_info {
 	union ubifs_key key;
@@ -1207,6 +1213,8 @@ struct bu_info {
 	int cnt;
 	int blk_cnt;
 	int eof;
+	struct ubifs_znode *cursor;
+	int cursor_n;
 };
 
 /**
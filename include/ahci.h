@@ -36,6 +36,10 @@
 #define HOST_VERSION		0x10 /* AHCI spec. version compliancy */
 #define HOST_CAP2		0x24 /* host capabilities, extended */
 
+/* HOST_CAP bits */
+#define HOST_CAP_NCQ		(1 << 30) /* native command queuing */
+#define HOST_CAP_CLO		(1 << 24) /* command list override */
+
 /* HOST_CTL bits */
 #define HOST_RESET		(1 << 0)  /* reset controller; self-clear */
 #define HOST_IRQ_EN		(1 << 1)  /* global IRQ enable */
@@ -138,6 +142,7 @@ struct ahci_ioports {
 	struct ahci_sg		*cmd_tbl_sg;
 	u32	cmd_tbl;
 	u32	rx_fis;
+	u32	ncq_depth;	/* NCQ slots in use, 0 if not queuing */
 };
 
 struct ahci_probe_ent {
@@ -13,8 +13,13 @@
 
 /* The number of boot stage records available for the user */
 #ifndef CONFIG_BOOTSTAGE_USER_COUNT
+#ifdef CONFIG_BOOTSTAGE_INITCALL
+/* One record for each initcall of board_init_f() and board_init_r() */
+#define CONFIG_BOOTSTAGE_USER_COUNT	150
+#else
 #define CONFIG_BOOTSTAGE_USER_COUNT	20
 #endif
+#endif
 
 /* Flags for each bootstage record */
 enum bootstage_flags {
@@ -191,6 +196,8 @@ enum bootstage_id {
 	BOOTSTAGE_ID_MAIN_CPU_READY,
 
 	BOOTSTAGE_ID_ACCUM_LCD,
+	BOOTSTAGE_ID_ACCUM_DCACHE,
+	BOOTSTAGE_ID_ACCUM_CONSOLE,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
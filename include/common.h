@@ -808,6 +808,7 @@ ulong	ticks2usec    (unsigned long ticks);
 int	init_timebase (void);
 
 /* lib/gunzip.c */
+int gzip_parse_header(const unsigned char *src, unsigned long len);
 int gunzip(void *, int, unsigned char *, unsigned long *);
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 						int stoponerr, int offset);
@@ -928,6 +929,12 @@ int cpu_disable(int nr);
 int cpu_release(int nr, int argc, char * const argv[]);
 #endif
 
+/*
+ * Run fn(arg) on a secondary core, which has its caches off. Returns 0 once
+ * the core has picked the job up, or -ve if there is none to run it.
+ */
+int smp_start_secondary(void (*fn)(void *), void *arg);
+
 /* Define a null map_sysmem() if the architecture doesn't use it */
 # ifndef CONFIG_ARCH_MAP_SYSMEM
 static inline void *map_sysmem(phys_addr_t paddr, unsigned long len)
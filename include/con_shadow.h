@@ -0,0 +1,124 @@
+/*
+ * Shadow text buffer for frame buffer consoles
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __CON_SHADOW_H
+#define __CON_SHADOW_H
+
+/*
+ * A console keeps the text it shows in a shadow buffer of character
+ * cells, each holding the character in bits 7:0 and an attribute chosen
+ * by the console (for example inverse video) above that. Writing and
+ * scrolling only touch this buffer. con_shadow_render() then brings the
+ * frame buffer up to date: it applies all scrolling since the last call
+ * in one move, draws only the cells that differ from what the frame
+ * buffer is known to show, and asks the console to flush what changed
+ * once.
+ */
+
+#define CON_SHADOW_ATTR_SHIFT	8
+
+struct con_shadow_ops {
+	/**
+	 * draw() - draw a run of cells
+	 *
+	 * @priv:	console's private data
+	 * @col:	first column to draw
+	 * @row:	row to draw on
+	 * @cells:	cells to draw
+	 * @count:	number of cells
+	 */
+	void (*draw)(void *priv, int col, int row, const u16 *cells,
+		     int count);
+
+	/**
+	 * clear() - clear a run of cells to the background
+	 *
+	 * Optional: without it blank cells are drawn like any other. Trailing
+	 * blanks in a run, as left by scrolling, go through this instead.
+	 *
+	 * @priv:	console's private data
+	 * @col:	first column to clear
+	 * @row:	row to clear on
+	 * @cell:	the blank cell, giving the attribute
+	 * @count:	number of cells
+	 */
+	void (*clear)(void *priv, int col, int row, u16 cell, int count);
+
+	/**
+	 * move() - move text rows up, e.g. with memmove() or a blitter
+	 *
+	 * Optional: without it every row is drawn again after scrolling.
+	 *
+	 * @priv:	console's private data
+	 * @dst:	row to move to
+	 * @src:	row to move from (always below @dst)
+	 * @count:	number of rows
+	 */
+	void (*move)(void *priv, int dst, int src, int count);
+
+	/**
+	 * sync() - make changed rows visible, e.g. by flushing the D-cache
+	 *
+	 * Optional; called once per con_shadow_render() that changed
+	 * anything.
+	 *
+	 * @priv:	console's private data
+	 * @first:	first row changed
+	 * @last:	last row changed
+	 */
+	void (*sync)(void *priv, int first, int last);
+};
+
+struct con_shadow {
+	int cols;
+	int rows;
+	u16 attr;		/* attribute for new cells, pre-shifted */
+	u16 *text;		/* rows of text; row 0 is at index top */
+	u16 *shown;		/* what the frame buffer shows, row 0 first */
+	int top;
+	int scrolled;		/* rows scrolled since the last render */
+	int first;		/* rows written since the last render */
+	int last;
+	const struct con_shadow_ops *ops;
+	void *priv;
+};
+
+/**
+ * con_shadow_init() - set up a shadow buffer
+ *
+ * The frame buffer is taken to show a blank console, i.e. spaces with
+ * attribute 0.
+ *
+ * @con:	shadow buffer to set up
+ * @cols:	number of text columns
+ * @rows:	number of text rows
+ * @ops:	drawing operations of the console
+ * @priv:	passed to the operations
+ * @return 0 if ok, -ENOMEM if there is no memory for the buffers
+ */
+int con_shadow_init(struct con_shadow *con, int cols, int rows,
+		    const struct con_shadow_ops *ops, void *priv);
+
+/* Set a cell to a character with the current attribute */
+void con_shadow_putc(struct con_shadow *con, int col, int row, uchar c);
+
+/* Clear columns @from to @to (inclusive) of @row */
+void con_shadow_clear_line(struct con_shadow *con, int row, int from,
+			   int to);
+
+/*
+ * Clear the whole console. If @blank, the frame buffer has been cleared
+ * already; if not, the next render clears what is not blank.
+ */
+void con_shadow_clear(struct con_shadow *con, int blank);
+
+/* Scroll the text up by @count rows, clearing the rows that come in */
+void con_shadow_scroll(struct con_shadow *con, int count);
+
+/* Bring the frame buffer up to date with the text */
+void con_shadow_render(struct con_shadow *con);
+
+#endif
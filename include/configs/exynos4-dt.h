@@ -26,6 +26,8 @@
 #define CONFIG_OF_SEPARATE
 
 #define CONFIG_SYS_CACHELINE_SIZE	32
+/* The PWM timer counts microseconds, time the D-cache flush crossover */
+#define CONFIG_SYS_DCACHE_CALIBRATE
 
 /* input clock of PLL: EXYNOS4 boards have 24MHz input clock */
 #define CONFIG_SYS_CLK_FREQ		24000000
@@ -20,6 +20,7 @@
 
 #define CONFIG_BOOTSTAGE
 #define CONFIG_BOOTSTAGE_REPORT
+#define CONFIG_BOOTSTAGE_INITCALL
 #define CONFIG_DM
 #define CONFIG_CMD_DEMO
 #define CONFIG_CMD_DM
@@ -67,6 +68,9 @@
  * Size of malloc() pool, although we don't actually use this yet.
  */
 #define CONFIG_SYS_MALLOC_LEN		(32 << 20)	/* 32MB  */
+#define CONFIG_SYS_MALLOC_POOLS		(64 << 10)
+#define CONFIG_SYS_MALLOC_STATS
+#define CONFIG_SYS_MALLOC_STATS_CALLERS	16
 
 #define CONFIG_SYS_HUSH_PARSER
 #define CONFIG_SYS_LONGHELP			/* #undef to save memory */
@@ -97,6 +101,30 @@
 #define CONFIG_SPI_FLASH_STMICRO
 #define CONFIG_SPI_FLASH_WINBOND
 
+/* NAND */
+#define CONFIG_NAND_SANDBOX
+#define CONFIG_CMD_NAND
+#define CONFIG_SYS_MAX_NAND_DEVICE	1
+#define CONFIG_SYS_NAND_BASE		0
+#define CONFIG_SYS_NAND_ONFI_DETECTION
+#define CONFIG_BCH
+#define CONFIG_NAND_ECC_BCH
+#define CONFIG_MTD_DEVICE
+#define CONFIG_MTD_PARTITIONS
+#define CONFIG_CMD_MTDPARTS
+#define MTDIDS_DEFAULT			"nand0=nand0"
+#define MTDPARTS_DEFAULT		"mtdparts=nand0:-(ubi)"
+#define CONFIG_CMD_UBI
+#define CONFIG_MTD_UBI_FASTMAP
+#define CONFIG_CMD_UBIFS
+#define CONFIG_CMD_JFFS2
+#define CONFIG_JFFS2_NAND
+#define CONFIG_JFFS2_SUMMARY
+#define CONFIG_RBTREE
+#define CONFIG_CMD_TIME
+#define CONFIG_CMD_MEMBENCH
+#define CONFIG_CMD_DRAMTEST
+
 /* Memory things - we don't really want a memory test */
 #define CONFIG_SYS_LOAD_ADDR		0x00000000
 #define CONFIG_SYS_MEMTEST_START	0x00100000
@@ -152,10 +180,19 @@
 #define CONFIG_SANDBOX_SDL
 #define CONFIG_LCD
 #define CONFIG_VIDEO_SANDBOX_SDL
+#define CONFIG_CONSOLE_SHADOW
 #define CONFIG_CMD_BMP
+#define CONFIG_SPLASH_RAW
 #define CONFIG_BOARD_EARLY_INIT_F
 #define CONFIG_CONSOLE_MUX
 #define CONFIG_SYS_CONSOLE_IS_IN_ENV
+
+/* Keep the console output, including that from before relocation */
+#define CONFIG_PRE_CONSOLE_BUFFER
+#define CONFIG_PRE_CON_BUF_ADDR		0x000f0000
+#define CONFIG_PRE_CON_BUF_SZ		4096
+#define CONFIG_RAMLOG
+#define CONFIG_RAMLOG_SIZE		(64 << 10)
 #define LCD_BPP			LCD_COLOR16
 
 #define CONFIG_EXTRA_ENV_SETTINGS	"stdin=serial,cros-ec-keyb\0" \
@@ -88,6 +88,10 @@
 #define LCD_BPP				LCD_COLOR16
 #define CONFIG_SYS_WHITE_ON_BLACK
 #define CONFIG_CONSOLE_SCROLL_LINES	10
+#ifndef CONFIG_SPL_BUILD
+/* Map the frame buffer in pages at both ends, not the memory around it */
+#define CONFIG_SYS_MMU_L2_TABLES	2
+#endif
 
 /* NAND support */
 #define CONFIG_CMD_NAND
@@ -27,6 +27,9 @@
 
 #define CONFIG_SYS_TEXT_BASE		0x4a000000
 
+/* timer_get_us() counts microseconds, time the D-cache flush crossover */
+#define CONFIG_SYS_DCACHE_CALIBRATE
+
 /*
  * Display CPU and Board information
  */
@@ -44,6 +47,9 @@
 #define CONFIG_SYS_NS16550_COM3		SUNXI_UART2_BASE
 #define CONFIG_SYS_NS16550_COM4		SUNXI_UART3_BASE
 #define CONFIG_SYS_NS16550_COM5		SUNXI_R_UART_BASE
+/* Buffer console output and send it in bursts to the 64-byte FIFO */
+#define CONFIG_SYS_NS16550_TX_BUFFER	4096
+#define CONFIG_SYS_NS16550_FIFO_SIZE	64
 
 /* DRAM Base */
 #define CONFIG_SYS_SDRAM_BASE		0x40000000
@@ -421,6 +427,10 @@
 #define CONFIG_MISC_INIT_R
 
 #ifndef CONFIG_SPL_BUILD
+/* Every sunxi core (Cortex-A7/A8) has NEON */
+#define CONFIG_USE_ARCH_MEMCPY_NEON
+#define CONFIG_CMD_MEMBENCH
+#define CONFIG_CMD_DRAMTEST
 #include <config_distro_defaults.h>
 #endif
 
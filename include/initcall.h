@@ -4,6 +4,55 @@
  * SPDX-License-Identifier:	GPL-2.0+
  */
 
+#ifndef __INITCALL_H
+#define __INITCALL_H
+
+#include <linker_lists.h>
+
 typedef int (*init_fnc_t)(void);
 
 int initcall_run_list(init_fnc_t init_sequence[]);
+
+/**
+ * struct initcall_deferred - An initcall run on first use of a subsystem
+ *
+ * @subsys:	Subsystem name, as passed to initcall_run_deferred()
+ * @func:	Initcall to run
+ * @done:	Non-zero once the initcall has been run
+ */
+struct initcall_deferred {
+	const char *subsys;
+	init_fnc_t func;
+	int done;
+};
+
+#if defined(CONFIG_DEFERRED_INITCALLS) && !defined(CONFIG_SPL_BUILD)
+/*
+ * Declare @_func as an initcall of subsystem @_subsys that is not in the
+ * init sequence but run by the first initcall_run_deferred(@_subsys).
+ */
+#define INITCALL_DEFERRED(_subsys, _func)				\
+	ll_entry_declare(struct initcall_deferred, _func,		\
+			 initcall_deferred) = {				\
+		.subsys = #_subsys,					\
+		.func = _func,						\
+	}
+
+/**
+ * initcall_run_deferred() - Bring up a subsystem on its first use
+ *
+ * Runs the deferred initcalls of @subsys which have not run yet. Entry
+ * points of a subsystem call this before touching its devices.
+ *
+ * @subsys:	Subsystem name, e.g. "mmc"
+ * @return 0 if OK, -1 if an initcall failed
+ */
+int initcall_run_deferred(const char *subsys);
+#else
+static inline int initcall_run_deferred(const char *subsys)
+{
+	return 0;
+}
+#endif
+
+#endif
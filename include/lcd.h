@@ -267,6 +267,7 @@ void	lcd_puts(const char *s);
 void	lcd_printf(const char *fmt, ...);
 void	lcd_clear(void);
 int	lcd_display_bitmap(ulong bmp_image, int x, int y);
+int	lcd_display_splash_raw(ulong addr, int x, int y);
 
 /**
  * Get the width of the LCD in pixels
@@ -238,6 +238,12 @@ struct mtd_info {
 
 	struct module *owner;
 	int usecount;
+
+	/*
+	 * Bumped on every write, erase or bad block marking, so readers
+	 * caching flash contents (e.g. JFFS2) can tell that it changed.
+	 */
+	u32 write_gen;
 };
 
 int mtd_erase(struct mtd_info *mtd, struct erase_info *instr);
@@ -258,6 +264,7 @@ static inline int mtd_write_oob(struct mtd_info *mtd, loff_t to,
 		return -EOPNOTSUPP;
 	if (!(mtd->flags & MTD_WRITEABLE))
 		return -EROFS;
+	mtd->write_gen++;
 	return mtd->_write_oob(mtd, to, ops);
 }
 
@@ -94,6 +94,8 @@ extern void nand_wait_ready(struct mtd_info *mtd);
 
 /* Extended commands for large page devices */
 #define NAND_CMD_READSTART	0x30
+#define NAND_CMD_READCACHESEQ	0x31
+#define NAND_CMD_READCACHEEND	0x3f
 #define NAND_CMD_RNDOUTSTART	0xE0
 #define NAND_CMD_CACHEDPROG	0x15
 
@@ -191,6 +193,12 @@ typedef enum {
 /* Device supports subpage reads */
 #define NAND_SUBPAGE_READ       0x00001000
 
+/*
+ * Device supports the ONFI read cache commands, so the next page can be
+ * loaded from the array while the current one is transferred
+ */
+#define NAND_CACHERD		0x00002000
+
 /* Options valid for Samsung large page devices */
 #define NAND_SAMSUNG_LP_OPTIONS \
 	(NAND_NO_PADDING | NAND_CACHEPRG | NAND_COPYBACK)
@@ -200,6 +208,7 @@ typedef enum {
 #define NAND_HAS_CACHEPROG(chip) ((chip->options & NAND_CACHEPRG))
 #define NAND_HAS_COPYBACK(chip) ((chip->options & NAND_COPYBACK))
 #define NAND_HAS_SUBPAGE_READ(chip) ((chip->options & NAND_SUBPAGE_READ))
+#define NAND_HAS_CACHEREAD(chip) ((chip->options & NAND_CACHERD))
 
 /* Non chip related options */
 /* This option skips the bbt scan during initialization. */
@@ -304,6 +313,9 @@ struct nand_onfi_params {
 
 #define ONFI_CRC_BASE	0x4F4E
 
+/* ONFI optional commands (opt_cmd) */
+#define ONFI_OPT_CMD_READ_CACHE	(1 << 1)
+
 /**
  * struct nand_hw_control - Control structure for hardware controller (e.g ECC generator) shared among independent devices
  * @lock:               protection lock
@@ -938,6 +938,42 @@ extern ulong mem_malloc_brk;
 
 void mem_malloc_init(ulong start, ulong size);
 
+#if defined(CONFIG_SYS_MALLOC_POOLS) || defined(CONFIG_SYS_MALLOC_STATS)
+/*
+ * malloc() and friends come from common/malloc_front.c, which hands out
+ * small objects from slab pools and keeps statistics. It passes the rest
+ * on to dlmalloc under the names below.
+ */
+#define MALLOC_FRONT_END
+
+void *dlmalloc(size_t bytes);
+void dlfree(void *mem);
+void *dlrealloc(void *oldmem, size_t bytes);
+void *dlmemalign(size_t alignment, size_t bytes);
+void *dlcalloc(size_t n, size_t elem_size);
+size_t dlmalloc_usable_size(void *mem);
+#endif
+
+#ifdef CONFIG_SYS_MALLOC_POOLS
+/* Set up the slab pools, called by mem_malloc_init() */
+void malloc_pool_init(void);
+#endif
+
+#ifdef CONFIG_SYS_MALLOC_STATS
+struct malloc_heap_info {
+	ulong free;	/* free bytes, including what sbrk() can still add */
+	ulong largest;	/* largest free block */
+	ulong blocks;	/* number of free blocks */
+	ulong peak;	/* most of the malloc area the heap has taken */
+};
+
+/* Get the free space of the dlmalloc heap */
+void malloc_heap_info(struct malloc_heap_info *info);
+
+/* Print heap usage, pool usage and the biggest callers */
+void malloc_print_stats(void);
+#endif
+
 #ifdef __cplusplus
 };  /* end of extern "C" */
 #endif
@@ -437,7 +437,7 @@ extern int		NetRestartWrap;		/* Tried all network devices */
 
 enum proto_t {
 	BOOTP, RARP, ARP, TFTPGET, DHCP, PING, DNS, NFS, CDP, NETCONS, SNTP,
-	TFTPSRV, TFTPPUT, LINKLOCAL
+	TFTPSRV, TFTPPUT, LINKLOCAL, TFTPMULTI
 };
 
 /* from net/net.c */
@@ -477,6 +477,17 @@ extern int NetTimeOffset;			/* offset time from UTC */
 extern IPaddr_t Mcast_addr;
 #endif
 
+#if defined(CONFIG_CMD_TFTPMULTI)
+#ifndef CONFIG_TFTP_MAX_SESSIONS
+#define CONFIG_TFTP_MAX_SESSIONS	4
+#endif
+
+/* Files fetched by the next NetLoop(TFTPMULTI), from net/tftp.c */
+void tftp_multi_reset(void);
+int tftp_multi_add(ulong addr, const char *name);	/* [ip:]file */
+ulong tftp_multi_size(int idx);
+#endif
+
 /* Initialize the network adapter */
 extern void net_init(void);
 extern int NetLoop(enum proto_t);
@@ -554,6 +565,16 @@ int nc_input_packet(uchar *pkt, IPaddr_t src_ip, unsigned dest_port,
 	unsigned src_port, unsigned len);
 #endif
 
+#if defined(CONFIG_NETCONSOLE_BUFFERED_OUTPUT) && !defined(CONFIG_SPL_BUILD)
+/* Send any console output the netconsole is still holding back */
+void nc_flush(void);
+/* Send held back output once it is older than CONFIG_NETCONSOLE_FLUSH_MS */
+void nc_poll(void);
+#else
+static inline void nc_flush(void) {}
+static inline void nc_poll(void) {}
+#endif
+
 static inline __attribute__((always_inline)) int eth_is_on_demand_init(void)
 {
 #ifdef CONFIG_NETCONSOLE
@@ -38,6 +38,8 @@ typedef struct block_dev_desc {
 				       lbaint_t start,
 				       lbaint_t blkcnt);
 	void		*priv;		/* driver private struct pointer */
+	unsigned char	any_align;	/* block_read/write take buffers at
+					   any address, no need to bounce */
 }block_dev_desc_t;
 
 #define BLOCK_CNT(size, block_dev_desc) (PAD_COUNT(size, block_dev_desc->blksz))
@@ -0,0 +1,42 @@
+/*
+ * RAM log of console output
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __RAMLOG_H
+#define __RAMLOG_H
+
+#define RAMLOG_MAGIC	0x474f4c55	/* "ULOG" */
+
+/*
+ * Layout of the log at the top of RAM, as handed to the OS. Output is
+ * written to buf[head % size]; once head passes size, the oldest output
+ * is overwritten.
+ */
+struct ramlog_hdr {
+	uint32_t magic;
+	uint32_t size;		/* size of buf[] */
+	uint32_t head;		/* bytes written in total */
+	uint32_t reserved;
+	char buf[0];
+};
+
+#ifdef CONFIG_RAMLOG
+ulong ramlog_base(void);
+void ramlog_init(void);
+void ramlog_putc(const char c);
+void ramlog_puts(const char *s);
+
+/* Print how much output silent mode has hidden since the last summary */
+void ramlog_summary(void);
+
+/* Reserve the log in a device tree and add a /u-boot-log node for it */
+int ramlog_fdt_add(void *blob);
+#else
+static inline void ramlog_putc(const char c) {}
+static inline void ramlog_puts(const char *s) {}
+static inline void ramlog_summary(void) {}
+#endif
+
+#endif
@@ -22,6 +22,19 @@ struct serial_device {
 
 void default_serial_puts(const char *s);
 
+/*
+ * With buffered output (CONFIG_SYS_NS16550_TX_BUFFER), serial_tx_poll()
+ * moves what it can to the UART without waiting and serial_tx_flush()
+ * waits until everything has been sent.
+ */
+#if defined(CONFIG_SYS_NS16550_TX_BUFFER) && !defined(CONFIG_SPL_BUILD)
+void serial_tx_poll(void);
+void serial_tx_flush(void);
+#else
+static inline void serial_tx_poll(void) {}
+static inline void serial_tx_flush(void) {}
+#endif
+
 extern struct serial_device serial_smc_device;
 extern struct serial_device serial_scc_device;
 extern struct serial_device *default_serial_console(void);
@@ -31,6 +31,8 @@
 #define SPI_XFER_MMAP_END	0x10	/* Memory Mapped End */
 #define SPI_XFER_ONCE		(SPI_XFER_BEGIN | SPI_XFER_END)
 #define SPI_XFER_U_PAGE		(1 << 5)
+#define SPI_XFER_DUAL		(1 << 6)	/* Transfer on 2 data lines */
+#define SPI_XFER_QUAD		(1 << 7)	/* Transfer on 4 data lines */
 
 /* SPI TX operation modes */
 #define SPI_OPM_TX_QPP		1 << 0
@@ -61,7 +63,10 @@
  *
  * @bus:		ID of the bus that the slave is attached to.
  * @cs:			ID of the chip select connected to the slave.
- * @op_mode_rx:		SPI RX operation mode.
+ * @op_mode_rx:		SPI RX operation modes (SPI_OPM_RX_*) supported by
+ *			the controller, set up by spi_setup_slave(). For
+ *			the dual and quad modes, spi_xfer() must honour
+ *			SPI_XFER_DUAL and SPI_XFER_QUAD.
  * @op_mode_tx:		SPI TX operation mode.
  * @wordlen:		Size of SPI word in number of bits
  * @max_write_size:	If non-zero, the maximum number of bytes which can
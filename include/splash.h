@@ -33,4 +33,23 @@ static inline void splash_get_pos(int *x, int *y) { }
 
 #define BMP_ALIGN_CENTER	0x7FFF
 
+/*
+ * Raw splash image, made from a BMP by tools/bmp_splash. The header is
+ * followed by the pixels, top row first and without padding, exactly as
+ * the frame buffer holds them, so displaying the image is a plain copy.
+ * The whole file may be compressed with gzip, in which case it is
+ * inflated straight into the frame buffer.
+ */
+#define SPLASH_RAW_MAGIC	"USPL"
+#define SPLASH_RAW_BIG_ENDIAN	(1 << 0)	/* 16/32-bit pixels are BE */
+
+struct splash_raw_header {
+	uint8_t magic[4];
+	uint16_t width;		/* little endian, as are all fields */
+	uint16_t height;
+	uint8_t bpp;		/* 16 (RGB565) or 32 (XRGB8888) */
+	uint8_t flags;
+	uint16_t reserved;
+} __attribute__ ((packed));
+
 #endif
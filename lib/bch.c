@@ -46,7 +46,7 @@
  * remainder lookup tables.
  *
  * The final stage of decoding involves the following internal steps:
- * a. Syndrome computation
+ * a. Syndrome computation (8 ecc bits at a time, using t lookup tables)
  * b. Error locator polynomial computation using Berlekamp-Massey algorithm
  * c. Error locator root finding (by far the most expensive step)
  *
@@ -334,10 +334,12 @@ static inline int a_ilog(struct bch_control *bch, unsigned int x)
 static void compute_syndromes(struct bch_control *bch, uint32_t *ecc,
 			      unsigned int *syn)
 {
-	int i, j, s;
-	unsigned int m;
+	int j, k, s;
+	unsigned int m, b;
 	uint32_t poly;
+	const uint16_t *tab;
 	const int t = GF_T(bch);
+	const int n = GF_N(bch);
 
 	s = bch->ecc_bits;
 
@@ -347,16 +349,24 @@ static void compute_syndromes(struct bch_control *bch, uint32_t *ecc,
 		ecc[s/32] &= ~((1u << (32-m))-1);
 	memset(syn, 0, 2*t*sizeof(*syn));
 
-	/* compute v(a^j) for j=1 .. 2t-1 */
+	/*
+	 * compute v(a^j) for j=1 .. 2t-1, one byte at a time: syn_tab gives
+	 * the log of the byte's contribution at bit offset 0, which is then
+	 * shifted to offset s+k (+n keeps the exponent positive when the
+	 * byte straddles the cleared bits of the last word)
+	 */
 	do {
 		poly = *ecc++;
 		s -= 32;
-		while (poly) {
-			i = deg(poly);
-			for (j = 0; j < 2*t; j += 2)
-				syn[j] ^= a_pow(bch, (j+1)*(i+s));
-
-			poly ^= (1 << i);
+		for (k = 0; poly; k += 8, poly >>= 8) {
+			b = poly & 0xff;
+			if (!b)
+				continue;
+			tab = &bch->syn_tab[b];
+			for (j = 0; j < t; j++, tab += 256)
+				if (*tab != 0xffff)
+					syn[2*j] ^= a_pow(bch, *tab+
+							  (2*j+1)*(s+k+n));
 		}
 	} while (s > 0);
 
@@ -1008,16 +1018,22 @@ int decode_bch(struct bch_control *bch, const uint8_t *data, unsigned int len,
 		if (recv_ecc) {
 			load_ecc8(bch, bch->ecc_buf2, recv_ecc);
 			/* XOR received and calculated ecc */
-			for (i = 0, sum = 0; i < (int)ecc_words; i++) {
+			for (i = 0; i < (int)ecc_words; i++)
 				bch->ecc_buf[i] ^= bch->ecc_buf2[i];
-				sum |= bch->ecc_buf[i];
-			}
-			if (!sum)
-				/* no error found */
-				return 0;
 		}
+		for (i = 0, sum = 0; i < (int)ecc_words; i++)
+			sum |= bch->ecc_buf[i];
+		if (!sum)
+			/* no error found */
+			return 0;
 		compute_syndromes(bch, bch->ecc_buf, bch->syn);
 		syn = bch->syn;
+	} else {
+		for (i = 0, sum = 0; i < 2*(int)GF_T(bch); i++)
+			sum |= syn[i];
+		if (!sum)
+			/* no error found */
+			return 0;
 	}
 
 	err = compute_error_locator_polynomial(bch, syn);
@@ -1103,6 +1119,28 @@ static void build_mod8_tables(struct bch_control *bch, const uint32_t *g)
 	}
 }
 
+/*
+ * build syndrome lookup tables: for each odd syndrome index 2j+1 and each
+ * byte value b, the log of sum(a^((2j+1)*i)) over the bits i set in b, or
+ * 0xffff if that sum is zero
+ */
+static void build_syn_tables(struct bch_control *bch)
+{
+	unsigned int i, j, b, w[256];
+	uint16_t *tab = bch->syn_tab;
+
+	for (j = 0; j < GF_T(bch); j++, tab += 256) {
+		w[0] = 0;
+		for (b = 1; b < 256; b++) {
+			/* add the lowest set bit to the byte without it */
+			i = ffs(b)-1;
+			w[b] = w[b & (b-1)] ^ a_pow(bch, (2*j+1)*i);
+		}
+		for (b = 0; b < 256; b++)
+			tab[b] = w[b] ? a_log(bch, w[b]) : 0xffff;
+	}
+}
+
 /*
  * build a base for factoring degree 2 polynomials
  */
@@ -1299,6 +1337,7 @@ struct bch_control *init_bch(int m, int t, unsigned int prim_poly)
 	bch->ecc_buf2  = bch_alloc(words*sizeof(*bch->ecc_buf2), &err);
 	bch->xi_tab    = bch_alloc(m*sizeof(*bch->xi_tab), &err);
 	bch->syn       = bch_alloc(2*t*sizeof(*bch->syn), &err);
+	bch->syn_tab   = bch_alloc(t*256*sizeof(*bch->syn_tab), &err);
 	bch->cache     = bch_alloc(2*t*sizeof(*bch->cache), &err);
 	bch->elp       = bch_alloc((t+1)*sizeof(struct gf_poly_deg1), &err);
 
@@ -1320,6 +1359,8 @@ struct bch_control *init_bch(int m, int t, unsigned int prim_poly)
 	build_mod8_tables(bch, genpoly);
 	kfree(genpoly);
 
+	build_syn_tables(bch);
+
 	err = build_deg2_base(bch);
 	if (err)
 		goto fail;
@@ -1347,6 +1388,7 @@ void free_bch(struct bch_control *bch)
 		kfree(bch->ecc_buf2);
 		kfree(bch->xi_tab);
 		kfree(bch->syn);
+		kfree(bch->syn_tab);
 		kfree(bch->cache);
 		kfree(bch->elp);
 
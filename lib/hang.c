@@ -10,6 +10,8 @@
 
 #include <common.h>
 #include <bootstage.h>
+#include <net.h>
+#include <serial.h>
 
 /**
  * hang - stop processing by staying in an endless loop
@@ -24,6 +26,8 @@ void hang(void)
 #if !defined(CONFIG_SPL_BUILD) || (defined(CONFIG_SPL_LIBCOMMON_SUPPORT) && \
 		defined(CONFIG_SPL_SERIAL_SUPPORT))
 	puts("### ERROR ### Please RESET the board ###\n");
+	serial_tx_flush();
+	nc_flush();
 #endif
 	bootstage_error(BOOTSTAGE_ID_NEED_RESET);
 	for (;;)
@@ -7,6 +7,38 @@
 #include <common.h>
 #include <initcall.h>
 
+DECLARE_GLOBAL_DATA_PTR;
+
+#ifdef CONFIG_BOOTSTAGE_INITCALL
+/* Name an initcall in its bootstage record, if we have a symbol table */
+static const char *initcall_name(init_fnc_t func)
+{
+#ifdef CONFIG_KALLSYMS
+	unsigned long addr = (unsigned long)func;
+	unsigned long base;
+
+	/* The symbol table has link addresses */
+	if ((gd->flags & GD_FLG_RELOC) &&
+	    (unsigned long)initcall_name - gd->relocaddr < gd->mon_len)
+		addr -= gd->reloc_off;
+
+	return symbol_lookup(addr, &base);
+#else
+	return NULL;
+#endif
+}
+
+/* Record the end of an initcall, so the report shows how long it took */
+static void initcall_mark(init_fnc_t func)
+{
+	bootstage_mark_name(BOOTSTAGE_ID_ALLOC, initcall_name(func));
+}
+#else
+static inline void initcall_mark(init_fnc_t func)
+{
+}
+#endif
+
 int initcall_run_list(init_fnc_t init_sequence[])
 {
 	init_fnc_t *init_fnc_ptr;
@@ -18,6 +50,45 @@ int initcall_run_list(init_fnc_t init_sequence[])
 			      init_sequence, *init_fnc_ptr);
 			return -1;
 		}
+		initcall_mark(*init_fnc_ptr);
 	}
 	return 0;
 }
+
+#if defined(CONFIG_DEFERRED_INITCALLS) && !defined(CONFIG_SPL_BUILD)
+int initcall_run_deferred(const char *subsys)
+{
+	struct initcall_deferred *start =
+		ll_entry_start(struct initcall_deferred, initcall_deferred);
+	const int count =
+		ll_entry_count(struct initcall_deferred, initcall_deferred);
+	struct initcall_deferred *call;
+	init_fnc_t func;
+	const char *name;
+	int ret = 0;
+
+	for (call = start; call != start + count; call++) {
+		if (call->done)
+			continue;
+		func = call->func;
+		name = call->subsys;
+#ifdef CONFIG_NEEDS_MANUAL_RELOC
+		func = (init_fnc_t)((ulong)func + gd->reloc_off);
+		name += gd->reloc_off;
+#endif
+		if (strcmp(name, subsys))
+			continue;
+
+		/* Once only, even if it fails or its subsystem calls back */
+		call->done = 1;
+		debug("deferred initcall: %p (%s)\n", func, name);
+		if (func()) {
+			debug("deferred initcall %p failed\n", func);
+			ret = -1;
+		}
+		initcall_mark(func);
+	}
+
+	return ret;
+}
+#endif
@@ -6,6 +6,7 @@
  */
 
 #include <common.h>
+#include <serial.h>
 #include <watchdog.h>
 #include <div64.h>
 #include <asm/io.h>
@@ -102,6 +103,7 @@ void udelay(unsigned long usec)
 
 	do {
 		WATCHDOG_RESET();
+		serial_tx_poll();
 		kv = usec > CONFIG_WD_PERIOD ? CONFIG_WD_PERIOD : usec;
 		__udelay (kv);
 		usec -= kv;
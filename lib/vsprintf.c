@@ -23,6 +23,8 @@
 #endif
 
 #include <div64.h>
+#include <net.h>
+#include <serial.h>
 #define noinline __attribute__((noinline))
 
 /* some reluctance to put this into a new limits.h, so it is here */
@@ -840,6 +842,8 @@ void panic(const char *fmt, ...)
 	vprintf(fmt, args);
 	putc('\n');
 	va_end(args);
+	serial_tx_flush();
+	nc_flush();
 #if defined(CONFIG_PANIC_HANG)
 	hang();
 #else
@@ -26,6 +26,29 @@
 # define ARP_TIMEOUT_COUNT	CONFIG_NET_RETRY_COUNT
 #endif
 
+#ifdef CONFIG_NET_ARP_CACHE
+#ifndef CONFIG_NET_ARP_CACHE_SIZE
+# define ARP_CACHE_SIZE		4
+#else
+# define ARP_CACHE_SIZE		CONFIG_NET_ARP_CACHE_SIZE
+#endif
+
+#ifndef CONFIG_NET_ARP_CACHE_TIMEOUT
+/* Milliseconds a resolved address is considered valid */
+# define ARP_CACHE_TIMEOUT	30000UL
+#else
+# define ARP_CACHE_TIMEOUT	CONFIG_NET_ARP_CACHE_TIMEOUT
+#endif
+
+struct arp_cache_entry {
+	IPaddr_t	ip;		/* 0 = unused slot */
+	uchar		ether[6];
+	ulong		stamp;		/* get_timer() when learned */
+};
+
+static struct arp_cache_entry arp_cache[ARP_CACHE_SIZE];
+#endif
+
 IPaddr_t	NetArpWaitPacketIP;
 static IPaddr_t	NetArpWaitReplyIP;
 /* MAC address of waiting packet's destination */
@@ -78,23 +101,89 @@ void arp_raw_request(IPaddr_t sourceIP, const uchar *targetEther,
 	NetSendPacket(NetArpTxPacket, eth_hdr_size + ARP_HDR_SIZE);
 }
 
+/*
+ * Return the address whose MAC we have to resolve in order to reach
+ * @ip: the host itself when on our subnet, the gateway otherwise.
+ */
+static IPaddr_t arp_next_hop(IPaddr_t ip)
+{
+	if ((ip & NetOurSubnetMask) == (NetOurIP & NetOurSubnetMask))
+		return ip;
+	if (NetOurGatewayIP == 0)
+		return ip;
+	return NetOurGatewayIP;
+}
+
 void ArpRequest(void)
 {
 	if ((NetArpWaitPacketIP & NetOurSubnetMask) !=
-	    (NetOurIP & NetOurSubnetMask)) {
-		if (NetOurGatewayIP == 0) {
-			puts("## Warning: gatewayip needed but not set\n");
-			NetArpWaitReplyIP = NetArpWaitPacketIP;
-		} else {
-			NetArpWaitReplyIP = NetOurGatewayIP;
+	    (NetOurIP & NetOurSubnetMask) && NetOurGatewayIP == 0)
+		puts("## Warning: gatewayip needed but not set\n");
+
+	NetArpWaitReplyIP = arp_next_hop(NetArpWaitPacketIP);
+
+	arp_raw_request(NetOurIP, NetEtherNullAddr, NetArpWaitReplyIP);
+}
+
+#ifdef CONFIG_NET_ARP_CACHE
+void arp_cache_flush(void)
+{
+	memset(arp_cache, 0, sizeof(arp_cache));
+}
+
+void arp_cache_add(IPaddr_t ip, const uchar *ether)
+{
+	struct arp_cache_entry *e, *victim = &arp_cache[0];
+	ulong now = get_timer(0);
+	int i;
+
+	if (ip == 0 || ip == 0xFFFFFFFF || is_broadcast_ether_addr(ether))
+		return;
+
+	/* refresh an existing entry, or replace the oldest one */
+	for (i = 0; i < ARP_CACHE_SIZE; i++) {
+		e = &arp_cache[i];
+		if (e->ip == ip) {
+			victim = e;
+			break;
 		}
-	} else {
-		NetArpWaitReplyIP = NetArpWaitPacketIP;
+		if (!e->ip)
+			victim = e;
+		else if (victim->ip && now - e->stamp > now - victim->stamp)
+			victim = e;
 	}
 
-	arp_raw_request(NetOurIP, NetEtherNullAddr, NetArpWaitReplyIP);
+	debug_cond(DEBUG_DEV_PKT, "ARP cache: %pI4 is at %pM\n", &ip, ether);
+	victim->ip = ip;
+	memcpy(victim->ether, ether, ARP_HLEN);
+	victim->stamp = now;
 }
 
+int arp_cache_lookup(IPaddr_t ip, uchar *ether)
+{
+	struct arp_cache_entry *e;
+	IPaddr_t hop = arp_next_hop(ip);
+	int i;
+
+	for (i = 0; i < ARP_CACHE_SIZE; i++) {
+		e = &arp_cache[i];
+		if (!e->ip || e->ip != hop)
+			continue;
+		if (get_timer(e->stamp) > ARP_CACHE_TIMEOUT) {
+			/* stale, let the caller ask the network again */
+			e->ip = 0;
+			return -ENOENT;
+		}
+		debug_cond(DEBUG_DEV_PKT, "ARP cache hit: %pI4 at %pM\n",
+			   &hop, e->ether);
+		memcpy(ether, e->ether, ARP_HLEN);
+		return 0;
+	}
+
+	return -ENOENT;
+}
+#endif
+
 void ArpTimeoutCheck(void)
 {
 	ulong t;
@@ -159,6 +248,9 @@ void ArpReceive(struct ethernet_hdr *et, struct ip_udp_hdr *ip, int len)
 
 	switch (ntohs(arp->ar_op)) {
 	case ARPOP_REQUEST:
+		/* the sender just told us its address, remember it */
+		arp_cache_add(NetReadIP(&arp->ar_spa), &arp->ar_sha);
+
 		/* reply with our IP address */
 		debug_cond(DEBUG_DEV_PKT, "Got ARP REQUEST, return our IP\n");
 		pkt = (uchar *)et;
@@ -207,6 +299,8 @@ void ArpReceive(struct ethernet_hdr *et, struct ip_udp_hdr *ip, int len)
 				"Got ARP REPLY, set eth addr (%pM)\n",
 				arp->ar_data);
 
+			arp_cache_add(reply_ip_addr, &arp->ar_sha);
+
 			/* save address for later use */
 			if (NetArpWaitPacketMAC != NULL)
 				memcpy(NetArpWaitPacketMAC,
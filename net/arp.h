@@ -12,6 +12,7 @@
 #define __ARP_H__
 
 #include <common.h>
+#include <errno.h>
 
 extern IPaddr_t	NetArpWaitPacketIP;
 /* MAC address of waiting packet's destination */
@@ -27,4 +28,28 @@ void arp_raw_request(IPaddr_t sourceIP, const uchar *targetEther,
 void ArpTimeoutCheck(void);
 void ArpReceive(struct ethernet_hdr *et, struct ip_udp_hdr *ip, int len);
 
+#ifdef CONFIG_NET_ARP_CACHE
+/**
+ * arp_cache_lookup() - Find the MAC address used to reach an IP address
+ *
+ * The next hop (gateway or host) is derived from our subnet settings, so
+ * this can be called with the final destination address.
+ *
+ * @ip:		Destination IP address
+ * @ether:	Filled in with the MAC address on success
+ * @return 0 if a valid entry was found, -ENOENT otherwise
+ */
+int arp_cache_lookup(IPaddr_t ip, uchar *ether);
+void arp_cache_add(IPaddr_t ip, const uchar *ether);
+void arp_cache_flush(void);
+#else
+static inline int arp_cache_lookup(IPaddr_t ip, uchar *ether)
+{
+	return -ENOENT;
+}
+
+static inline void arp_cache_add(IPaddr_t ip, const uchar *ether) {}
+static inline void arp_cache_flush(void) {}
+#endif
+
 #endif /* __ARP_H__ */
@@ -47,6 +47,23 @@ static IPaddr_t NetDHCPServerIP;
 static void DhcpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 			unsigned len);
 
+#ifdef CONFIG_DHCP_LEASE_CACHE
+/* Parameters of the last lease, so later commands can skip discovery */
+struct dhcp_lease {
+	IPaddr_t	our_ip;
+	IPaddr_t	server_ip;
+	IPaddr_t	gateway_ip;
+	IPaddr_t	subnet_mask;
+	IPaddr_t	dns_ip;
+	uchar		our_ether[6];
+	uchar		server_ether[6];
+	char		bootfile[128];
+	ulong		start;		/* get_timer() when the ACK arrived */
+	ulong		seconds;	/* lease duration, 0 = no lease */
+};
+static struct dhcp_lease dhcp_lease;
+#endif
+
 /* For Debug */
 #if 0
 static char *dhcpmsg2str(int type)
@@ -878,6 +895,72 @@ static void DhcpSendRequestPkt(struct Bootp_t *bp_offer)
 	NetSendPacket(NetTxPacket, pktlen);
 }
 
+#ifdef CONFIG_DHCP_LEASE_CACHE
+static void dhcp_lease_save(struct Bootp_t *bp)
+{
+	struct dhcp_lease *l = &dhcp_lease;
+
+	l->seconds = ntohl(dhcp_leasetime);
+	l->start = get_timer(0);
+	l->our_ip = NetOurIP;
+	l->server_ip = NetServerIP;
+	l->gateway_ip = NetOurGatewayIP;
+	l->subnet_mask = NetOurSubnetMask;
+	l->dns_ip = NetOurDNSIP;
+	memcpy(l->our_ether, NetOurEther, 6);
+	memcpy(l->server_ether, NetServerEther, 6);
+	copy_filename(l->bootfile, bp->bp_file, sizeof(l->bootfile));
+}
+
+/*
+ * Reuse the last lease while we are before its renewal time (T1, half
+ * the lease) on the same interface. Returns 1 if the lease was reused.
+ */
+static int dhcp_lease_reuse(void)
+{
+	struct dhcp_lease *l = &dhcp_lease;
+	ulong elapsed;
+
+	if (!l->seconds || getenv_yesno("dhcpreuse") == 0)
+		return 0;
+	if (memcmp(l->our_ether, NetOurEther, 6))
+		return 0;
+	elapsed = get_timer(l->start) / 1000;
+	if (elapsed >= l->seconds / 2)
+		return 0;
+
+	NetOurIP = l->our_ip;
+	NetServerIP = l->server_ip;
+	NetOurGatewayIP = l->gateway_ip;
+	NetOurSubnetMask = l->subnet_mask;
+	NetOurDNSIP = l->dns_ip;
+	memcpy(NetServerEther, l->server_ether, 6);
+	if (*l->bootfile) {
+		copy_filename(BootFile, l->bootfile, sizeof(BootFile));
+		setenv("bootfile", BootFile);
+	}
+	dhcp_state = BOUND;
+
+	printf("DHCP client reusing lease on %pI4 (%lus left)\n",
+	       &NetOurIP, l->seconds - elapsed);
+	bootstage_mark_name(BOOTSTAGE_ID_BOOTP_STOP, "bootp_stop");
+
+	return 1;
+}
+
+void dhcp_lease_flush(void)
+{
+	dhcp_lease.seconds = 0;
+}
+#else
+static inline void dhcp_lease_save(struct Bootp_t *bp) {}
+
+static inline int dhcp_lease_reuse(void)
+{
+	return 0;
+}
+#endif
+
 /*
  *	Handle DHCP received packets.
  */
@@ -937,6 +1020,7 @@ DhcpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 			/* Store net params from reply */
 			BootpCopyNetParams(bp);
 			dhcp_state = BOUND;
+			dhcp_lease_save(bp);
 			printf("DHCP client bound to address %pI4\n",
 				&NetOurIP);
 			bootstage_mark_name(BOOTSTAGE_ID_BOOTP_STOP,
@@ -958,6 +1042,12 @@ DhcpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 
 void DhcpRequest(void)
 {
+	if (dhcp_lease_reuse()) {
+		net_auto_load();
+		return;
+	}
+
+	dhcp_leasetime = 0;
 	BootpRequest();
 }
 #endif	/* CONFIG_CMD_DHCP */
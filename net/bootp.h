@@ -70,6 +70,13 @@ extern void BootpRequest(void);
 /****************** DHCP Support *********************/
 extern void DhcpRequest(void);
 
+#if defined(CONFIG_CMD_DHCP) && defined(CONFIG_DHCP_LEASE_CACHE)
+/* Forget the cached lease, the next 'dhcp' goes to the server again */
+void dhcp_lease_flush(void);
+#else
+static inline void dhcp_lease_flush(void) {}
+#endif
+
 /* DHCP States */
 typedef enum { INIT,
 	       INIT_REBOOT,
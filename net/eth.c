@@ -7,6 +7,7 @@
 
 #include <common.h>
 #include <command.h>
+#include <initcall.h>
 #include <net.h>
 #include <miiphy.h>
 #include <phy.h>
@@ -114,6 +115,7 @@ struct eth_device *eth_get_dev_by_name(const char *devname)
 
 	BUG_ON(devname == NULL);
 
+	initcall_run_deferred("eth");
 	if (!eth_devices)
 		return NULL;
 
@@ -134,6 +136,7 @@ struct eth_device *eth_get_dev_by_index(int index)
 {
 	struct eth_device *dev, *target_dev;
 
+	initcall_run_deferred("eth");
 	if (!eth_devices)
 		return NULL;
 
@@ -389,6 +392,7 @@ int eth_init(bd_t *bis)
 {
 	struct eth_device *old_current, *dev;
 
+	initcall_run_deferred("eth");
 	if (!eth_current) {
 		puts("No ethernet found.\n");
 		return -1;
@@ -527,6 +531,7 @@ void eth_set_current(void)
 	struct eth_device *old_current;
 	int	env_id;
 
+	initcall_run_deferred("eth");
 	if (!eth_current)	/* XXX no current */
 		return;
 
@@ -227,6 +227,25 @@ static int on_bootfile(const char *name, const char *value, enum env_op op,
 }
 U_BOOT_ENV_CALLBACK(bootfile, on_bootfile);
 
+/*
+ * A new ipaddr or netmask makes the cached lease and the cached
+ * neighbours stale. 'dhcp' itself writes back the values it got, so
+ * only flush when they really change.
+ */
+static int on_netconf(const char *name, const char *value, enum env_op op,
+	int flags)
+{
+	IPaddr_t cur = strcmp(name, "netmask") ? NetOurIP : NetOurSubnetMask;
+
+	if (op == env_op_delete || string_to_ip(value) != cur) {
+		dhcp_lease_flush();
+		arp_cache_flush();
+	}
+
+	return 0;
+}
+U_BOOT_ENV_CALLBACK(netconf, on_netconf);
+
 /*
  * Check if autoload is enabled. If so, use either NFS or TFTP to download
  * the boot file.
@@ -273,8 +292,12 @@ static void NetInitLoop(void)
 #endif
 		env_changed_id = env_id;
 	}
-	if (eth_get_dev())
+	if (eth_get_dev()) {
+		/* cached neighbours are only valid on the same interface */
+		if (memcmp(NetOurEther, eth_get_dev()->enetaddr, 6))
+			arp_cache_flush();
 		memcpy(NetOurEther, eth_get_dev()->enetaddr, 6);
+	}
 
 	return;
 }
@@ -332,6 +355,9 @@ int NetLoop(enum proto_t protocol)
 	debug_cond(DEBUG_INT_STATE, "--- NetLoop Entry\n");
 
 	bootstage_mark_name(BOOTSTAGE_ID_ETH_START, "eth_start");
+	/* pending console output goes out before the interface is reused */
+	if (protocol != NETCONS)
+		nc_flush();
 	net_init();
 	if (eth_is_on_demand_init() || protocol != NETCONS) {
 		eth_halt();
@@ -383,6 +409,11 @@ restart:
 			TftpStartServer();
 			break;
 #endif
+#ifdef CONFIG_CMD_TFTPMULTI
+		case TFTPMULTI:
+			TftpMultiStart();
+			break;
+#endif
 #if defined(CONFIG_CMD_DHCP)
 		case DHCP:
 			BootpTry = 0;
@@ -712,6 +743,9 @@ int NetSendUDPPacket(uchar *ether, IPaddr_t dest, int dport, int sport,
 	/* if broadcast, make the ether address a broadcast and don't do ARP */
 	if (dest == 0xFFFFFFFF)
 		ether = NetBcastAddr;
+	else if (memcmp(ether, NetEtherNullAddr, 6) == 0)
+		/* a previous command may already have resolved it */
+		arp_cache_lookup(dest, ether);
 
 	pkt = (uchar *)NetTxPacket;
 
@@ -748,11 +782,19 @@ int NetSendUDPPacket(uchar *ether, IPaddr_t dest, int dport, int sport,
 /*
  * This function collects fragments in a single packet, according
  * to the algorithm in RFC815. It returns NULL or the pointer to
- * a complete packet, in static storage
+ * a complete packet, in static storage. Up to NET_DEFRAG_CONTEXTS
+ * datagrams can be in reassembly at the same time; a datagram that
+ * is not completed within NET_DEFRAG_TIMEOUT ms gives up its slot.
  */
 #ifndef CONFIG_NET_MAXDEFRAG
 #define CONFIG_NET_MAXDEFRAG 16384
 #endif
+#ifndef CONFIG_NET_DEFRAG_CONTEXTS
+#define CONFIG_NET_DEFRAG_CONTEXTS 1
+#endif
+#ifndef CONFIG_NET_DEFRAG_TIMEOUT
+#define CONFIG_NET_DEFRAG_TIMEOUT 2000UL
+#endif
 /*
  * MAXDEFRAG, above, is chosen in the config file and  is real data
  * so we need to add the NFS overhead, which is more than TFTP.
@@ -777,36 +819,84 @@ struct hole {
 	u16 unused;
 };
 
+/* one datagram being reassembled; total_len == 0 marks a free slot */
+struct defrag_ctx {
+	uchar pkt_buff[IP_PKTSIZE] __aligned(PKTALIGN);
+	u16 first_hole, total_len;
+	ulong stamp;	/* get_timer() when the first fragment arrived */
+};
+
+static struct defrag_ctx defrag_ctx[CONFIG_NET_DEFRAG_CONTEXTS];
+
+/*
+ * Find the context collecting this datagram (same id, source and
+ * protocol). Failing that, take a free or timed out slot, or as a last
+ * resort the oldest one, and start a new datagram in it.
+ */
+static struct defrag_ctx *defrag_get_ctx(struct ip_udp_hdr *ip)
+{
+	struct defrag_ctx *ctx, *victim = NULL;
+	struct ip_udp_hdr *localip;
+	struct hole *payload;
+	int i;
+
+	for (i = 0; i < CONFIG_NET_DEFRAG_CONTEXTS; i++) {
+		ctx = &defrag_ctx[i];
+		localip = (struct ip_udp_hdr *)ctx->pkt_buff;
+		if (ctx->total_len &&
+		    get_timer(ctx->stamp) >= CONFIG_NET_DEFRAG_TIMEOUT)
+			ctx->total_len = 0;
+		if (!ctx->total_len) {
+			if (!victim || victim->total_len)
+				victim = ctx;
+			continue;
+		}
+		if (localip->ip_id == ip->ip_id &&
+		    localip->ip_p == ip->ip_p &&
+		    !memcmp(&localip->ip_src, &ip->ip_src, sizeof(IPaddr_t)))
+			return ctx;
+		if (!victim || (victim->total_len &&
+				get_timer(victim->stamp) < get_timer(ctx->stamp)))
+			victim = ctx;
+	}
+
+	/* new (or different) packet, reset structs */
+	ctx = victim;
+	payload = (struct hole *)(ctx->pkt_buff + IP_HDR_SIZE);
+	ctx->total_len = 0xffff;
+	ctx->stamp = get_timer(0);
+	payload[0].last_byte = ~0;
+	payload[0].next_hole = 0;
+	payload[0].prev_hole = 0;
+	ctx->first_hole = 0;
+	/* any IP header will work, copy the first we received */
+	memcpy(ctx->pkt_buff, ip, IP_HDR_SIZE);
+
+	return ctx;
+}
+
 static struct ip_udp_hdr *__NetDefragment(struct ip_udp_hdr *ip, int *lenp)
 {
-	static uchar pkt_buff[IP_PKTSIZE] __aligned(PKTALIGN);
-	static u16 first_hole, total_len;
+	struct defrag_ctx *ctx;
 	struct hole *payload, *thisfrag, *h, *newh;
-	struct ip_udp_hdr *localip = (struct ip_udp_hdr *)pkt_buff;
+	struct ip_udp_hdr *localip;
 	uchar *indata = (uchar *)ip;
 	int offset8, start, len, done = 0;
 	u16 ip_off = ntohs(ip->ip_off);
 
-	/* payload starts after IP header, this fragment is in there */
-	payload = (struct hole *)(pkt_buff + IP_HDR_SIZE);
 	offset8 =  (ip_off & IP_OFFS);
-	thisfrag = payload + offset8;
 	start = offset8 * 8;
 	len = ntohs(ip->ip_len) - IP_HDR_SIZE;
 
 	if (start + len > IP_MAXUDP) /* fragment extends too far */
 		return NULL;
 
-	if (!total_len || localip->ip_id != ip->ip_id) {
-		/* new (or different) packet, reset structs */
-		total_len = 0xffff;
-		payload[0].last_byte = ~0;
-		payload[0].next_hole = 0;
-		payload[0].prev_hole = 0;
-		first_hole = 0;
-		/* any IP header will work, copy the first we received */
-		memcpy(localip, ip, IP_HDR_SIZE);
-	}
+	ctx = defrag_get_ctx(ip);
+	localip = (struct ip_udp_hdr *)ctx->pkt_buff;
+
+	/* payload starts after IP header, this fragment is in there */
+	payload = (struct hole *)(ctx->pkt_buff + IP_HDR_SIZE);
+	thisfrag = payload + offset8;
 
 	/*
 	 * What follows is the reassembly algorithm. We use the payload
@@ -815,7 +905,7 @@ static struct ip_udp_hdr *__NetDefragment(struct ip_udp_hdr *ip, int *lenp)
 	 * so it is represented as byte count, not as 8-byte blocks.
 	 */
 
-	h = payload + first_hole;
+	h = payload + ctx->first_hole;
 	while (h->last_byte < start) {
 		if (!h->next_hole) {
 			/* no hole that far away */
@@ -832,7 +922,7 @@ static struct ip_udp_hdr *__NetDefragment(struct ip_udp_hdr *ip, int *lenp)
 
 	if (!(ip_off & IP_FLAGS_MFRAG)) {
 		/* no more fragmentss: truncate this (last) hole */
-		total_len = start + len;
+		ctx->total_len = start + len;
 		h->last_byte = start + len;
 	}
 
@@ -849,7 +939,7 @@ static struct ip_udp_hdr *__NetDefragment(struct ip_udp_hdr *ip, int *lenp)
 			done = 1;
 		} else if (!h->prev_hole) {
 			/* first hole */
-			first_hole = h->next_hole;
+			ctx->first_hole = h->next_hole;
 			payload[h->next_hole].prev_hole = 0;
 		} else if (!h->next_hole) {
 			/* last hole */
@@ -874,7 +964,7 @@ static struct ip_udp_hdr *__NetDefragment(struct ip_udp_hdr *ip, int *lenp)
 		if (h->prev_hole)
 			payload[h->prev_hole].next_hole = (h - payload);
 		else
-			first_hole = (h - payload);
+			ctx->first_hole = (h - payload);
 
 	} else {
 		/* fragment sits in the middle: split the hole */
@@ -892,8 +982,10 @@ static struct ip_udp_hdr *__NetDefragment(struct ip_udp_hdr *ip, int *lenp)
 	if (!done)
 		return NULL;
 
-	localip->ip_len = htons(total_len);
-	*lenp = total_len + IP_HDR_SIZE;
+	/* the slot is free again, the data stays put until the next packet */
+	localip->ip_len = htons(ctx->total_len);
+	*lenp = ctx->total_len + IP_HDR_SIZE;
+	ctx->total_len = 0;
 	return localip;
 }
 
@@ -1237,6 +1329,7 @@ static int net_check_prereq(enum proto_t protocol)
 #endif
 	case TFTPGET:
 	case TFTPPUT:
+	case TFTPMULTI:
 		if (NetServerIP == 0) {
 			puts("*** ERROR: `serverip' not set\n");
 			return 1;
@@ -42,8 +42,14 @@ static int ping_send(void)
 {
 	uchar *pkt;
 	int eth_hdr_size;
+	uchar ether[6];
 
-	/* XXX always send arp request */
+	if (!arp_cache_lookup(NetPingIP, ether)) {
+		eth_hdr_size = NetSetEther(NetTxPacket, ether, PROT_IP);
+		set_icmp_header((uchar *)NetTxPacket + eth_hdr_size, NetPingIP);
+		NetSendPacket(NetTxPacket, eth_hdr_size + IP_ICMP_HDR_SIZE);
+		return 0;	/* transmitted */
+	}
 
 	debug_cond(DEBUG_DEV_PKT, "sending ARP for %pI4\n", &NetPingIP);
 
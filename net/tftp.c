@@ -11,6 +11,7 @@
 #include <net.h>
 #include "tftp.h"
 #include "bootp.h"
+#include "arp.h"
 #ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
 #include <flash.h>
 #endif
@@ -133,14 +134,24 @@ static unsigned short TftpBlkSizeOption = TFTP_MTU_BLOCKSIZE;
 #ifdef CONFIG_MCAST_TFTP
 #include <malloc.h>
 #define MTFTP_BITMAPSIZE	0x1000
+/* Blocks the server sends between two ACKs of the master client */
+#ifndef CONFIG_MCAST_TFTP_WINDOWSIZE
+#define CONFIG_MCAST_TFTP_WINDOWSIZE	16
+#endif
+/* Minimum time between two repair requests (NAKs) for the same hole */
+#define MTFTP_NAK_DELAY	100UL
 static unsigned *Bitmap;
 static int PrevBitmapHole, Mapsize = MTFTP_BITMAPSIZE;
 static uchar ProhibitMcast, MasterClient;
 static uchar Multicast;
 static int Mcast_port;
 static ulong TftpEndingBlock; /* can get 'last' block before done..*/
+static ulong TftpMcastHighest;	/* highest (unwrapped) block received */
+static ulong TftpMcastSize;	/* file size from the OACK, 0 if unknown */
+static ulong TftpWindowSize;	/* blocks per ACK, from the OACK */
+static ulong TftpNakTime;	/* when we last asked for a repair */
 
-static void parse_multicast_oack(char *pkt, int len);
+static int parse_multicast_oack(char *pkt, int len);
 
 static void
 mcast_cleanup(void)
@@ -152,6 +163,28 @@ mcast_cleanup(void)
 	Bitmap = NULL;
 	Mcast_addr = Multicast = Mcast_port = 0;
 	TftpEndingBlock = -1;
+	TftpMcastHighest = 0;
+	TftpMcastSize = 0;
+	TftpWindowSize = 1;
+}
+
+/*
+ * Data blocks are numbered modulo 2^16. Turn the received number into
+ * the absolute block number closest to the highest one seen so far, so
+ * the bitmap can cover files with more than 65535 blocks. This only works
+ * for a client that has seen the transfer from its start; a late joiner
+ * cannot tell the lap, see parse_multicast_oack().
+ */
+static ulong mcast_unwrap_block(ulong block)
+{
+	ulong abs = (TftpMcastHighest & ~0xffffUL) | block;
+
+	if (abs + 0x8000 < TftpMcastHighest)
+		abs += TFTP_SEQUENCE_SIZE;
+	else if (abs > TftpMcastHighest + 0x8000 && abs >= TFTP_SEQUENCE_SIZE)
+		abs -= TFTP_SEQUENCE_SIZE;
+
+	return abs;
 }
 
 #endif	/* CONFIG_MCAST_TFTP */
@@ -281,6 +314,13 @@ static void update_block_number(void)
 	 * number of 0 this means that there was a wrap
 	 * around of the (16 bit) counter.
 	 */
+#ifdef CONFIG_MCAST_TFTP
+	/* multicast blocks may arrive in any order, see mcast_unwrap_block() */
+	if (Multicast) {
+		show_block_marker();
+		return;
+	}
+#endif
 	if (TftpBlock == 0 && TftpLastBlock != 0) {
 		TftpBlockWrap++;
 		TftpBlockWrapOffset += TftpBlkSize * TFTP_SEQUENCE_SIZE;
@@ -319,11 +359,12 @@ TftpSend(void)
 	ushort *s;
 
 #ifdef CONFIG_MCAST_TFTP
-	/* Multicast TFTP.. non-MasterClients do not ACK data. */
-	if (Multicast
-	 && (TftpState == STATE_DATA)
-	 && (MasterClient == 0))
-		return;
+	/*
+	 * Multicast TFTP: the master client ACKs and every client asks for
+	 * repairs by naming the last block it holds without a hole before.
+	 */
+	if (Multicast && TftpState == STATE_DATA)
+		TftpBlock = PrevBitmapHole;
 #endif
 	/*
 	 *	We will always be sending some sort of packet, so
@@ -368,6 +409,13 @@ TftpSend(void)
 				Bitmap = NULL;
 				pkt += sprintf((char *)pkt, "multicast%c%c",
 					0, 0);
+				pkt += sprintf((char *)pkt, "windowsize%c%d%c",
+					0, CONFIG_MCAST_TFTP_WINDOWSIZE, 0);
+#ifndef CONFIG_TFTP_TSIZE
+				/* a late joiner needs the size, see below */
+				pkt += sprintf((char *)pkt, "tsize%c0%c",
+					0, 0);
+#endif
 			}
 		}
 #endif /* CONFIG_MCAST_TFTP */
@@ -442,6 +490,71 @@ static void icmp_handler(unsigned type, unsigned code, unsigned dest,
 }
 #endif
 
+#ifdef CONFIG_MCAST_TFTP
+/*
+ * Store a block received in multicast mode and decide whether to talk to
+ * the server: the master client ACKs once per window, any client asks
+ * for a repair (NAK) when it sees a hole, and every client reports the
+ * final block so the server knows it is done.
+ */
+static void mcast_receive_block(uchar *src, unsigned len)
+{
+	ulong block = mcast_unwrap_block(TftpBlock);
+	ulong hole;
+
+	if (block == 0)
+		return;
+	if (block > Mapsize * 8) {
+		printf("tftpfile too big\n");
+		/* try to double it and retry */
+		Mapsize <<= 1;
+		mcast_cleanup();
+		NetStartAgain();
+		return;
+	}
+	if (block > TftpMcastHighest)
+		TftpMcastHighest = block;
+
+	TftpTimeoutCountMax = TIMEOUT_COUNT;
+	NetSetTimeout(TftpTimeoutMSecs, TftpTimeout);
+
+	if (!ext2_test_bit(block - 1, Bitmap)) {
+		TftpBlockWrapOffset = 0;
+		store_block(block - 1, src, len);
+	}
+	if (len < TftpBlkSize)
+		TftpEndingBlock = block;
+
+	hole = ext2_find_next_zero_bit(Bitmap, Mapsize * 8, PrevBitmapHole);
+	PrevBitmapHole = hole;
+
+	if (hole >= TftpEndingBlock) {
+		TftpSend();	/* final ACK */
+		puts("\nMulticast tftp done\n");
+		mcast_cleanup();
+		tftp_complete();
+		return;
+	}
+
+	if (block > hole + 1) {
+		/*
+		 * Blocks are missing before this one. Spread the NAKs of
+		 * the boards in a rack a little so they do not all hit the
+		 * server at once; it merges requests for the same hole.
+		 */
+		if (get_timer(TftpNakTime) >
+		    MTFTP_NAK_DELAY + (ntohl(NetOurIP) & 0x3f)) {
+			TftpNakTime = get_timer(0);
+			TftpSend();
+		}
+		return;
+	}
+
+	if (MasterClient && (block % TftpWindowSize) == 0)
+		TftpSend();
+}
+#endif
+
 static void
 TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 	    unsigned len)
@@ -535,13 +648,23 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 				debug("size = %s, %d\n",
 					 (char *)pkt+i+6, TftpTsize);
 			}
+#endif
+#ifdef CONFIG_MCAST_TFTP
+			if (strcmp((char *)pkt+i, "windowsize") == 0)
+				TftpWindowSize = simple_strtoul(
+					(char *)pkt+i+11, NULL, 10) ?: 1;
+			if (strcmp((char *)pkt+i, "tsize") == 0)
+				TftpMcastSize = simple_strtoul(
+					(char *)pkt+i+6, NULL, 10);
 #endif
 		}
 #ifdef CONFIG_MCAST_TFTP
-		parse_multicast_oack((char *)pkt, len-1);
-		if ((Multicast) && (!MasterClient))
+		if (parse_multicast_oack((char *)pkt, len-1))
+			break;	/* starting again */
+		if ((Multicast) && (!MasterClient)) {
 			TftpState = STATE_DATA;	/* passive.. */
-		else
+			break;
+		}
 #endif
 #ifdef CONFIG_CMD_TFTPPUT
 		if (TftpWriting) {
@@ -585,6 +708,13 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 			}
 		}
 
+#ifdef CONFIG_MCAST_TFTP
+		if (Multicast) {
+			mcast_receive_block(pkt + 2, len);
+			break;
+		}
+#endif
+
 		if (TftpBlock == TftpLastBlock) {
 			/*
 			 *	Same block again; ignore it.
@@ -602,42 +732,8 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 		 *	Acknowledge the block just received, which will prompt
 		 *	the remote for the next one.
 		 */
-#ifdef CONFIG_MCAST_TFTP
-		/* if I am the MasterClient, actively calculate what my next
-		 * needed block is; else I'm passive; not ACKING
-		 */
-		if (Multicast) {
-			if (len < TftpBlkSize)  {
-				TftpEndingBlock = TftpBlock;
-			} else if (MasterClient) {
-				TftpBlock = PrevBitmapHole =
-					ext2_find_next_zero_bit(
-						Bitmap,
-						(Mapsize*8),
-						PrevBitmapHole);
-				if (TftpBlock > ((Mapsize*8) - 1)) {
-					printf("tftpfile too big\n");
-					/* try to double it and retry */
-					Mapsize <<= 1;
-					mcast_cleanup();
-					NetStartAgain();
-					return;
-				}
-				TftpLastBlock = TftpBlock;
-			}
-		}
-#endif
 		TftpSend();
 
-#ifdef CONFIG_MCAST_TFTP
-		if (Multicast) {
-			if (MasterClient && (TftpBlock >= TftpEndingBlock)) {
-				puts("\nMulticast tftp done\n");
-				mcast_cleanup();
-				net_set_state(NETLOOP_SUCCESS);
-			}
-		} else
-#endif
 		if (len < TftpBlkSize)
 			tftp_complete();
 		break;
@@ -855,6 +951,355 @@ TftpStartServer(void)
 }
 #endif /* CONFIG_CMD_TFTPSRV */
 
+#ifdef CONFIG_CMD_TFTPMULTI
+/*
+ * Several concurrent read requests driven by one NetLoop. Each session
+ * has its own UDP port and transfer state; the UDP handler dispatches on
+ * the destination port and a periodic tick handles retransmissions, so
+ * the round trips of the individual files overlap on the wire.
+ */
+/* Milliseconds between checks for lost and held-back packets */
+#define MULTI_TICK	10UL
+
+enum {
+	SESSION_RRQ,		/* requesting, waiting for OACK/DATA */
+	SESSION_DATA,		/* receiving data */
+	SESSION_DONE,
+};
+
+struct tftp_session {
+	int		state;
+	int		unsent;		/* packet still has to go out */
+	IPaddr_t	remote_ip;
+	uchar		ether[6];	/* server MAC, resolved by ARP */
+	int		remote_port;
+	int		our_port;
+	ulong		block;		/* last block received */
+	ulong		wrap_offset;	/* memory offset due to wrapping */
+	unsigned short	blksize;
+	ulong		addr;		/* load address */
+	ulong		size;		/* bytes received */
+	int		timeout_count;
+	ulong		last_io;	/* get_timer() at last activity */
+	char		filename[MAX_LEN];
+};
+
+static struct tftp_session multi_sessions[CONFIG_TFTP_MAX_SESSIONS];
+static int multi_count;
+static ulong multi_blocks;	/* blocks received over all sessions */
+
+void tftp_multi_reset(void)
+{
+	multi_count = 0;
+}
+
+int tftp_multi_add(ulong addr, const char *name)
+{
+	struct tftp_session *ses;
+	const char *p;
+
+	if (multi_count >= CONFIG_TFTP_MAX_SESSIONS)
+		return -ENOSPC;
+
+	ses = &multi_sessions[multi_count++];
+	memset(ses, 0, sizeof(*ses));
+	ses->addr = addr;
+	p = strchr(name, ':');
+	if (p) {
+		ses->remote_ip = string_to_ip(name);
+		name = p + 1;
+	}
+	strncpy(ses->filename, name, MAX_LEN);
+	ses->filename[MAX_LEN - 1] = 0;
+
+	return 0;
+}
+
+ulong tftp_multi_size(int idx)
+{
+	if (idx < 0 || idx >= multi_count)
+		return 0;
+	return multi_sessions[idx].size;
+}
+
+/* Prepare a session to (re)send its read request from scratch */
+static void multi_session_reset(struct tftp_session *ses, int port)
+{
+	ses->state = SESSION_RRQ;
+	ses->unsent = 1;
+	ses->last_io = get_timer(0);
+	ses->remote_port = WELL_KNOWN_PORT;
+	ses->our_port = port;
+	ses->block = 0;
+	ses->wrap_offset = 0;
+	ses->blksize = TFTP_BLOCK_SIZE;
+	ses->size = 0;
+	ses->timeout_count = 0;
+}
+
+static void multi_send(struct tftp_session *ses)
+{
+	uchar *pkt, *xp;
+	ushort *s;
+	int i;
+
+	/*
+	 * A pending ARP request holds on to NetTxPacket until the reply
+	 * arrives, so we must not overwrite it; multi_kick() sends later.
+	 */
+	ses->unsent = 1;
+	if (NetArpWaitPacketIP)
+		return;
+	ses->unsent = 0;
+
+	pkt = NetTxPacket + NetEthHdrSize() + IP_UDP_HDR_SIZE;
+	xp = pkt;
+	s = (ushort *)pkt;
+
+	if (ses->state == SESSION_RRQ) {
+		*s++ = htons(TFTP_RRQ);
+		pkt = (uchar *)s;
+		pkt += sprintf((char *)pkt, "%s%coctet%ctimeout%c%lu%c",
+			       ses->filename, 0, 0, 0,
+			       TftpTimeoutMSecs / 1000, 0);
+		pkt += sprintf((char *)pkt, "blksize%c%d%c",
+			       0, TftpBlkSizeOption, 0);
+	} else {
+		*s++ = htons(TFTP_ACK);
+		*s++ = htons(ses->block);
+		pkt = (uchar *)s;
+	}
+
+	/* another session may already have resolved this server */
+	if (!memcmp(ses->ether, NetEtherNullAddr, 6)) {
+		for (i = 0; i < multi_count; i++) {
+			if (multi_sessions[i].remote_ip == ses->remote_ip)
+				memcpy(ses->ether, multi_sessions[i].ether, 6);
+			if (memcmp(ses->ether, NetEtherNullAddr, 6))
+				break;
+		}
+	}
+
+	ses->last_io = get_timer(0);
+	NetSendUDPPacket(ses->ether, ses->remote_ip, ses->remote_port,
+			 ses->our_port, pkt - xp);
+}
+
+/* Send the packets that were held back while an ARP was in flight */
+static void multi_kick(void)
+{
+	struct tftp_session *ses;
+	int i;
+
+	for (i = 0; i < multi_count && !NetArpWaitPacketIP; i++) {
+		ses = &multi_sessions[i];
+		if (ses->unsent && ses->state != SESSION_DONE)
+			multi_send(ses);
+	}
+}
+
+static void multi_complete(void)
+{
+	struct tftp_session *ses;
+	ulong elapsed, total = 0;
+	int i;
+
+	for (i = 0; i < multi_count; i++) {
+		if (multi_sessions[i].state != SESSION_DONE)
+			return;
+		total += multi_sessions[i].size;
+	}
+
+	NetSetTimeout(0, NULL);
+	elapsed = get_timer(time_start);
+	if (elapsed > 0) {
+		puts("\n\t ");	/* Line up with "Loading: " */
+		print_size(total / elapsed * 1000, "/s");
+	}
+	puts("\n");
+	for (i = 0; i < multi_count; i++) {
+		ses = &multi_sessions[i];
+		printf("'%s' at 0x%08lx: %lu bytes\n", ses->filename,
+		       ses->addr, ses->size);
+	}
+	puts("done\n");
+
+	NetBootFileXferSize = total;
+	net_set_state(NETLOOP_SUCCESS);
+}
+
+static void multi_handler(uchar *pkt, unsigned dest, IPaddr_t sip,
+			  unsigned src, unsigned len)
+{
+	struct tftp_session *ses = NULL;
+	ulong block, offset;
+	__be16 *s;
+	int i;
+
+	for (i = 0; i < multi_count; i++) {
+		if (multi_sessions[i].our_port == dest) {
+			ses = &multi_sessions[i];
+			break;
+		}
+	}
+	if (!ses || ses->state == SESSION_DONE || sip != ses->remote_ip)
+		return;
+	if (ses->state != SESSION_RRQ && src != ses->remote_port)
+		return;
+	if (len < 4)
+		return;
+
+	s = (__be16 *)pkt;
+	pkt += 4;
+	len -= 4;
+	ses->last_io = get_timer(0);
+
+	switch (ntohs(s[0])) {
+	case TFTP_OACK:
+		if (ses->state != SESSION_RRQ) {
+			/* a repeated OACK means our ACK(0) got lost */
+			if (ses->block == 0)
+				multi_send(ses);
+			break;
+		}
+		/* options start in place of the block number */
+		pkt -= 2;
+		len += 2;
+		for (i = 0; i + 8 < len; i++) {
+			if (strcmp((char *)pkt + i, "blksize") == 0)
+				ses->blksize = (unsigned short)simple_strtoul(
+					(char *)pkt + i + 8, NULL, 10);
+		}
+		ses->remote_port = src;
+		ses->state = SESSION_DATA;
+		ses->block = 0;
+		multi_send(ses);	/* ACK(0) */
+		break;
+
+	case TFTP_DATA:
+		block = ntohs(s[1]);
+		if (ses->state == SESSION_RRQ) {
+			if (block != 1)
+				break;
+			ses->remote_port = src;
+			ses->state = SESSION_DATA;
+		}
+		if (block == ses->block) {
+			/* same block again; the ACK got lost */
+			multi_send(ses);
+			break;
+		}
+		if (block != ((ses->block + 1) & 0xffff))
+			break;
+		if (block == 0) {
+			/* the 16 bit block number wrapped around */
+			ses->wrap_offset += ses->blksize * TFTP_SEQUENCE_SIZE;
+			offset = ses->wrap_offset - ses->blksize;
+		} else {
+			offset = (block - 1) * ses->blksize + ses->wrap_offset;
+		}
+		memcpy((void *)(ses->addr + offset), pkt, len);
+		if (ses->size < offset + len)
+			ses->size = offset + len;
+		ses->block = block;
+		ses->timeout_count = 0;
+
+		if ((++multi_blocks % 10) == 1)
+			putc('#');
+		if ((multi_blocks % (10 * HASHES_PER_LINE)) == 0)
+			puts("\n\t ");
+
+		multi_send(ses);
+		if (len < ses->blksize) {
+			ses->state = SESSION_DONE;
+			multi_complete();
+		}
+		break;
+
+	case TFTP_ERROR:
+		printf("\nTFTP error on '%s': '%s' (%d)\n", ses->filename,
+		       pkt, ntohs(s[1]));
+		if (ntohs(s[1]) == TFTP_ERR_FILE_NOT_FOUND ||
+		    ntohs(s[1]) == TFTP_ERR_ACCESS_DENIED) {
+			puts("Not retrying...\n");
+			NetSetTimeout(0, NULL);
+			net_set_state(NETLOOP_FAIL);
+			break;
+		}
+		multi_session_reset(ses, ses->our_port);
+		break;
+
+	default:
+		break;
+	}
+
+	multi_kick();
+}
+
+static void multi_tick(void)
+{
+	struct tftp_session *ses;
+	int i;
+
+	NetSetTimeout(MULTI_TICK, multi_tick);
+	for (i = 0; i < multi_count; i++) {
+		ses = &multi_sessions[i];
+		if (ses->unsent || ses->state == SESSION_DONE ||
+		    get_timer(ses->last_io) < TftpTimeoutMSecs)
+			continue;
+		if (++ses->timeout_count > TftpTimeoutCountMax) {
+			restart("Retry count exceeded");
+			return;
+		}
+		puts("T ");
+		multi_send(ses);
+	}
+	multi_kick();
+}
+
+void TftpMultiStart(void)
+{
+	struct tftp_session *ses;
+	char *ep;
+	int i, port;
+
+	ep = getenv("tftpblocksize");
+	if (ep != NULL)
+		TftpBlkSizeOption = simple_strtol(ep, NULL, 10);
+
+	ep = getenv("tftptimeout");
+	if (ep != NULL)
+		TftpTimeoutMSecs = simple_strtol(ep, NULL, 10);
+	if (TftpTimeoutMSecs < 1000)
+		TftpTimeoutMSecs = 1000;
+	TftpTimeoutCountMax = TIMEOUT_COUNT;
+
+	printf("Using %s device\n", eth_get_name());
+	printf("TFTP %d files; our IP address is %pI4\n", multi_count,
+	       &NetOurIP);
+
+	/* Use consecutive pseudo-random ports, one per session */
+	port = 1024 + (get_timer(0) % 3072);
+	for (i = 0; i < multi_count; i++) {
+		ses = &multi_sessions[i];
+		if (!ses->remote_ip)
+			ses->remote_ip = NetServerIP;
+		memset(ses->ether, 0, 6);
+		multi_session_reset(ses, port + i);
+		printf("Filename '%s' from %pI4 to 0x%lx\n", ses->filename,
+		       &ses->remote_ip, ses->addr);
+	}
+	puts("Loading: *\b");
+
+	multi_blocks = 0;
+	time_start = get_timer(0);
+	net_set_udp_handler(multi_handler);
+	NetSetTimeout(MULTI_TICK, multi_tick);
+
+	multi_kick();
+}
+#endif /* CONFIG_CMD_TFTPMULTI */
+
 #ifdef CONFIG_MCAST_TFTP
 /* Credits: atftp project.
  */
@@ -870,8 +1315,9 @@ TftpStartServer(void)
  * making note of which ones I got in my bitmask.
  * In theory, I never go from master->passive..
  * .. this comes in with pkt already pointing just past opc
+ * Returns -1 if the transfer starts again without multicast, else 0.
  */
-static void parse_multicast_oack(char *pkt, int len)
+static int parse_multicast_oack(char *pkt, int len)
 {
 	int i;
 	IPaddr_t addr;
@@ -885,7 +1331,7 @@ static void parse_multicast_oack(char *pkt, int len)
 		if (strcmp(pkt+i, "multicast") == 0)
 			break;
 	if (i >= (len-14)) /* non-Multicast OACK, ign. */
-		return;
+		return 0;
 
 	i += 10; /* strlen multicast */
 	mc_adr = pkt+i;
@@ -901,20 +1347,43 @@ static void parse_multicast_oack(char *pkt, int len)
 		}
 	}
 	if (!port || !mc_adr || !mc)
-		return;
+		return 0;
 	if (Multicast && MasterClient) {
 		printf("I got a OACK as master Client, WRONG!\n");
-		return;
+		return 0;
 	}
 	/* ..I now accept packets destined for this MCAST addr, port */
 	if (!Multicast) {
+		/*
+		 * Not the master: the transfer may have started long ago.
+		 * Block numbers wrap after 65535 and nothing says which lap
+		 * the server is on, so only join if the file is shorter.
+		 */
+		if (!simple_strtoul(mc, NULL, 10) && (!TftpMcastSize ||
+		    TftpMcastSize / TftpBlkSize >= TFTP_SEQUENCE_SIZE - 1)) {
+			puts("Multicast: joined late, file may be too big, "
+			     "using unicast\n");
+			ProhibitMcast = 1;
+			mcast_cleanup();
+			NetStartAgain();
+			return -1;
+		}
 		if (Bitmap) {
 			printf("Internal failure! no mcast.\n");
 			free(Bitmap);
 			Bitmap = NULL;
 			ProhibitMcast = 1;
-			return ;
+			return 0;
+		}
+#ifdef CONFIG_TFTP_TSIZE
+		/* size the bitmap for the whole file when we know it */
+		if (TftpTsize) {
+			int need = (TftpTsize / TftpBlkSize + 32) / 32 * 4;
+
+			if (need > Mapsize)
+				Mapsize = need;
 		}
+#endif
 		/* I malloc instead of pre-declare; so that if the file ends
 		 * up being too big for this bitmap I can retry
 		 */
@@ -922,7 +1391,7 @@ static void parse_multicast_oack(char *pkt, int len)
 		if (!Bitmap) {
 			printf("No Bitmap, no multicast. Sorry.\n");
 			ProhibitMcast = 1;
-			return;
+			return 0;
 		}
 		memset(Bitmap, 0, Mapsize);
 		PrevBitmapHole = 0;
@@ -938,12 +1407,13 @@ static void parse_multicast_oack(char *pkt, int len)
 			ProhibitMcast = 1;
 			mcast_cleanup();
 			NetStartAgain();
+			return -1;
 		}
 	}
 	MasterClient = (unsigned char)simple_strtoul((char *)mc, NULL, 10);
 	Mcast_port = (unsigned short)simple_strtoul(port, NULL, 10);
 	printf("Multicast: %s:%d [%d]\n", mc_adr, Mcast_port, MasterClient);
-	return;
+	return 0;
 }
 
 #endif /* Multicast TFTP */
@@ -22,6 +22,10 @@ void TftpStart(enum proto_t protocol);	/* Begin TFTP get/put */
 extern void TftpStartServer(void);	/* Wait for incoming TFTP put */
 #endif
 
+#ifdef CONFIG_CMD_TFTPMULTI
+void TftpMultiStart(void);		/* Begin concurrent TFTP gets */
+#endif
+
 extern ulong TftpRRQTimeoutMSecs;
 extern int TftpRRQTimeoutCountMax;
 
@@ -0,0 +1,208 @@
+/*
+ * Randomised bit-flip test and benchmark for the BCH library
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <linux/bch.h>
+
+/* 512-byte steps with the parameters NAND drivers commonly use */
+static const struct {
+	int m, t;
+	unsigned int len;
+} bch_params[] = {
+	{ 13, 4, 512 },
+	{ 13, 8, 512 },
+	{ 13, 16, 512 },
+	{ 14, 24, 1024 },
+};
+
+static uint32_t bch_seed = 1;
+
+/* xorshift32, so that runs are repeatable on every host */
+static uint32_t bch_rand(void)
+{
+	bch_seed ^= bch_seed << 13;
+	bch_seed ^= bch_seed >> 17;
+	bch_seed ^= bch_seed << 5;
+
+	return bch_seed;
+}
+
+/* Flip @count distinct bits among the data and ecc bits */
+static void flip_bits(uint8_t *data, unsigned int len, uint8_t *ecc,
+		      unsigned int ecc_bits, unsigned int count)
+{
+	unsigned int bits = 8 * len + ecc_bits;
+	unsigned int used[32];
+	unsigned int i, j, bit;
+
+	for (i = 0; i < count; i++) {
+		do {
+			bit = bch_rand() % bits;
+			for (j = 0; j < i && used[j] != bit; j++)
+				;
+		} while (j < i);
+		used[i] = bit;
+
+		if (bit < 8 * len) {
+			data[bit / 8] ^= 1 << (bit % 8);
+		} else {
+			/* ecc bits are stored msb first */
+			bit -= 8 * len;
+			ecc[bit / 8] ^= 0x80 >> (bit % 8);
+		}
+	}
+}
+
+static int decode_and_fix(struct bch_control *bch, uint8_t *data,
+			  unsigned int len, uint8_t *ecc, unsigned int *errloc)
+{
+	int i, count;
+
+	count = decode_bch(bch, data, len, ecc, NULL, NULL, errloc);
+	for (i = 0; i < count; i++)
+		if (errloc[i] < 8 * len)
+			data[errloc[i] / 8] ^= 1 << (errloc[i] % 8);
+
+	return count;
+}
+
+static int run_test(struct bch_control *bch, unsigned int len, int iter)
+{
+	uint8_t *orig, *data, *ecc;
+	unsigned int *errloc;
+	unsigned int flips;
+	int i, count, ret = 1;
+
+	orig = malloc(len);
+	data = malloc(len);
+	ecc = malloc(bch->ecc_bytes);
+	errloc = malloc(bch->t * sizeof(*errloc));
+	if (!orig || !data || !ecc || !errloc) {
+		puts("out of memory\n");
+		goto out;
+	}
+
+	for (i = 0; i < iter; i++) {
+		unsigned int j;
+
+		for (j = 0; j < len; j++)
+			orig[j] = bch_rand();
+		memset(ecc, '\0', bch->ecc_bytes);
+		encode_bch(bch, orig, len, ecc);
+		memcpy(data, orig, len);
+
+		/* Anything up to t flipped bits must be corrected */
+		flips = i % (bch->t + 1);
+		flip_bits(data, len, ecc, bch->ecc_bits, flips);
+		count = decode_and_fix(bch, data, len, ecc, errloc);
+		if (count != (int)flips || memcmp(data, orig, len)) {
+			printf("\n  iteration %d: %u flips, decode returned %d%s\n",
+			       i, flips, count,
+			       memcmp(data, orig, len) ? ", data differs" : "");
+			goto out;
+		}
+	}
+	ret = 0;
+
+out:
+	free(errloc);
+	free(ecc);
+	free(data);
+	free(orig);
+
+	return ret;
+}
+
+/* Time decode_bch() on codewords with @flips errors; returns ns/decode */
+static ulong run_bench(struct bch_control *bch, unsigned int len,
+		       unsigned int flips, int iter)
+{
+	uint8_t *data, *ecc, *bad_ecc;
+	unsigned int *errloc;
+	unsigned long start, total = 0;
+	unsigned int j;
+	int i;
+
+	data = malloc(len);
+	ecc = malloc(bch->ecc_bytes);
+	bad_ecc = malloc(bch->ecc_bytes);
+	errloc = malloc(bch->t * sizeof(*errloc));
+	if (!data || !ecc || !bad_ecc || !errloc)
+		goto out;
+
+	for (j = 0; j < len; j++)
+		data[j] = bch_rand();
+	memset(ecc, '\0', bch->ecc_bytes);
+	encode_bch(bch, data, len, ecc);
+
+	for (i = 0; i < iter; i++) {
+		memcpy(bad_ecc, ecc, bch->ecc_bytes);
+		/* put the errors in the ecc so that the data stays intact */
+		flip_bits(bad_ecc, 0, bad_ecc, bch->ecc_bits, flips);
+		start = timer_get_us();
+		decode_bch(bch, data, len, bad_ecc, NULL, NULL, errloc);
+		total += timer_get_us() - start;
+	}
+
+out:
+	free(errloc);
+	free(bad_ecc);
+	free(ecc);
+	free(data);
+
+	return total * 1000 / iter;
+}
+
+static int do_test_bch(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	struct bch_control *bch;
+	int iter = 1000;
+	int err = 0;
+	unsigned int i;
+
+	if (argc > 1)
+		iter = simple_strtoul(argv[1], NULL, 10);
+	if (iter < 1)
+		return CMD_RET_USAGE;
+
+	for (i = 0; i < ARRAY_SIZE(bch_params); i++) {
+		bch = init_bch(bch_params[i].m, bch_params[i].t, 0);
+		if (!bch) {
+			printf("init_bch(%d, %d) failed\n", bch_params[i].m,
+			       bch_params[i].t);
+			err++;
+			continue;
+		}
+
+		bch_seed = i + 1;
+		printf(" m=%d t=%d len=%u:", bch->m, bch->t,
+		       bch_params[i].len);
+		if (run_test(bch, bch_params[i].len, iter)) {
+			printf(" FAILED\n");
+			err++;
+		} else {
+			printf(" ok; decode clean %lu ns, 1 error %lu ns, %u errors %lu ns\n",
+			       run_bench(bch, bch_params[i].len, 0, iter),
+			       run_bench(bch, bch_params[i].len, 1, iter),
+			       bch->t,
+			       run_bench(bch, bch_params[i].len, bch->t, iter));
+		}
+		free_bch(bch);
+	}
+
+	printf("test_bch %s\n", err == 0 ? "ok" : "FAILED");
+
+	return err;
+}
+
+U_BOOT_CMD(
+	test_bch,	2,	1,	do_test_bch,
+	"Randomised bit-flip test and benchmark of BCH decoding",
+	"[iterations]"
+);
@@ -0,0 +1,85 @@
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+
+# JFFS2 erase block summary test on the sandbox NAND simulator
+#
+# Builds a JFFS2 image with summaries using mkfs.jffs2 and sumtool from
+# mtd-utils, writes it to the simulated chip and reads the files back
+# through fsload. Loading a second file must reuse the node index, so the
+# partition is scanned only once per run.
+
+OUTPUT_DIR=sandbox
+# Image size in erase blocks of 64 pages of 2048 + 64 bytes
+NAND_BLOCKS=${NAND_BLOCKS-32}
+# Size of the test data in KiB
+DATA_KB=${DATA_KB-512}
+
+fail() {
+	echo "Test failed: $1"
+	if [ -n "${tmp}" ]; then
+		rm -rf ${tmp}
+	fi
+	exit 1
+}
+
+build_uboot() {
+	echo "Build sandbox"
+	OPTS="O=${OUTPUT_DIR}"
+	NUM_CPUS=$(grep -c processor /proc/cpuinfo)
+	make ${OPTS} sandbox_config
+	make ${OPTS} -s -j${NUM_CPUS}
+}
+
+# Create an erased chip and a summary image holding the test data
+make_images() {
+	tr '\000' '\377' </dev/zero | \
+		dd of=${tmp}/nand.bin bs=135168 count=${NAND_BLOCKS} \
+		iflag=fullblock 2>/dev/null
+	mkdir -p ${tmp}/root/dir
+	dd if=/dev/urandom of=${tmp}/root/dir/data.bin bs=1024 \
+		count=${DATA_KB} 2>/dev/null
+	echo "hello jffs2" >${tmp}/root/hello.txt
+	mkfs.jffs2 -l -n -e 0x20000 -r ${tmp}/root -o ${tmp}/fs.img || \
+		fail "mkfs.jffs2"
+	sumtool -l -n -p -e 0x20000 -i ${tmp}/fs.img -o ${tmp}/sum.img || \
+		fail "sumtool"
+	size=$(printf "%x" $((DATA_KB * 1024)))
+}
+
+# run_uboot <commands> - run commands with the test data loaded at 1000000
+run_uboot() {
+	./${OUTPUT_DIR}/u-boot --nand ${tmp}/nand.bin -c \
+		"sb bind 0 ${tmp}/root/dir/data.bin; \
+		sb load host 0 1000000 ${tmp}/root/dir/data.bin; \
+		mtdparts default; $1" >${tmp}/out 2>&1
+	cat ${tmp}/out >>${tmp}/log
+}
+
+if ! which mkfs.jffs2 >/dev/null 2>&1 || ! which sumtool >/dev/null 2>&1
+then
+	echo "mkfs.jffs2 or sumtool not found, skipping"
+	exit 0
+fi
+
+tmp="$(mktemp -d)"
+build_uboot
+make_images
+
+echo "Write the summary image"
+run_uboot "sb load host 0 3000000 ${tmp}/sum.img; \
+	nand erase.chip; nand write 3000000 0 \${filesize}"
+grep -q "bytes written: OK" ${tmp}/out || fail "nand write"
+
+echo "Load files"
+run_uboot "fsls /dir; fsload 2000000 /dir/data.bin; \
+	cmp.b 1000000 2000000 ${size}; fsload 3000000 /hello.txt"
+grep -q "Summary node" ${tmp}/out && fail "summary not used"
+grep -q "Total of $((DATA_KB * 1024)) byte(s) were the same" ${tmp}/out || \
+	fail "fsload read back wrong data"
+grep -q "load complete: 12 bytes" ${tmp}/out || fail "fsload /hello.txt"
+[ $(grep -c "Scanning JFFS2 FS" ${tmp}/out) -eq 1 ] || \
+	fail "partition scanned more than once"
+
+rm -rf ${tmp}
+echo "Test passed"
@@ -0,0 +1,138 @@
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+
+# Flash stack benchmark on the sandbox NAND simulator
+#
+# Times 'nand read', 'ubi part' and, when mtd-utils is installed,
+# 'ubifsload', and checks that the data read back is what was written.
+# The chip timings, geometry and fault injection come from NAND_OPTS, see
+# the NAND Emulation section of board/sandbox/sandbox/README.sandbox.
+
+OUTPUT_DIR=sandbox
+NAND_OPTS=${NAND_OPTS-"tr=25,tprog=200,tbers=1500"}
+# Image size in erase blocks of 64 pages of 2048 + 64 bytes
+NAND_BLOCKS=${NAND_BLOCKS-128}
+# Size of the test data in KiB
+DATA_KB=${DATA_KB-1024}
+
+fail() {
+	echo "Test failed: $1"
+	if [ -n "${tmp}" ]; then
+		rm -rf ${tmp}
+	fi
+	exit 1
+}
+
+build_uboot() {
+	echo "Build sandbox"
+	OPTS="O=${OUTPUT_DIR}"
+	NUM_CPUS=$(grep -c processor /proc/cpuinfo)
+	make ${OPTS} sandbox_config
+	make ${OPTS} -s -j${NUM_CPUS}
+}
+
+# Create an erased chip and some random test data
+make_images() {
+	tr '\000' '\377' </dev/zero | \
+		dd of=${tmp}/nand.bin bs=135168 count=${NAND_BLOCKS} \
+		iflag=fullblock 2>/dev/null
+	dd if=/dev/urandom of=${tmp}/data.bin bs=1024 count=${DATA_KB} \
+		2>/dev/null
+	size=$(printf "%x" $((DATA_KB * 1024)))
+}
+
+# run_uboot <commands> - run commands with the test data loaded at 1000000
+run_uboot() {
+	./${OUTPUT_DIR}/u-boot --nand ${NAND_OPTS}:${tmp}/nand.bin -c \
+		"sb bind 0 ${tmp}/data.bin; \
+		sb load host 0 1000000 ${tmp}/data.bin; \
+		mtdparts default; $1" >${tmp}/out 2>&1
+	cat ${tmp}/out >>${tmp}/log
+}
+
+# check_same <what> - the last cmp.b must have matched
+check_same() {
+	if ! grep -q "Total of $((DATA_KB * 1024)) byte(s) were the same" \
+			${tmp}/out; then
+		fail "$1 read back wrong data"
+	fi
+}
+
+# report <label>... - print the times measured by each 'time' command,
+# then the simulator counters from the last 'sb nand'
+report() {
+	grep "^time:" ${tmp}/out | while read t secs rest; do
+		printf "%-28s %s s\n" "$1" ${secs}
+		shift
+	done
+	awk '/^page loads:/ { s = "" }
+		/^page loads:/, /^busy time:/ { s = s "    " $0 "\n" }
+		END { printf "%s", s }' ${tmp}/out
+}
+
+bench_nand_read() {
+	echo "nand read"
+	run_uboot "nand erase.chip; nand write 1000000 0 ${size}; \
+		sb nand reset; time nand read 2000000 0 ${size}; sb nand; \
+		cmp.b 1000000 2000000 ${size}"
+	check_same "nand read"
+	report "nand read ${DATA_KB} KiB"
+}
+
+bench_ubi() {
+	echo "ubi part"
+	tr '\000' '\377' </dev/zero | \
+		dd of=${tmp}/nand.bin bs=135168 count=${NAND_BLOCKS} \
+		iflag=fullblock 2>/dev/null
+	# The first attach formats the empty chip
+	run_uboot "ubi part ubi; ubi create vol ${size}; \
+		ubi write 1000000 vol ${size}"
+	grep -q "bytes written to volume vol" ${tmp}/out || \
+		fail "ubi write"
+
+	run_uboot "sb nand reset; time ubi part ubi; sb nand; \
+		time ubi read 2000000 vol ${size}; \
+		cmp.b 1000000 2000000 ${size}"
+	check_same "ubi read"
+	report "ubi part" "ubi read ${DATA_KB} KiB"
+}
+
+bench_ubifs() {
+	echo "ubifsload"
+	if ! which mkfs.ubifs >/dev/null 2>&1; then
+		echo "mkfs.ubifs not found, skipping"
+		return
+	fi
+	mkdir ${tmp}/root
+	cp ${tmp}/data.bin ${tmp}/root/data.bin
+	mkfs.ubifs -m 2048 -e 129024 -c $((NAND_BLOCKS - 8)) \
+		-r ${tmp}/root -o ${tmp}/ubifs.img || fail "mkfs.ubifs"
+	ubifs_size=$(printf "%x" $(stat -c %s ${tmp}/ubifs.img))
+	tr '\000' '\377' </dev/zero | \
+		dd of=${tmp}/nand.bin bs=135168 count=${NAND_BLOCKS} \
+		iflag=fullblock 2>/dev/null
+
+	run_uboot "ubi part ubi; ubi create rootfs; \
+		sb load host 0 3000000 ${tmp}/ubifs.img; \
+		ubi write 3000000 rootfs ${ubifs_size}"
+	grep -q "bytes written to volume rootfs" ${tmp}/out || \
+		fail "ubi write of the ubifs image"
+
+	run_uboot "ubi part ubi; ubifsmount ubi0:rootfs; sb nand reset; \
+		time ubifsload 2000000 /data.bin; sb nand; \
+		cmp.b 1000000 2000000 ${size}"
+	check_same "ubifsload"
+	report "ubifsload ${DATA_KB} KiB"
+}
+
+echo "NAND flash stack benchmark using sandbox (${NAND_OPTS})"
+echo
+tmp="$(mktemp -d)"
+build_uboot
+make_images
+bench_nand_read
+bench_ubi
+bench_ubifs
+rm -rf ${tmp}
+echo "Test passed"
@@ -0,0 +1,89 @@
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+
+# UBI fastmap attach test on the sandbox NAND simulator
+#
+# Attaches a UBI device whose fastmap was written by Linux, reads a volume
+# back, then checks that the first write invalidates the fastmap and that
+# the device is scanned on the next attach.
+#
+# The image is a raw dump with OOB of a nandsim chip, made on a Linux
+# host with UBI fastmap support:
+#
+#   modprobe nandsim first_id_byte=0x20 second_id_byte=0xa1 \
+#	third_id_byte=0x00 fourth_id_byte=0x15
+#   ubiformat /dev/mtd0
+#   ubiattach -m 0		# with ubi.fm_autoconvert=1
+#   ubimkvol /dev/ubi0 -N data -s 1MiB
+#   ubiupdatevol /dev/ubi0_0 data.bin
+#   ubidetach -m 0		# writes the fastmap
+#   nanddump --oob -f fastmap.bin /dev/mtd0
+#
+# nandsim uses the Hamming ECC and OOB layout the simulator defaults to.
+#
+# Usage: FASTMAP_IMAGE=fastmap.bin FASTMAP_DATA=data.bin test-ubi-fastmap.sh
+
+OUTPUT_DIR=sandbox
+VOLUME=${VOLUME-data}
+
+fail() {
+	echo "Test failed: $1"
+	if [ -n "${tmp}" ]; then
+		rm -rf ${tmp}
+	fi
+	exit 1
+}
+
+build_uboot() {
+	echo "Build sandbox"
+	OPTS="O=${OUTPUT_DIR}"
+	NUM_CPUS=$(grep -c processor /proc/cpuinfo)
+	make ${OPTS} sandbox_config
+	make ${OPTS} -s -j${NUM_CPUS}
+}
+
+# run_uboot <commands> - run commands with the volume data at 1000000
+run_uboot() {
+	./${OUTPUT_DIR}/u-boot --nand ${tmp}/nand.bin -c \
+		"sb bind 0 ${FASTMAP_DATA}; \
+		sb load host 0 1000000 ${FASTMAP_DATA}; \
+		mtdparts default; $1" >${tmp}/out 2>&1
+	cat ${tmp}/out >>${tmp}/log
+}
+
+# check_same <what> - the last cmp.b must have matched
+check_same() {
+	if ! grep -q "Total of ${bytes} byte(s) were the same" ${tmp}/out
+	then
+		fail "$1 read back wrong data"
+	fi
+}
+
+if [ ! -f "${FASTMAP_IMAGE}" ] || [ ! -f "${FASTMAP_DATA}" ]; then
+	echo "FASTMAP_IMAGE and FASTMAP_DATA not given, skipping"
+	exit 0
+fi
+
+tmp="$(mktemp -d)"
+build_uboot
+cp ${FASTMAP_IMAGE} ${tmp}/nand.bin
+bytes=$(stat -c %s ${FASTMAP_DATA})
+size=$(printf "%x" ${bytes})
+
+echo "Attach by fastmap"
+run_uboot "ubi part ubi; ubi read 2000000 ${VOLUME} ${size}; \
+	cmp.b 1000000 2000000 ${size}"
+grep -q "attached by fastmap" ${tmp}/out || fail "fastmap not used"
+check_same "fastmap attach"
+
+echo "Write, then attach by scanning"
+run_uboot "ubi part ubi; ubi write 1000000 ${VOLUME} ${size}"
+grep -q "invalidating fastmap" ${tmp}/out || fail "fastmap not invalidated"
+run_uboot "ubi part ubi; ubi read 2000000 ${VOLUME} ${size}; \
+	cmp.b 1000000 2000000 ${size}"
+grep -q "attached by fastmap" ${tmp}/out && fail "stale fastmap used"
+check_same "scanning attach"
+
+rm -rf ${tmp}
+echo "Test passed"
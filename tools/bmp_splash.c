@@ -0,0 +1,208 @@
+/*
+ * Convert a BMP file into a raw splash image in the pixel format of the
+ * frame buffer, see include/splash.h. U-Boot then only has to copy (or
+ * inflate, if the result is gzipped) the pixels into place.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include "compiler.h"
+#include <splash.h>
+#include <unistd.h>
+
+struct bmp_file {
+	uint8_t *buf;
+	int width;
+	int height;
+	int bpp;
+	int top_down;		/* first row in the file is the top one */
+	uint32_t stride;
+	const uint8_t *palette;
+	uint32_t colors;
+	const uint8_t *pixels;
+};
+
+static void usage(const char *prog)
+{
+	fprintf(stderr, "Usage: %s [-b] [-d 16|32] input.bmp output\n"
+		"  -b  write pixels big endian\n"
+		"  -d  bits per pixel of the frame buffer (default 16)\n",
+		prog);
+	exit(EXIT_FAILURE);
+}
+
+static void __attribute__ ((__noreturn__)) error(const char *msg,
+						 const char *name)
+{
+	fprintf(stderr, "ERROR: %s: %s\n", name, msg);
+	exit(EXIT_FAILURE);
+}
+
+static uint32_t get_le16(const uint8_t *p)
+{
+	return p[0] | p[1] << 8;
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+	return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void put_le16(uint8_t *p, uint16_t val)
+{
+	p[0] = val;
+	p[1] = val >> 8;
+}
+
+static void read_bmp(struct bmp_file *bmp, const char *name)
+{
+	uint32_t offset, hdr_size, compression;
+	int32_t height;
+	FILE *fp;
+	long size;
+
+	fp = fopen(name, "rb");
+	if (!fp || fseek(fp, 0, SEEK_END) || (size = ftell(fp)) < 0)
+		error(strerror(errno), name);
+	rewind(fp);
+	bmp->buf = malloc(size);
+	if (!bmp->buf)
+		error("out of memory", name);
+	if (fread(bmp->buf, 1, size, fp) != (size_t)size)
+		error("read failed", name);
+	fclose(fp);
+
+	if (size < 54 || bmp->buf[0] != 'B' || bmp->buf[1] != 'M')
+		error("not a BMP file", name);
+	offset = get_le32(bmp->buf + 10);
+	hdr_size = get_le32(bmp->buf + 14);
+	bmp->width = get_le32(bmp->buf + 18);
+	height = get_le32(bmp->buf + 22);
+	bmp->bpp = get_le16(bmp->buf + 28);
+	compression = get_le32(bmp->buf + 30);
+	bmp->colors = get_le32(bmp->buf + 46);
+
+	if (compression != 0)
+		error("compressed BMPs are not supported", name);
+	if (bmp->bpp != 1 && bmp->bpp != 4 && bmp->bpp != 8 &&
+	    bmp->bpp != 24 && bmp->bpp != 32)
+		error("unsupported bits per pixel", name);
+	if (bmp->width <= 0 || bmp->width > 0xffff || !height ||
+	    height > 0xffff || height < -0xffff)
+		error("bad size", name);
+
+	bmp->top_down = height < 0;
+	bmp->height = height < 0 ? -height : height;
+	bmp->stride = ((bmp->width * bmp->bpp + 31) / 32) * 4;
+	if (bmp->bpp <= 8 && !bmp->colors)
+		bmp->colors = 1 << bmp->bpp;
+	bmp->palette = bmp->buf + 14 + hdr_size;
+	bmp->pixels = bmp->buf + offset;
+	if (bmp->palette + bmp->colors * 4 > bmp->buf + size ||
+	    offset + (uint64_t)bmp->stride * bmp->height > (uint64_t)size)
+		error("file is truncated", name);
+}
+
+/* Get pixel @x of row @y (0 is the top) as 0xRRGGBB */
+static uint32_t get_pixel(const struct bmp_file *bmp, int x, int y)
+{
+	const uint8_t *row, *p;
+	uint32_t idx;
+
+	if (!bmp->top_down)
+		y = bmp->height - 1 - y;
+	row = bmp->pixels + y * bmp->stride;
+
+	switch (bmp->bpp) {
+	case 24:
+	case 32:
+		p = row + x * bmp->bpp / 8;
+		return p[2] << 16 | p[1] << 8 | p[0];
+	case 8:
+		idx = row[x];
+		break;
+	default:
+		idx = row[x * bmp->bpp / 8] >> (8 - bmp->bpp -
+						 (x * bmp->bpp) % 8);
+		idx &= (1 << bmp->bpp) - 1;
+		break;
+	}
+	if (idx >= bmp->colors)
+		return 0;
+	p = bmp->palette + idx * 4;
+
+	return p[2] << 16 | p[1] << 8 | p[0];
+}
+
+int main(int argc, char *argv[])
+{
+	struct splash_raw_header hdr;
+	struct bmp_file bmp;
+	int big_endian = 0, bpp = 16;
+	uint8_t *row, *p;
+	uint32_t rgb, val;
+	int opt, x, y, i;
+	FILE *out;
+
+	while ((opt = getopt(argc, argv, "bd:")) != -1) {
+		switch (opt) {
+		case 'b':
+			big_endian = 1;
+			break;
+		case 'd':
+			bpp = atoi(optarg);
+			if (bpp != 16 && bpp != 32)
+				usage(argv[0]);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (argc - optind != 2)
+		usage(argv[0]);
+
+	read_bmp(&bmp, argv[optind]);
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, SPLASH_RAW_MAGIC, sizeof(hdr.magic));
+	put_le16((uint8_t *)&hdr.width, bmp.width);
+	put_le16((uint8_t *)&hdr.height, bmp.height);
+	hdr.bpp = bpp;
+	hdr.flags = big_endian ? SPLASH_RAW_BIG_ENDIAN : 0;
+
+	out = fopen(argv[optind + 1], "wb");
+	if (!out)
+		error(strerror(errno), argv[optind + 1]);
+	row = malloc(bmp.width * bpp / 8);
+	if (!row)
+		error("out of memory", argv[optind + 1]);
+	if (fwrite(&hdr, sizeof(hdr), 1, out) != 1)
+		error("write failed", argv[optind + 1]);
+
+	for (y = 0; y < bmp.height; y++) {
+		p = row;
+		for (x = 0; x < bmp.width; x++) {
+			rgb = get_pixel(&bmp, x, y);
+			if (bpp == 16)
+				val = (rgb >> 8 & 0xf800) |
+				      (rgb >> 5 & 0x07e0) | (rgb >> 3 & 0x001f);
+			else
+				val = rgb;
+			for (i = 0; i < bpp / 8; i++) {
+				if (big_endian)
+					*p++ = val >> (bpp - 8 - 8 * i);
+				else
+					*p++ = val >> (8 * i);
+			}
+		}
+		if (fwrite(row, p - row, 1, out) != 1)
+			error("write failed", argv[optind + 1]);
+	}
+	if (fclose(out))
+		error(strerror(errno), argv[optind + 1]);
+
+	free(row);
+	free(bmp.buf);
+
+	return EXIT_SUCCESS;
+}
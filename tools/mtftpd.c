@@ -0,0 +1,519 @@
+/*
+ * Multicast TFTP server: serve one image to many boards at once.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ *
+ * This implements the server side of the multicast TFTP scheme used by
+ * U-Boot with CONFIG_MCAST_TFTP (RFC 2090 with two extensions):
+ *
+ * - Every client sends a normal RRQ carrying the "multicast" option and
+ *   gets an OACK naming the group, port and whether it is the master
+ *   client. All data blocks go to the group, from a single server port.
+ *
+ * - Data is sent in windows of "windowsize" blocks. Only the master
+ *   client ACKs, once per window, with the last block it holds without
+ *   a hole; that paces the transfer. If the master stays silent, the end
+ *   of the window is resent and eventually another client becomes master.
+ *
+ * - Any other client that notices a hole sends the same kind of ACK to
+ *   the server port (a NAK). The server multicasts the missing window
+ *   again, merging NAKs for the same block that arrive close together.
+ *
+ * A client that holds the whole file ACKs the final block and is done.
+ * Block numbers are 16 bit on the wire. The server unwraps each client's
+ * ACKs against what that client held before, and clients unwrap data
+ * blocks against the highest block they have seen, so images are not
+ * limited to 65535 blocks. U-Boot only joins a transfer that is already
+ * running as a passive client if the image is shorter than that, since
+ * it cannot tell which lap the data blocks are on.
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TFTP_RRQ	1
+#define TFTP_DATA	3
+#define TFTP_ACK	4
+#define TFTP_ERROR	5
+#define TFTP_OACK	6
+
+#define MTFTPD_MAX_CLIENTS	1024
+#define MTFTPD_PKTSIZE		(4 + 65464)
+/* Resend the end of the window when the master has been silent this long */
+#define MTFTPD_RETRY_MS		200
+/* Hand the master role to another client after this many resends */
+#define MTFTPD_MASTER_RETRIES	25
+/* NAKs for the same block within this time are served only once */
+#define MTFTPD_REPAIR_MS	50
+
+struct mtftpd_client {
+	struct sockaddr_in addr;
+	unsigned long have;	/* blocks held without a hole */
+	int done;
+};
+
+static struct {
+	const uint8_t *image;
+	size_t size;
+	unsigned long nblocks;		/* the last block is < blksize */
+	unsigned blksize;		/* 0 until the first client asks */
+	unsigned blksize_max;
+	unsigned window;
+	int lsock;			/* well known port, RRQs */
+	int xsock;			/* transfer port, data and ACKs */
+	struct sockaddr_in group;
+	struct mtftpd_client clients[MTFTPD_MAX_CLIENTS];
+	int nclients;
+	int master;			/* index into clients, -1 = none */
+	int master_retries;
+	unsigned long base;		/* first block of the window */
+	unsigned long highest;		/* highest block sent */
+	uint64_t last_ack;
+	unsigned long repair_block;
+	uint64_t repair_time;
+	int want;			/* exit after this many, 0 = never */
+	int completed;
+	int verbose;
+} srv;
+
+static uint64_t now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/*
+ * An ACK names the last block the client holds without a hole, which only
+ * moves forward and never past what was sent. Take the first block with
+ * the 16-bit number @block from where the client was; if that was not
+ * sent yet, the ACK is an old one from the lap before.
+ */
+static unsigned long client_block(const struct mtftpd_client *c,
+				  unsigned block)
+{
+	unsigned long abs = c->have + ((block - c->have) & 0xffff);
+
+	if (abs > srv.highest && abs >= 0x10000)
+		abs -= 0x10000;
+
+	return abs;
+}
+
+static void send_error(const struct sockaddr_in *to, int code,
+		       const char *msg)
+{
+	uint8_t pkt[128];
+	int len;
+
+	pkt[0] = 0;
+	pkt[1] = TFTP_ERROR;
+	pkt[2] = 0;
+	pkt[3] = code;
+	len = 4 + snprintf((char *)pkt + 4, sizeof(pkt) - 4, "%s", msg) + 1;
+	sendto(srv.xsock, pkt, len, 0, (const struct sockaddr *)to,
+	       sizeof(*to));
+}
+
+static void send_oack(struct mtftpd_client *c, int master)
+{
+	char pkt[256], *p = pkt + 2;
+
+	pkt[0] = 0;
+	pkt[1] = TFTP_OACK;
+	p += sprintf(p, "blksize%c%u%c", 0, srv.blksize, 0);
+	p += sprintf(p, "tsize%c%zu%c", 0, srv.size, 0);
+	p += sprintf(p, "windowsize%c%u%c", 0, srv.window, 0);
+	p += sprintf(p, "multicast%c%s,%u,%d%c", 0,
+		     inet_ntoa(srv.group.sin_addr),
+		     ntohs(srv.group.sin_port), master, 0);
+	sendto(srv.xsock, pkt, p - pkt, 0, (struct sockaddr *)&c->addr,
+	       sizeof(c->addr));
+}
+
+static void send_block(unsigned long block)
+{
+	static uint8_t pkt[MTFTPD_PKTSIZE];
+	size_t off = (block - 1) * srv.blksize;
+	size_t len = srv.size - off;
+
+	if (len > srv.blksize)
+		len = srv.blksize;
+	pkt[0] = 0;
+	pkt[1] = TFTP_DATA;
+	pkt[2] = (block >> 8) & 0xff;
+	pkt[3] = block & 0xff;
+	memcpy(pkt + 4, srv.image + off, len);
+	sendto(srv.xsock, pkt, 4 + len, 0, (struct sockaddr *)&srv.group,
+	       sizeof(srv.group));
+	if (block > srv.highest)
+		srv.highest = block;
+}
+
+/* Send blocks from @first up to the end of the window it is in */
+static void send_window(unsigned long first)
+{
+	unsigned long last = (first + srv.window - 1) / srv.window *
+			     srv.window;
+	unsigned long b;
+
+	if (last > srv.nblocks)
+		last = srv.nblocks;
+	for (b = first; b <= last; b++)
+		send_block(b);
+}
+
+static void pick_master(void)
+{
+	int i;
+
+	srv.master = -1;
+	for (i = 0; i < srv.nclients; i++) {
+		if (!srv.clients[i].done) {
+			srv.master = i;
+			srv.master_retries = 0;
+			srv.last_ack = now_ms();
+			if (srv.verbose)
+				printf("master is now %s\n",
+				       inet_ntoa(srv.clients[i].addr.sin_addr));
+			send_oack(&srv.clients[i], 1);
+			return;
+		}
+	}
+}
+
+static int is_master(const struct mtftpd_client *c)
+{
+	return srv.master >= 0 && &srv.clients[srv.master] == c;
+}
+
+static struct mtftpd_client *find_client(const struct sockaddr_in *from)
+{
+	int i;
+
+	for (i = 0; i < srv.nclients; i++) {
+		struct mtftpd_client *c = &srv.clients[i];
+
+		if (c->addr.sin_addr.s_addr == from->sin_addr.s_addr &&
+		    c->addr.sin_port == from->sin_port)
+			return c;
+	}
+	return NULL;
+}
+
+static void handle_rrq(uint8_t *pkt, int len, struct sockaddr_in *from)
+{
+	char *p = (char *)pkt + 2, *end = (char *)pkt + len;
+	unsigned blksize = 512, window = 1;
+	struct mtftpd_client *c;
+	int mcast = 0;
+
+	pkt[len - 1] = 0;
+	p += strlen(p) + 1;		/* file name: we serve one image */
+	if (p >= end)
+		return;
+	p += strlen(p) + 1;		/* mode */
+	while (p < end) {
+		char *opt = p, *val = p + strlen(p) + 1;
+
+		if (val >= end)
+			break;
+		if (!strcasecmp(opt, "blksize"))
+			blksize = strtoul(val, NULL, 10);
+		else if (!strcasecmp(opt, "windowsize"))
+			window = strtoul(val, NULL, 10);
+		else if (!strcasecmp(opt, "multicast"))
+			mcast = 1;
+		p = val + strlen(val) + 1;
+	}
+
+	if (!mcast) {
+		send_error(from, 0, "multicast transfers only");
+		return;
+	}
+
+	/* the first client fixes block and window size for everyone */
+	if (!srv.blksize) {
+		srv.blksize = blksize < srv.blksize_max ? blksize :
+			      srv.blksize_max;
+		if (window < srv.window)
+			srv.window = window ? window : 1;
+		srv.nblocks = srv.size / srv.blksize + 1;
+	} else if (blksize < srv.blksize) {
+		send_error(from, 8, "blksize too small for this session");
+		return;
+	}
+
+	c = find_client(from);
+	if (!c) {
+		if (srv.nclients == MTFTPD_MAX_CLIENTS) {
+			send_error(from, 0, "too many clients");
+			return;
+		}
+		c = &srv.clients[srv.nclients++];
+		c->addr = *from;
+		printf("client %d: %s:%u\n", srv.nclients,
+		       inet_ntoa(from->sin_addr), ntohs(from->sin_port));
+	}
+	c->have = 0;
+	c->done = 0;
+
+	if (srv.master < 0)
+		pick_master();
+	else
+		send_oack(c, is_master(c));
+}
+
+static void handle_ack(unsigned block, struct sockaddr_in *from)
+{
+	struct mtftpd_client *c = find_client(from);
+	unsigned long have;
+	uint64_t t = now_ms();
+
+	if (!c || c->done)
+		return;
+
+	have = client_block(c, block);
+	if (have > c->have)
+		c->have = have;
+
+	if (have >= srv.nblocks) {
+		c->done = 1;
+		srv.completed++;
+		printf("client %s done (%d complete)\n",
+		       inet_ntoa(c->addr.sin_addr), srv.completed);
+		if (is_master(c))
+			pick_master();
+		return;
+	}
+
+	if (is_master(c)) {
+		/* window ACK, or the master went back to fill a hole */
+		srv.base = have + 1;
+		srv.last_ack = t;
+		srv.master_retries = 0;
+		send_window(srv.base);
+		return;
+	}
+
+	/* NAK from a passive client */
+	if (have + 1 == srv.repair_block &&
+	    t - srv.repair_time < MTFTPD_REPAIR_MS)
+		return;
+	if (srv.verbose)
+		printf("repair %lu for %s\n", have + 1,
+		       inet_ntoa(c->addr.sin_addr));
+	srv.repair_block = have + 1;
+	srv.repair_time = t;
+	send_window(have + 1);
+}
+
+static void handle_error(uint8_t *pkt, int len, struct sockaddr_in *from)
+{
+	struct mtftpd_client *c = find_client(from);
+
+	pkt[len - 1] = 0;
+	printf("client %s: error '%s'\n", inet_ntoa(from->sin_addr),
+	       (char *)pkt + 4);
+	if (!c || c->done)
+		return;
+	c->done = 1;
+	if (is_master(c))
+		pick_master();
+}
+
+static void handle_tick(void)
+{
+	struct mtftpd_client *m;
+	unsigned long last;
+
+	if (srv.master < 0 || now_ms() - srv.last_ack < MTFTPD_RETRY_MS)
+		return;
+
+	m = &srv.clients[srv.master];
+	if (++srv.master_retries > MTFTPD_MASTER_RETRIES) {
+		printf("client %s stopped responding\n",
+		       inet_ntoa(m->addr.sin_addr));
+		m->done = 1;
+		pick_master();
+		return;
+	}
+
+	/* no ACK yet: the OACK may have been lost */
+	if (!srv.base) {
+		send_oack(m, 1);
+		srv.last_ack = now_ms();
+		return;
+	}
+
+	/* the end of the window prompts the master's ACK */
+	last = (srv.base + srv.window - 1) / srv.window * srv.window;
+	if (last > srv.nblocks)
+		last = srv.nblocks;
+	send_block(last);
+	srv.last_ack = now_ms();
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"Usage: %s [-p port] [-g group] [-P mcast_port] [-i ifaddr]\n"
+		"          [-b blksize] [-w window] [-n clients] [-v] image\n"
+		"\n"
+		"  -p  TFTP port to listen on (default 69)\n"
+		"  -g  multicast group for data (default 239.255.0.1)\n"
+		"  -P  multicast port for data (default 1758)\n"
+		"  -i  address of the interface to send on\n"
+		"  -b  maximum block size (default 1468)\n"
+		"  -w  blocks per master ACK (default 16)\n"
+		"  -n  exit after this many boards have the image\n"
+		"  -v  verbose\n", prog);
+	exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+	static uint8_t pkt[MTFTPD_PKTSIZE];
+	struct sockaddr_in addr, from;
+	struct in_addr ifaddr = { INADDR_ANY };
+	struct pollfd pfd[2];
+	struct stat st;
+	socklen_t fromlen;
+	unsigned char ttl = 1, loop = 1;
+	int port = 69, opt, fd, len, i;
+
+	memset(&srv, 0, sizeof(srv));
+	srv.master = -1;
+	srv.blksize_max = 1468;
+	srv.window = 16;
+	srv.group.sin_family = AF_INET;
+	srv.group.sin_addr.s_addr = inet_addr("239.255.0.1");
+	srv.group.sin_port = htons(1758);
+
+	while ((opt = getopt(argc, argv, "p:g:P:i:b:w:n:v")) != -1) {
+		switch (opt) {
+		case 'p':
+			port = atoi(optarg);
+			break;
+		case 'g':
+			srv.group.sin_addr.s_addr = inet_addr(optarg);
+			break;
+		case 'P':
+			srv.group.sin_port = htons(atoi(optarg));
+			break;
+		case 'i':
+			ifaddr.s_addr = inet_addr(optarg);
+			break;
+		case 'b':
+			srv.blksize_max = atoi(optarg);
+			break;
+		case 'w':
+			srv.window = atoi(optarg);
+			break;
+		case 'n':
+			srv.want = atoi(optarg);
+			break;
+		case 'v':
+			srv.verbose = 1;
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind != argc - 1 || srv.window < 1 || srv.blksize_max < 8 ||
+	    srv.blksize_max > MTFTPD_PKTSIZE - 4)
+		usage(argv[0]);
+
+	fd = open(argv[optind], O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		perror(argv[optind]);
+		return EXIT_FAILURE;
+	}
+	srv.size = st.st_size;
+	srv.image = mmap(NULL, srv.size ? srv.size : 1, PROT_READ,
+			 MAP_PRIVATE, fd, 0);
+	if (srv.image == MAP_FAILED) {
+		perror("mmap");
+		return EXIT_FAILURE;
+	}
+
+	srv.lsock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	srv.xsock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (srv.lsock < 0 || srv.xsock < 0) {
+		perror("socket");
+		return EXIT_FAILURE;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = INADDR_ANY;
+	addr.sin_port = htons(port);
+	if (bind(srv.lsock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		perror("bind");
+		return EXIT_FAILURE;
+	}
+	setsockopt(srv.xsock, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+	setsockopt(srv.xsock, IPPROTO_IP, IP_MULTICAST_LOOP, &loop,
+		   sizeof(loop));
+	if (ifaddr.s_addr != INADDR_ANY &&
+	    setsockopt(srv.xsock, IPPROTO_IP, IP_MULTICAST_IF, &ifaddr,
+		       sizeof(ifaddr)) < 0) {
+		perror("IP_MULTICAST_IF");
+		return EXIT_FAILURE;
+	}
+
+	printf("Serving %s (%zu bytes) on port %d, data to %s:%u\n",
+	       argv[optind], srv.size, port, inet_ntoa(srv.group.sin_addr),
+	       ntohs(srv.group.sin_port));
+
+	pfd[0].fd = srv.lsock;
+	pfd[1].fd = srv.xsock;
+	pfd[0].events = pfd[1].events = POLLIN;
+
+	while (!srv.want || srv.completed < srv.want) {
+		if (poll(pfd, 2, 10) < 0) {
+			if (errno == EINTR)
+				continue;
+			perror("poll");
+			return EXIT_FAILURE;
+		}
+		for (i = 0; i < 2; i++) {
+			if (!(pfd[i].revents & POLLIN))
+				continue;
+			fromlen = sizeof(from);
+			len = recvfrom(pfd[i].fd, pkt, sizeof(pkt), 0,
+				       (struct sockaddr *)&from, &fromlen);
+			if (len < 4)
+				continue;
+			switch ((pkt[0] << 8) | pkt[1]) {
+			case TFTP_RRQ:
+				if (i == 0)
+					handle_rrq(pkt, len, &from);
+				break;
+			case TFTP_ACK:
+				if (i == 1 && srv.blksize)
+					handle_ack((pkt[2] << 8) | pkt[3],
+						   &from);
+				break;
+			case TFTP_ERROR:
+				handle_error(pkt, len, &from);
+				break;
+			}
+		}
+		handle_tick();
+	}
+
+	return EXIT_SUCCESS;
+}